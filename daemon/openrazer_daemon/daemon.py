@@ -28,7 +28,13 @@ import openrazer_daemon.hardware
 from openrazer_daemon.dbus_services.service import DBusService
 from openrazer_daemon.device import DeviceCollection
 from openrazer_daemon.misc.screensaver_monitor import ScreensaverMonitor
-from openrazer_daemon.misc.autosave_persistence import PersistenceAutoSave
+from openrazer_daemon.misc.autosave_persistence import PersistenceAutoSave, PersistenceStatus, write_atomic
+from openrazer_daemon.misc.frame_scheduler import stop_frame_scheduler
+from openrazer_daemon.misc.battery_notifier import stop_battery_scheduler
+from openrazer_daemon.misc.macro import close_macro_keyboard
+from openrazer_daemon.misc.hotplug import HotplugSettler
+from openrazer_daemon.misc.io_worker import submit_all
+from openrazer_daemon.misc.startup_trace import TRACE
 
 
 class RazerDaemon(DBusService):
@@ -44,7 +50,10 @@ class RazerDaemon(DBusService):
     * disableTurnOffOnScreensaver - Pauses the run loop on the screensaver thread
     """
 
-    def __init__(self, verbose=False, log_dir=None, console_log=False, run_dir=None, config_file=None, persistence_file=None, test_dir=None):
+    def __init__(self, verbose=False, log_dir=None, console_log=False, run_dir=None, config_file=None, persistence_file=None, test_dir=None, trace_startup=False):
+
+        if trace_startup:
+            TRACE.start()
 
         setproctitle.setproctitle('openrazer-daemon')  # pylint: disable=no-member
 
@@ -77,7 +86,8 @@ class RazerDaemon(DBusService):
 
         self._config_file = config_file
         self._config = configparser.ConfigParser()
-        self.read_config(config_file)
+        with TRACE.phase('config'):
+            self.read_config(config_file)
 
         # Logging
         log_level = logging.INFO
@@ -87,8 +97,10 @@ class RazerDaemon(DBusService):
 
         self._persistence_file = persistence_file
         self._persistence = configparser.ConfigParser()
-        self._persistence.status = {"changed": False}
-        self.read_persistence(persistence_file)
+        self._persistence.status = PersistenceStatus()
+        self._persistence_lock = threading.Lock()
+        with TRACE.phase('persistence'):
+            self.read_persistence(persistence_file)
 
         # Check for plugdev group
         if not self._check_plugdev_group():
@@ -97,29 +109,38 @@ class RazerDaemon(DBusService):
             sys.exit(1)
 
         # Setup DBus to use gobject main loop
-        dbus.mainloop.glib.threads_init()
-        dbus.mainloop.glib.DBusGMainLoop(set_as_default=True)
-        super().__init__('/org/razer')
+        with TRACE.phase('DBus connection'):
+            dbus.mainloop.glib.threads_init()
+            dbus.mainloop.glib.DBusGMainLoop(set_as_default=True)
+            super().__init__('/org/razer')
 
         self._init_signals()
         self._main_loop = GLib.MainLoop()
 
         # Listen for input events from udev
-        self._init_udev_monitor()
+        with TRACE.phase('udev monitor'):
+            self._init_udev_monitor()
 
         # Load Classes
-        self._device_classes = openrazer_daemon.hardware.get_device_classes()
+        with TRACE.phase('hardware imports'):
+            self._device_classes = openrazer_daemon.hardware.get_device_classes()
+        with TRACE.phase('class table'):
+            self._device_class_map = openrazer_daemon.hardware.get_device_class_map(self._device_classes)
+        self._hotplug_settler = HotplugSettler(self._find_device_class, self._add_devices, {vid for vid, _ in self._device_class_map})
 
         self.logger.info("Initialising Daemon (v%s). Pid: %d", __version__, os.getpid())
-        self._init_screensaver_monitor()
+        with TRACE.phase('screensaver monitor'):
+            self._init_screensaver_monitor()
 
         self._razer_devices = DeviceCollection()
-        self._load_devices(first_run=True)
+        with TRACE.phase('devices'):
+            self._load_devices(first_run=True)
 
         # Add DBus methods
         methods = {
             # interface, method, callback, in-args, out-args
             ('razer.devices', 'getDevices', self.get_serial_list, None, 'as'),
+            ('razer.devices', 'getDeviceDescriptors', self.get_device_descriptors, None, 'a{sa{sv}}'),
             ('razer.devices', 'supportedDevices', self.supported_devices, None, 's'),
             ('razer.devices', 'enableTurnOffOnScreensaver', self.enable_turn_off_on_screensaver, 'b', None),
             ('razer.devices', 'getOffOnScreensaver', self.get_off_on_screensaver, None, 'b'),
@@ -129,19 +150,24 @@ class RazerDaemon(DBusService):
             ('razer.daemon', 'stop', self.stop, None, None),
         }
 
-        for m in methods:
-            self.logger.debug("Adding {}.{} method to DBus".format(m[0], m[1]))
-            self.add_dbus_method(m[0], m[1], m[2], in_signature=m[3], out_signature=m[4])
+        # Methods above that reply from other threads
+        async_methods = ('getDeviceDescriptors',)
 
-        self._collecting_udev = False
-        self._collecting_udev_devices = []
+        with TRACE.phase('DBus registration'):
+            for m in methods:
+                self.logger.debug("Adding {}.{} method to DBus".format(m[0], m[1]))
+                self.add_dbus_method(m[0], m[1], m[2], in_signature=m[3], out_signature=m[4], async_reply=m[1] in async_methods)
 
         self._init_autosave_persistence()
 
+        self._razer_devices.sync_barrier = self._config.getboolean('Startup', 'sync_effects_barrier')
+
         # TODO remove
         self.sync_effects(self._config.getboolean('Startup', 'sync_effects_enabled'))
         # TODO ======
 
+        TRACE.report(self.logger)
+
     @dbus.service.signal('razer.devices')
     def device_removed(self):
         self.logger.debug("Emitted Device Remove Signal")
@@ -203,6 +229,8 @@ class RazerDaemon(DBusService):
         self._udev_context = Context()
         udev_monitor = Monitor.from_netlink(self._udev_context)
         udev_monitor.filter_by(subsystem='hid')
+        # Only used to notice new event files
+        udev_monitor.filter_by(subsystem='input')
         self._udev_observer = MonitorObserver(udev_monitor, callback=self._udev_input_event, name='device-monitor')
 
     def _init_screensaver_monitor(self):
@@ -217,7 +245,7 @@ class RazerDaemon(DBusService):
             self.logger.debug("Persistence unspecified. Will not create auto save thread")
             return
 
-        self._autosave_persistence = PersistenceAutoSave(self._persistence, self._persistence_file, self._persistence.status, self.logger, 10, self.write_persistence)
+        self._autosave_persistence = PersistenceAutoSave(self._persistence_file, self._persistence.status, self.logger, 1, 10, self.write_persistence)
         self._autosave_persistence.thread = threading.Thread(target=self._autosave_persistence.watch)
         self._autosave_persistence.thread.daemon = True
         self._autosave_persistence.thread.start()
@@ -281,6 +309,7 @@ class RazerDaemon(DBusService):
         }
         self._config['Startup'] = {
             'sync_effects_enabled': True,
+            'sync_effects_barrier': False,
             'devices_off_on_screensaver': True,
             'restore_persistence': True,
             'persistence_dual_boot_quirk': False,
@@ -310,42 +339,61 @@ class RazerDaemon(DBusService):
                 with open(persistence_file, "w") as f:
                     f.writelines("")
 
-    def write_persistence(self, persistence_file):
+    def write_persistence(self, persistence_file, storage_names=None):
         """
         Write in the persistence file
 
         :param persistence_file: Persistence file
         :type persistence_file: str or None
+
+        :param storage_names: Sections of the devices to update, all devices if None
+        :type storage_names: set or None
         """
         if not persistence_file:
             return
 
         self.logger.debug('Writing persistence config')
 
-        for device in self._razer_devices:
-            self._persistence[device.dbus.storage_name] = {}
-            if 'set_dpi_xy' in device.dbus.METHODS or 'set_dpi_xy_byte' in device.dbus.METHODS:
-                dpi_x = int(device.dbus.dpi[0])
-                dpi_y = int(device.dbus.dpi[1])
-                # When Y is not greater than 0 check for a DPI X only device, a device with 'available_dpi' and a Y value of 0
-                if dpi_x > 0 and (dpi_y > 0 or ('available_dpi' in device.dbus.METHODS and dpi_y == 0)):
-                    self._persistence[device.dbus.storage_name]['dpi_x'] = str(dpi_x)
-                    self._persistence[device.dbus.storage_name]['dpi_y'] = str(dpi_y)
-
-            if 'set_poll_rate' in device.dbus.METHODS:
-                self._persistence[device.dbus.storage_name]['poll_rate'] = str(device.dbus.poll_rate)
-
-            for i in device.dbus.ZONES:
-                if device.dbus.zone[i]["present"]:
-                    self._persistence[device.dbus.storage_name][i + '_active'] = str(device.dbus.zone[i]["active"])
-                    self._persistence[device.dbus.storage_name][i + '_brightness'] = str(device.dbus.zone[i]["brightness"])
-                    self._persistence[device.dbus.storage_name][i + '_effect'] = device.dbus.zone[i]["effect"]
-                    self._persistence[device.dbus.storage_name][i + '_colors'] = ' '.join(str(i) for i in device.dbus.zone[i]["colors"])
-                    self._persistence[device.dbus.storage_name][i + '_speed'] = str(device.dbus.zone[i]["speed"])
-                    self._persistence[device.dbus.storage_name][i + '_wave_dir'] = str(device.dbus.zone[i]["wave_dir"])
-
-        with open(persistence_file, 'w') as cf:
-            self._persistence.write(cf)
+        with self._persistence_lock:
+            for device in self._razer_devices:
+                if storage_names is None or device.dbus.storage_name in storage_names:
+                    self._persistence[device.dbus.storage_name] = self._get_persistence_section(device.dbus)
+
+            write_atomic(persistence_file, self._persistence.write)
+
+    @staticmethod
+    def _get_persistence_section(device):
+        """
+        Get the persistence state of a device
+
+        :param device: Device
+        :type device: openrazer_daemon.hardware.device_base.RazerDevice
+
+        :return: Section contents
+        :rtype: dict
+        """
+        section = {}
+        if 'set_dpi_xy' in device.METHODS or 'set_dpi_xy_byte' in device.METHODS:
+            dpi_x = int(device.dpi[0])
+            dpi_y = int(device.dpi[1])
+            # When Y is not greater than 0 check for a DPI X only device, a device with 'available_dpi' and a Y value of 0
+            if dpi_x > 0 and (dpi_y > 0 or ('available_dpi' in device.METHODS and dpi_y == 0)):
+                section['dpi_x'] = str(dpi_x)
+                section['dpi_y'] = str(dpi_y)
+
+        if 'set_poll_rate' in device.METHODS:
+            section['poll_rate'] = str(device.poll_rate)
+
+        for i in device.ZONES:
+            if device.zone[i]["present"]:
+                section[i + '_active'] = str(device.zone[i]["active"])
+                section[i + '_brightness'] = str(device.zone[i]["brightness"])
+                section[i + '_effect'] = device.zone[i]["effect"]
+                section[i + '_colors'] = ' '.join(str(i) for i in device.zone[i]["colors"])
+                section[i + '_speed'] = str(device.zone[i]["speed"])
+                section[i + '_wave_dir'] = str(device.zone[i]["wave_dir"])
+
+        return section
 
     def get_off_on_screensaver(self):
         """
@@ -398,6 +446,36 @@ class RazerDaemon(DBusService):
         self.logger.debug('DBus called get_serial_list')
         return serial_list
 
+    def get_device_descriptors(self, reply_handler, error_handler):
+        """
+        Get the descriptors of all devices, see RazerDevice.get_descriptor
+
+        Descriptors are read on each device's I/O worker, so a device that
+        hasn't built its descriptor yet doesn't block the main loop. Devices
+        that fail are left out, clients then ask those devices themselves.
+
+        :param reply_handler: Called with a dbus.Dictionary of serial: descriptor
+        :type reply_handler: callable
+
+        :param error_handler: Unused, failing devices are left out
+        :type error_handler: callable
+        """
+        self.logger.debug('DBus called get_device_descriptors')
+
+        devices = list(self._razer_devices)
+
+        def reply(descriptors):
+            result = {}
+            for device, descriptor in zip(devices, descriptors):
+                if isinstance(descriptor, Exception):
+                    self.logger.warning("Failed to get the descriptor of %s: %s", device.serial, descriptor)
+                else:
+                    result[device.serial] = descriptor
+
+            GLib.idle_add(reply_handler, dbus.Dictionary(result, signature='sa{sv}'))
+
+        submit_all([(device.dbus.io_worker, device.dbus.get_descriptor, ()) for device in devices], reply)
+
     def sync_effects(self, enabled):
         """
         Sync the effects across the devices
@@ -430,7 +508,7 @@ class RazerDaemon(DBusService):
         Loops through the available hardware classes, loops through
         each device in the system and adds it if needs be.
         """
-        if first_run:
+        if first_run and self.logger.isEnabledFor(logging.DEBUG):
             # Just some pretty output
             max_name_len = max([len(cls.__name__) for cls in self._device_classes]) + 2
             for cls in self._device_classes:
@@ -442,74 +520,82 @@ class RazerDaemon(DBusService):
             device_list = os.listdir(self._test_dir)
             test_mode = True
         else:
-            device_list = list(self._udev_context.list_devices(subsystem='hid'))
+            with TRACE.phase('udev scan'):
+                device_list = list(self._udev_context.list_devices(subsystem='hid'))
             test_mode = False
 
+            # Group the interfaces of each USB device by their bus:VID:PID prefix
+            interfaces = {}
+            for device in device_list:
+                interfaces.setdefault(device.sys_name.split('.')[0], []).append(device)
+
         device_number = 0
         for device in device_list:
+            # Interoperability between generic list of 0000:0000:0000.0000 and pyudev
+            if test_mode:
+                sys_name = device
+                sys_path = os.path.join(self._test_dir, device)
+            else:
+                sys_name = device.sys_name
+                sys_path = device.sys_path
 
-            for device_class in self._device_classes:
-                # Interoperability between generic list of 0000:0000:0000.0000 and pyudev
-                if test_mode:
-                    sys_name = device
-                    sys_path = os.path.join(self._test_dir, device)
-                else:
-                    sys_name = device.sys_name
-                    sys_path = device.sys_path
+            if sys_name in self._razer_devices:
+                continue
 
-                if sys_name in self._razer_devices:
+            device_class = self._find_device_class(sys_name, sys_path)  # Check it matches sys/ ID format and has device_type file
+            if device_class is None:
+                continue
+
+            self.logger.info('Found device.%d: %s', device_number, sys_name)
+
+            # TODO add testdir support
+            # Basically find the other usb interfaces
+            device_match = sys_name.split('.')[0]
+            additional_interfaces = []
+            if not test_mode:
+                double_device = False
+                for alt_device in self._razer_devices:
+                    if device_match in alt_device.device_id and alt_device.device_id != sys_name and sys_path in alt_device.dbus.additional_interfaces:
+                        self.logger.warning('BUG: Device %s has already been found with interface %s. Skipping', sys_name, alt_device.device_id)
+                        double_device = True
+                if double_device:
                     continue
 
-                if device_class.match(sys_name, sys_path):  # Check it matches sys/ ID format and has device_type file
-                    self.logger.info('Found device.%d: %s', device_number, sys_name)
-
-                    # TODO add testdir support
-                    # Basically find the other usb interfaces
-                    device_match = sys_name.split('.')[0]
-                    additional_interfaces = []
-                    if not test_mode:
-                        double_device = False
-                        for alt_device in self._razer_devices:
-                            if device_match in alt_device.device_id and alt_device.device_id != sys_name and sys_path in alt_device.dbus.additional_interfaces:
-                                self.logger.warning('BUG: Device %s has already been found with interface %s. Skipping', sys_name, alt_device.device_id)
-                                double_device = True
-                        if double_device:
-                            continue
-
-                        for alt_device in device_list:
-                            if device_match in alt_device.sys_name and alt_device.sys_name != sys_name:
-                                additional_interfaces.append(alt_device.sys_path)
-
-                    # Checking permissions
-                    test_file = os.path.join(sys_path, 'device_type')
-                    file_group_id = os.stat(test_file).st_gid
-                    file_group_name = grp.getgrgid(file_group_id)[0]
-
-                    if os.getgid() != file_group_id and file_group_name != 'plugdev':
-                        self.logger.critical("Could not access {0}/device_type, file is not owned by plugdev".format(sys_path))
-                        break
-
-                    razer_device = device_class(device_path=sys_path, device_number=device_number, config=self._config,
-                                                persistence=self._persistence, testing=self._test_dir is not None,
-                                                additional_interfaces=sorted(additional_interfaces),
-                                                additional_methods=[])
-
-                    # Wireless devices sometimes don't listen
-                    count = 0
-                    while count < 3:
-                        # Loop to get serial, exit early if it gets one
-                        device_serial = razer_device.get_serial()
-                        if len(device_serial) > 0:
-                            break
-                        time.sleep(0.1)
-                        count += 1
-                    else:
-                        logging.warning("Could not get serial for device {0}. Skipping".format(sys_name))
-                        continue
-
-                    self._razer_devices.add(sys_name, device_serial, razer_device)
-
-                    device_number += 1
+                for alt_device in interfaces[device_match]:
+                    if alt_device.sys_name != sys_name:
+                        additional_interfaces.append(alt_device.sys_path)
+
+            # Checking permissions
+            test_file = os.path.join(sys_path, 'device_type')
+            file_group_id = os.stat(test_file).st_gid
+            file_group_name = grp.getgrgid(file_group_id)[0]
+
+            if os.getgid() != file_group_id and file_group_name != 'plugdev':
+                self.logger.critical("Could not access {0}/device_type, file is not owned by plugdev".format(sys_path))
+                continue
+
+            with TRACE.phase('device init: {0}'.format(sys_name)):
+                razer_device = device_class(device_path=sys_path, device_number=device_number, config=self._config,
+                                            persistence=self._persistence, testing=self._test_dir is not None,
+                                            additional_interfaces=sorted(additional_interfaces),
+                                            additional_methods=[])
+
+            # Wireless devices sometimes don't listen
+            count = 0
+            while count < 3:
+                # Loop to get serial, exit early if it gets one
+                device_serial = razer_device.get_serial()
+                if len(device_serial) > 0:
+                    break
+                time.sleep(0.1)
+                count += 1
+            else:
+                logging.warning("Could not get serial for device {0}. Skipping".format(sys_name))
+                continue
+
+            self._razer_devices.add(sys_name, device_serial, razer_device)
+
+            device_number += 1
 
     def _add_device(self, device):
         """
@@ -519,39 +605,51 @@ class RazerDaemon(DBusService):
         :type device: pyudev.device._device.Device
         """
         device_number = len(self._razer_devices)
-        for device_class in self._device_classes:
-            sys_name = device.sys_name
-            sys_path = device.sys_path
-
-            if sys_name in self._razer_devices:
-                continue
+        sys_name = device.sys_name
+        sys_path = device.sys_path
 
-            if device_class.match(sys_name, sys_path):  # Check it matches sys/ ID format and has device_type file
-                self.logger.info('Found valid device.%d: %s', device_number, sys_name)
-                razer_device = device_class(device_path=sys_path, device_number=device_number, config=self._config,
-                                            persistence=self._persistence, testing=self._test_dir is not None,
-                                            additional_interfaces=None, additional_methods=[])
+        if sys_name in self._razer_devices:
+            return
 
-                # Its a udev event so currently the device hasn't been chmodded yet
-                time.sleep(0.2)
+        device_class = self._find_device_class(sys_name, sys_path)  # Check it matches sys/ ID format and has device_type file
+        if device_class is not None:
+            self.logger.info('Found valid device.%d: %s', device_number, sys_name)
+            razer_device = device_class(device_path=sys_path, device_number=device_number, config=self._config,
+                                        persistence=self._persistence, testing=self._test_dir is not None,
+                                        additional_interfaces=None, additional_methods=[])
 
-                # Wireless devices sometimes don't listen
-                device_serial = razer_device.get_serial()
+            # Wireless devices sometimes don't listen
+            device_serial = razer_device.get_serial()
 
-                if len(device_serial) > 0:
-                    # Add Device
-                    self._razer_devices.add(sys_name, device_serial, razer_device)
-                    self.device_added()
-                else:
-                    logging.warning("Could not get serial for device {0}. Skipping".format(sys_name))
+            if len(device_serial) > 0:
+                # Add Device
+                self._razer_devices.add(sys_name, device_serial, razer_device)
+                self.device_added()
             else:
-                # Basically find the other usb interfaces
-                device_match = sys_name.split('.')[0]
-                for d in self._razer_devices:
-                    if device_match in d.device_id and d.device_id != sys_name:
-                        if not sys_path in d.dbus.additional_interfaces:
-                            d.dbus.additional_interfaces.append(sys_path)
-                            return
+                logging.warning("Could not get serial for device {0}. Skipping".format(sys_name))
+        else:
+            # Basically find the other usb interfaces
+            device_match = sys_name.split('.')[0]
+            for d in self._razer_devices:
+                if device_match in d.device_id and d.device_id != sys_name:
+                    if not sys_path in d.dbus.additional_interfaces:
+                        d.dbus.additional_interfaces.append(sys_path)
+                        return
+
+    def _find_device_class(self, device_id, dev_path):
+        """
+        Find the hardware class of a device
+
+        :param device_id: Device ID like 0000:0000:0000.0000
+        :type device_id: str
+
+        :param dev_path: Device path
+        :type dev_path: str
+
+        :return: RazerDevice subclass or None
+        :rtype: callable or None
+        """
+        return openrazer_daemon.hardware.find_device_class(self._device_class_map, device_id, dev_path)
 
     def _remove_device(self, device):
         """
@@ -567,7 +665,7 @@ class RazerDaemon(DBusService):
 
             device.dbus.close()
             device.dbus.remove_from_connection()
-            self.write_persistence(self._persistence_file)
+            self.write_persistence(self._persistence_file, {device.dbus.storage_name})
             self.logger.warning("Removing %s", device_id)
 
             # Delete device
@@ -585,26 +683,30 @@ class RazerDaemon(DBusService):
         :param device: Udev device
         :type device: pyudev.device._device.Device
         """
+        if device.subsystem == 'input':
+            if device.action == 'add':
+                self._hotplug_settler.wake()
+            return
+
         self.logger.debug('Device event [%s]: %s', device.action, device.device_path)
-        if device.action == 'add':
-            if self._collecting_udev:
-                self._collecting_udev_devices.append(device)
-                return
-            else:
-                self._collecting_udev_devices = [device]
-                self._collecting_udev = True
-                t = threading.Thread(target=self._collecting_udev_method, args=(device,))
-                t.start()
+        if device.action in ('add', 'bind'):
+            # Wait for all interfaces before adding, the settler calls _add_devices
+            if device.sys_name not in self._razer_devices:
+                self._hotplug_settler.add(device)
         elif device.action == 'remove':
+            self._hotplug_settler.remove(device)
             self._remove_device(device)
 
-    def _collecting_udev_method(self, device):
-        time.sleep(2)  # delay to let udev add all devices that we want
+    def _add_devices(self, devices):
+        """
+        Add the interfaces of a hotplugged device once it has settled
+
+        :param devices: Udev devices
+        :type devices: list of pyudev.device._device.Device
+        """
         # Sort the devices
-        self._collecting_udev_devices.sort(key=lambda x: x.sys_path, reverse=True)
-        for d in self._collecting_udev_devices:
-            self._add_device(d)
-        self._collecting_udev = False
+        for device in sorted(devices, key=lambda x: x.sys_path, reverse=True):
+            self._add_device(device)
 
     def run(self):
         """
@@ -613,6 +715,7 @@ class RazerDaemon(DBusService):
         self.logger.info('Serving DBus')
 
         # Start listening for device changes
+        self._hotplug_settler.start()
         self._udev_observer.start()
 
         # Start the mainloop
@@ -641,9 +744,14 @@ class RazerDaemon(DBusService):
 
         # Stop udev monitor
         self._udev_observer.send_stop()
+        self._hotplug_settler.stop()
 
         for device in self._razer_devices:
             device.dbus.close()
 
+        stop_frame_scheduler()
+        stop_battery_scheduler()
+        close_macro_keyboard()
+
         # Write config
         self.write_persistence(self._persistence_file)
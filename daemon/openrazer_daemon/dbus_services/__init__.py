@@ -8,7 +8,7 @@ Has an endpoint decorator to wrap a method for DBus
 from functools import wraps
 
 
-def endpoint(interface_name, function_name, in_sig=None, out_sig=None, byte_arrays=False):
+def endpoint(interface_name, function_name, in_sig=None, out_sig=None, byte_arrays=False, state_only=False):
     """
     DBus Endpoint
 
@@ -27,6 +27,9 @@ def endpoint(interface_name, function_name, in_sig=None, out_sig=None, byte_arra
     :param byte_arrays: is Byte Array
     :type byte_arrays: bool
 
+    :param state_only: Only uses the daemon's state, so it doesn't need the device's I/O worker
+    :type state_only: bool
+
     :return: Function
     :rtype: callable
     """
@@ -40,6 +43,7 @@ def endpoint(interface_name, function_name, in_sig=None, out_sig=None, byte_arra
         wrapped.in_sig = in_sig
         wrapped.out_sig = out_sig
         wrapped.byte_arrays = byte_arrays
+        wrapped.state_only = state_only
         wrapped.code = func.__code__
         wrapped.globals = func.__globals__
         wrapped.defaults = func.__defaults__
@@ -3,6 +3,7 @@
 """
 All of these effects will be DBus methods
 """
+import types as _types
 
 # pylint: disable=wildcard-import
 from openrazer_daemon.dbus_services.dbus_methods.all import *
@@ -20,3 +21,23 @@ from openrazer_daemon.dbus_services.dbus_methods.accessory import *
 from openrazer_daemon.dbus_services.dbus_methods.charging_pad_chroma import *
 from openrazer_daemon.dbus_services.dbus_methods.mouse_scroll_wheel import *
 from openrazer_daemon.dbus_services.dbus_methods.argb_controller import *
+
+_ENDPOINTS = None
+
+
+def get_endpoints():
+    """
+    Get the DBus endpoints by function name
+
+    Built once per process instead of searching the package for every device.
+
+    :return: Dict of function name: endpoint function
+    :rtype: dict
+    """
+    global _ENDPOINTS  # pylint: disable=global-statement
+
+    if _ENDPOINTS is None:
+        _ENDPOINTS = {value.__name__: value for value in list(globals().values())
+                      if isinstance(value, _types.FunctionType) and getattr(value, 'endpoint', False)}
+
+    return _ENDPOINTS
@@ -18,5 +18,4 @@ def is_mug_present(self):
 
     driver_path = self.get_driver_path('is_mug_present')
 
-    with open(driver_path, 'r') as driver_file:
-        return int(driver_file.read().strip()) == 1
+    return int(self.read_driver_file(driver_path).strip()) == 1
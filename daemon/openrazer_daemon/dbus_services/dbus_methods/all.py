@@ -44,8 +44,7 @@ def version(self):
 
     if os.path.exists(driver_path):
         # Check it exists, as people might not have reloaded driver
-        with open(driver_path, 'r') as driver_file:
-            driver_version = driver_file.read().strip()
+        driver_version = self.read_driver_file(driver_path).strip()
 
     self.method_args['driver_version'] = driver_version
     return driver_version
@@ -63,8 +62,7 @@ def get_firmware(self):
 
     driver_path = self.get_driver_path('firmware_version')
 
-    with open(driver_path, 'r') as driver_file:
-        return driver_file.read().strip()
+    return self.state_cache.get('razer.device.misc', 'getFirmware', lambda: self.read_driver_file(driver_path).strip())
 
 
 @endpoint('razer.device.misc', 'getDeviceName', out_sig='s')
@@ -79,8 +77,7 @@ def get_device_name(self):
 
     driver_path = self.get_driver_path('device_type')
 
-    with open(driver_path, 'r') as driver_file:
-        return driver_file.read().strip()
+    return self.state_cache.get('razer.device.misc', 'getDeviceName', lambda: self.read_driver_file(driver_path).strip())
 
 
 @endpoint('razer.device.misc', 'getKeyboardLayout', out_sig='s')
@@ -103,7 +100,7 @@ def get_keyboard_layout(self):
 
 
 # Functions to define a hardware class
-@endpoint('razer.device.misc', 'getDeviceType', out_sig='s')
+@endpoint('razer.device.misc', 'getDeviceType', out_sig='s', state_only=True)
 def get_device_type_keyboard(self):
     """
     Get the device's type
@@ -115,7 +112,7 @@ def get_device_type_keyboard(self):
     return 'keyboard'
 
 
-@endpoint('razer.device.misc', 'getDeviceType', out_sig='s')
+@endpoint('razer.device.misc', 'getDeviceType', out_sig='s', state_only=True)
 def get_device_type_mouse(self):
     """
     Get the device's type
@@ -127,7 +124,7 @@ def get_device_type_mouse(self):
     return 'mouse'
 
 
-@endpoint('razer.device.misc', 'getDeviceType', out_sig='s')
+@endpoint('razer.device.misc', 'getDeviceType', out_sig='s', state_only=True)
 def get_device_type_mousemat(self):
     """
     Get the device's type
@@ -139,7 +136,7 @@ def get_device_type_mousemat(self):
     return 'mousemat'
 
 
-@endpoint('razer.device.misc', 'getDeviceType', out_sig='s')
+@endpoint('razer.device.misc', 'getDeviceType', out_sig='s', state_only=True)
 def get_device_type_core(self):
     """
     Get the device's type
@@ -151,7 +148,7 @@ def get_device_type_core(self):
     return 'core'
 
 
-@endpoint('razer.device.misc', 'getDeviceType', out_sig='s')
+@endpoint('razer.device.misc', 'getDeviceType', out_sig='s', state_only=True)
 def get_device_type_keypad(self):
     """
     Get the device's type
@@ -163,7 +160,7 @@ def get_device_type_keypad(self):
     return 'keypad'
 
 
-@endpoint('razer.device.misc', 'getDeviceType', out_sig='s')
+@endpoint('razer.device.misc', 'getDeviceType', out_sig='s', state_only=True)
 def get_device_type_headset(self):
     """
     Get the device's type
@@ -175,7 +172,7 @@ def get_device_type_headset(self):
     return 'headset'
 
 
-@endpoint('razer.device.misc', 'getDeviceType', out_sig='s')
+@endpoint('razer.device.misc', 'getDeviceType', out_sig='s', state_only=True)
 def get_device_type_accessory(self):
     """
     Get the device's type
@@ -187,7 +184,7 @@ def get_device_type_accessory(self):
     return 'accessory'
 
 
-@endpoint('razer.device.misc', 'hasMatrix', out_sig='b')
+@endpoint('razer.device.misc', 'hasMatrix', out_sig='b', state_only=True)
 def has_matrix(self):
     """
     If the device has an LED matrix
@@ -197,7 +194,7 @@ def has_matrix(self):
     return self.HAS_MATRIX
 
 
-@endpoint('razer.device.misc', 'getMatrixDimensions', out_sig='ai')
+@endpoint('razer.device.misc', 'getMatrixDimensions', out_sig='ai', state_only=True)
 def get_matrix_dims(self):
     """
     If the device has an LED matrix
@@ -10,8 +10,7 @@ def get_num_channels(self):
 
 def _get_channel_brightness(self, channel):
     driver_path = self.get_driver_path(channel + '_led_brightness')
-    with open(driver_path, 'r') as driver_file:
-        return float(driver_file.read().strip()) / (255.0 / 100.0)
+    return float(self.read_driver_file(driver_path).strip()) / (255.0 / 100.0)
 
 
 @endpoint('razer.device.lighting.channel', 'getChannelBrightness', in_sig='q', out_sig='d')
@@ -44,8 +43,7 @@ def _set_channel_brightness(self, channel, brightness):
 
     brightness = int(round(brightness * (255.0 / 100.0)))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(brightness))
+    self.write_driver_file(driver_path, str(brightness))
 
     # Notify others
     self.send_effect_event('setBrightness', brightness)
@@ -69,8 +67,7 @@ def set_channel_brightness(self, channel, brightness):
 
 def _get_channel_size(self, channel):
     driver_path = self.get_driver_path(channel + '_size')
-    with open(driver_path, 'r') as driver_file:
-        return int(driver_file.read().strip())
+    return int(self.read_driver_file(driver_path).strip())
 
 
 @endpoint('razer.device.lighting.channel', 'getChannelSize', in_sig='q', out_sig='i')
@@ -101,8 +98,7 @@ def _set_channel_size(self, channel, size):
 
     self.set_persistence(channel, "size", int(size))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(size))
+    self.write_driver_file(driver_path, str(size))
 
     # Notify others
     self.send_effect_event('setSize', size)
@@ -18,8 +18,7 @@ def bw_set_pulsate(self):  # TODO: Replace by set*BreathMono
     # remember effect
     self.set_persistence("backlight", "effect", 'pulsate')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
     # Notify others
     self.send_effect_event('setPulsate')
@@ -37,8 +36,7 @@ def bw_set_static(self):  # TODO: Replace by set*On
     # remember effect
     self.set_persistence("backlight", "effect", 'static')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
     # Notify others
     self.send_effect_event('setStatic')
@@ -3,7 +3,7 @@
 from openrazer_daemon.dbus_services import endpoint
 
 
-@endpoint('razer.device.lighting.charging', 'getChargingBrightness', out_sig='d')
+@endpoint('razer.device.lighting.charging', 'getChargingBrightness', out_sig='d', state_only=True)
 def get_charging_brightness(self):
     """
     Get the device's brightness
@@ -37,8 +37,7 @@ def set_charging_brightness(self, brightness):
 
     brightness = int(round(brightness * (255.0 / 100.0)))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(brightness))
+    self.write_driver_file(driver_path, str(brightness))
 
     # Notify others
     self.send_effect_event('setBrightness', brightness)
@@ -65,8 +64,7 @@ def set_charging_wave(self, direction):
     if direction not in self.WAVE_DIRS:
         direction = self.WAVE_DIRS[0]
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(direction))
+    self.write_driver_file(driver_path, str(direction))
 
 
 @endpoint('razer.device.lighting.charging', 'setChargingStatic', in_sig='yyy')
@@ -134,8 +132,7 @@ def set_charging_none(self):
 
     driver_path = self.get_driver_path('charging_matrix_effect_none')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.charging', 'setChargingBreathRandom')
@@ -155,8 +152,7 @@ def set_charging_breath_random(self):
 
     payload = b'1'
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.charging', 'setChargingBreathSingle', in_sig='yyy')
@@ -186,8 +182,7 @@ def set_charging_breath_single(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.charging', 'setChargingBreathDual', in_sig='yyyyyy')
@@ -226,11 +221,10 @@ def set_charging_breath_dual(self, red1, green1, blue1, red2, green2, blue2):
 
     payload = bytes([red1, green1, blue1, red2, green2, blue2])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
-@endpoint('razer.device.lighting.fast_charging', 'getFastChargingBrightness', out_sig='d')
+@endpoint('razer.device.lighting.fast_charging', 'getFastChargingBrightness', out_sig='d', state_only=True)
 def get_fast_charging_brightness(self):
     """
     Get the device's brightness
@@ -264,8 +258,7 @@ def set_fast_charging_brightness(self, brightness):
 
     brightness = int(round(brightness * (255.0 / 100.0)))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(brightness))
+    self.write_driver_file(driver_path, str(brightness))
 
     # Notify others
     self.send_effect_event('setBrightness', brightness)
@@ -292,8 +285,7 @@ def set_fast_charging_wave(self, direction):
     if direction not in self.WAVE_DIRS:
         direction = self.WAVE_DIRS[0]
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(direction))
+    self.write_driver_file(driver_path, str(direction))
 
 
 @endpoint('razer.device.lighting.fast_charging', 'setFastChargingStatic', in_sig='yyy')
@@ -361,8 +353,7 @@ def set_fast_charging_none(self):
 
     driver_path = self.get_driver_path('fast_charging_matrix_effect_none')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.fast_charging', 'setFastChargingBreathRandom')
@@ -382,8 +373,7 @@ def set_fast_charging_breath_random(self):
 
     payload = b'1'
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.fast_charging', 'setFastChargingBreathSingle', in_sig='yyy')
@@ -413,8 +403,7 @@ def set_fast_charging_breath_single(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.fast_charging', 'setFastChargingBreathDual', in_sig='yyyyyy')
@@ -453,11 +442,10 @@ def set_fast_charging_breath_dual(self, red1, green1, blue1, red2, green2, blue2
 
     payload = bytes([red1, green1, blue1, red2, green2, blue2])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
-@endpoint('razer.device.lighting.fully_charged', 'getFullyChargedBrightness', out_sig='d')
+@endpoint('razer.device.lighting.fully_charged', 'getFullyChargedBrightness', out_sig='d', state_only=True)
 def get_fully_charged_brightness(self):
     """
     Get the device's brightness
@@ -491,8 +479,7 @@ def set_fully_charged_brightness(self, brightness):
 
     brightness = int(round(brightness * (255.0 / 100.0)))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(brightness))
+    self.write_driver_file(driver_path, str(brightness))
 
     # Notify others
     self.send_effect_event('setBrightness', brightness)
@@ -519,8 +506,7 @@ def set_fully_charged_wave(self, direction):
     if direction not in self.WAVE_DIRS:
         direction = self.WAVE_DIRS[0]
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(direction))
+    self.write_driver_file(driver_path, str(direction))
 
 
 @endpoint('razer.device.lighting.fully_charged', 'setFullyChargedStatic', in_sig='yyy')
@@ -588,8 +574,7 @@ def set_fully_charged_none(self):
 
     driver_path = self.get_driver_path('fully_charged_matrix_effect_none')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.fully_charged', 'setFullyChargedBreathRandom')
@@ -609,8 +594,7 @@ def set_fully_charged_breath_random(self):
 
     payload = b'1'
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.fully_charged', 'setFullyChargedBreathSingle', in_sig='yyy')
@@ -640,8 +624,7 @@ def set_fully_charged_breath_single(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.fully_charged', 'setFullyChargedBreathDual', in_sig='yyyyyy')
@@ -680,5 +663,4 @@ def set_fully_charged_breath_dual(self, red1, green1, blue1, red2, green2, blue2
 
     payload = bytes([red1, green1, blue1, red2, green2, blue2])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
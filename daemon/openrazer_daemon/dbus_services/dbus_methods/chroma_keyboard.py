@@ -7,7 +7,7 @@ import os
 from openrazer_daemon.dbus_services import endpoint
 
 
-@endpoint('razer.device.lighting.brightness', 'getBrightness', out_sig='d')
+@endpoint('razer.device.lighting.brightness', 'getBrightness', out_sig='d', state_only=True)
 def get_brightness(self):
     """
     Get the device's brightness
@@ -43,8 +43,7 @@ def set_brightness(self, brightness):
 
     brightness = int(round(brightness * (255.0 / 100.0)))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(brightness))
+    self.write_driver_file(driver_path, str(brightness))
 
     # Notify others
     self.send_effect_event('setBrightness', brightness)
@@ -62,8 +61,7 @@ def get_game_mode(self):
 
     driver_path = self.get_driver_path('game_led_state')
 
-    with open(driver_path, 'r') as driver_file:
-        return driver_file.read().strip() == '1'
+    return self.state_cache.get('razer.device.led.gamemode', 'getGameMode', lambda: self.read_driver_file(driver_path).strip() == '1')
 
 
 @endpoint('razer.device.led.gamemode', 'setGameMode', in_sig='b')
@@ -119,6 +117,8 @@ def set_game_mode(self, enable):
         else:
             driver_file.write('0')
 
+    self.state_cache.update('razer.device.led.gamemode', 'getGameMode', bool(enable))
+
 
 @endpoint('razer.device.led.macromode', 'getMacroMode', out_sig='b')
 def get_macro_mode(self):
@@ -132,8 +132,7 @@ def get_macro_mode(self):
 
     driver_path = self.get_driver_path('macro_led_state')
 
-    with open(driver_path, 'r') as driver_file:
-        return driver_file.read().strip() == '1'
+    return self.state_cache.get('razer.device.led.macromode', 'getMacroMode', lambda: self.read_driver_file(driver_path).strip() == '1')
 
 
 @endpoint('razer.device.led.macromode', 'setMacroMode', in_sig='b')
@@ -154,6 +153,8 @@ def set_macro_mode(self, enable):
         else:
             driver_file.write('0')
 
+    self.state_cache.update('razer.device.led.macromode', 'getMacroMode', bool(enable))
+
 
 @endpoint('razer.device.misc.keyswitchoptimization', 'getKeyswitchOptimization', out_sig='b')
 def get_keyswitch_optimization(self):
@@ -167,8 +168,7 @@ def get_keyswitch_optimization(self):
 
     driver_path = self.get_driver_path('keyswitch_optimization')
 
-    with open(driver_path, 'r') as driver_file:
-        return driver_file.read().strip() == '1'
+    return self.state_cache.get('razer.device.misc.keyswitchoptimization', 'getKeyswitchOptimization', lambda: self.read_driver_file(driver_path).strip() == '1')
 
 
 @endpoint('razer.device.misc.keyswitchoptimization', 'setKeyswitchOptimization', in_sig='b')
@@ -189,6 +189,8 @@ def set_keyswitch_optimization(self, enable):
         else:
             driver_file.write('0')
 
+    self.state_cache.update('razer.device.misc.keyswitchoptimization', 'getKeyswitchOptimization', bool(enable))
+
 
 @endpoint('razer.device.led.macromode', 'getMacroEffect', out_sig='i')
 def get_macro_effect(self):
@@ -202,8 +204,7 @@ def get_macro_effect(self):
 
     driver_path = self.get_driver_path('macro_led_effect')
 
-    with open(driver_path, 'r') as driver_file:
-        return int(driver_file.read().strip())
+    return self.state_cache.get('razer.device.led.macromode', 'getMacroEffect', lambda: int(self.read_driver_file(driver_path).strip()))
 
 
 @endpoint('razer.device.led.macromode', 'setMacroEffect', in_sig='y')
@@ -218,8 +219,9 @@ def set_macro_effect(self, effect):
 
     driver_path = self.get_driver_path('macro_led_effect')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(int(effect)))
+    self.write_driver_file(driver_path, str(int(effect)))
+
+    self.state_cache.update('razer.device.led.macromode', 'getMacroEffect', int(effect))
 
 
 @endpoint('razer.device.lighting.chroma', 'setWave', in_sig='i')
@@ -244,8 +246,7 @@ def set_wave_effect(self, direction):
     if direction not in self.WAVE_DIRS:
         direction = self.WAVE_DIRS[0]
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(direction))
+    self.write_driver_file(driver_path, str(direction))
 
 
 @endpoint('razer.device.lighting.chroma', 'setWheel', in_sig='i')
@@ -272,8 +273,7 @@ def set_wheel_effect(self, direction):
     if direction not in (1, 2):
         direction = 1
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(direction))
+    self.write_driver_file(driver_path, str(direction))
 
 
 @endpoint('razer.device.lighting.chroma', 'setStatic', in_sig='yyy')
@@ -303,8 +303,7 @@ def set_static_effect(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.chroma', 'setBlinking', in_sig='yyy')
@@ -334,8 +333,7 @@ def set_blinking_effect(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.chroma', 'setSpectrum')
@@ -353,8 +351,7 @@ def set_spectrum_effect(self):
 
     driver_path = self.get_driver_path('matrix_effect_spectrum')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.chroma', 'setNone')
@@ -372,8 +369,7 @@ def set_none_effect(self):
 
     driver_path = self.get_driver_path('matrix_effect_none')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.misc', 'triggerReactive')
@@ -388,8 +384,7 @@ def trigger_reactive_effect(self):
 
     driver_path = self.get_driver_path('matrix_reactive_trigger')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.chroma', 'setReactive', in_sig='yyyy')
@@ -427,8 +422,7 @@ def set_reactive_effect(self, red, green, blue, speed):
 
     payload = bytes([speed, red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.chroma', 'setBreathRandom')
@@ -448,8 +442,7 @@ def set_breath_random_effect(self):
 
     payload = b'1'
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.chroma', 'setBreathSingle', in_sig='yyy')
@@ -479,8 +472,7 @@ def set_breath_single_effect(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.chroma', 'setBreathDual', in_sig='yyyyyy')
@@ -519,8 +511,7 @@ def set_breath_dual_effect(self, red1, green1, blue1, red2, green2, blue2):
 
     payload = bytes([red1, green1, blue1, red2, green2, blue2])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.chroma', 'setBreathTriple', in_sig='yyyyyyyyy')
@@ -568,8 +559,7 @@ def set_breath_triple_effect(self, red1, green1, blue1, red2, green2, blue2, red
 
     payload = bytes([red1, green1, blue1, red2, green2, blue2, red3, green3, blue3])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.chroma', 'setCustom')
@@ -601,6 +591,43 @@ def set_key_row(self, payload):
     self._set_key_row(payload)
 
 
+@endpoint('razer.device.lighting.chroma', 'getFramebuffer', out_sig='hu')
+def get_framebuffer(self):
+    """
+    Get a new framebuffer for the device
+
+    The framebuffer holds a frame in the same format as setKeyRow. Clients
+    map it, draw into it and present the frame with commitFramebuffer, so
+    frames don't have to be sent over the bus. Every call returns a new
+    framebuffer, clients should get one and keep using it.
+
+    :return: File descriptor and ID of the framebuffer
+    :rtype: tuple
+    """
+    self.logger.debug("DBus call get_framebuffer")
+
+    return self.create_framebuffer()
+
+
+@endpoint('razer.device.lighting.chroma', 'commitFramebuffer', in_sig='uu')
+def commit_framebuffer(self, framebuffer_id, length):
+    """
+    Show the frame in a framebuffer
+
+    Does the same as setKeyRow followed by setCustom.
+
+    :param framebuffer_id: Framebuffer ID from getFramebuffer
+    :type framebuffer_id: int
+
+    :param length: Length of the frame in bytes
+    :type length: int
+    """
+    self.send_effect_event('setCustom')
+
+    self._set_key_row(self.read_framebuffer(framebuffer_id, length))
+    self._set_custom_effect()
+
+
 @endpoint('razer.device.lighting.custom', 'setRipple', in_sig='yyyd')
 def set_ripple_effect(self, red, green, blue, refresh_rate):
     """
@@ -654,8 +681,7 @@ def set_starlight_random_effect(self, speed):
 
     driver_path = self.get_driver_path('matrix_effect_starlight')
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(bytes([speed]))
+    self.write_driver_file(driver_path, bytes([speed]))
 
     # Notify others
     self.send_effect_event('setStarlightRandom')
@@ -674,8 +700,7 @@ def set_starlight_single_effect(self, red, green, blue, speed):
 
     driver_path = self.get_driver_path('matrix_effect_starlight')
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(bytes([speed, red, green, blue]))
+    self.write_driver_file(driver_path, bytes([speed, red, green, blue]))
 
     # Notify others
     self.send_effect_event('setStarlightSingle', red, green, blue, speed)
@@ -695,8 +720,7 @@ def set_starlight_dual_effect(self, red1, green1, blue1, red2, green2, blue2, sp
 
     driver_path = self.get_driver_path('matrix_effect_starlight')
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(bytes([speed, red1, green1, blue1, red2, green2, blue2]))
+    self.write_driver_file(driver_path, bytes([speed, red1, green1, blue1, red2, green2, blue2]))
 
     # Notify others
     self.send_effect_event('setStarlightDual', red1, green1, blue1, red2, green2, blue2, speed)
@@ -3,7 +3,7 @@
 from openrazer_daemon.dbus_services import endpoint
 
 
-@endpoint('razer.device.lighting.backlight', 'getBacklightBrightness', out_sig='d')
+@endpoint('razer.device.lighting.backlight', 'getBacklightBrightness', out_sig='d', state_only=True)
 def get_backlight_brightness(self):
     """
     Get the device's brightness
@@ -33,14 +33,13 @@ def set_backlight_brightness(self, brightness):
 
     brightness = int(round(brightness * (255.0 / 100.0)))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(brightness))
+    self.write_driver_file(driver_path, str(brightness))
 
     # Notify others
     self.send_effect_event('setBrightness', brightness)
 
 
-@endpoint('razer.device.lighting.logo', 'getLogoActive', out_sig='b')
+@endpoint('razer.device.lighting.logo', 'getLogoActive', out_sig='b', state_only=True)
 def get_logo_active(self):
     """
     Get if the logo is lit up
@@ -62,11 +61,10 @@ def set_logo_active(self, active):
 
     driver_path = self.get_driver_path('logo_led_state')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1' if active else '0')
+    self.write_driver_file(driver_path, '1' if active else '0')
 
 
-@endpoint('razer.device.lighting.logo', 'getLogoBrightness', out_sig='d')
+@endpoint('razer.device.lighting.logo', 'getLogoBrightness', out_sig='d', state_only=True)
 def get_logo_brightness(self):
     """
     Get the device's brightness
@@ -96,14 +94,13 @@ def set_logo_brightness(self, brightness):
 
     brightness = int(round(brightness * (255.0 / 100.0)))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(brightness))
+    self.write_driver_file(driver_path, str(brightness))
 
     # Notify others
     self.send_effect_event('setBrightness', brightness)
 
 
-@endpoint('razer.device.lighting.scroll', 'getScrollBrightness', out_sig='d')
+@endpoint('razer.device.lighting.scroll', 'getScrollBrightness', out_sig='d', state_only=True)
 def get_scroll_brightness(self):
     """
     Get the device's brightness
@@ -133,8 +130,7 @@ def set_scroll_brightness(self, brightness):
 
     brightness = int(round(brightness * (255.0 / 100.0)))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(brightness))
+    self.write_driver_file(driver_path, str(brightness))
 
     # Notify others
     self.send_effect_event('setBrightness', brightness)
@@ -18,8 +18,7 @@ def keypad_get_profile_led_red(self):
 
     driver_path = self.get_driver_path('profile_led_red')
 
-    with open(driver_path, 'r') as driver_file:
-        return driver_file.read().strip() == '1'
+    return self.state_cache.get('razer.device.lighting.profile_led', 'getRedLED', lambda: self.read_driver_file(driver_path).strip() == '1')
 
 
 @endpoint('razer.device.lighting.profile_led', 'setRedLED', in_sig='b')
@@ -40,6 +39,8 @@ def keypad_set_profile_led_red(self, enable):
         else:
             driver_file.write('0')
 
+    self.state_cache.update('razer.device.lighting.profile_led', 'getRedLED', bool(enable))
+
 
 @endpoint('razer.device.lighting.profile_led', 'getGreenLED', out_sig='b')
 def keypad_get_profile_led_green(self):
@@ -53,8 +54,7 @@ def keypad_get_profile_led_green(self):
 
     driver_path = self.get_driver_path('profile_led_green')
 
-    with open(driver_path, 'r') as driver_file:
-        return driver_file.read().strip() == '1'
+    return self.state_cache.get('razer.device.lighting.profile_led', 'getGreenLED', lambda: self.read_driver_file(driver_path).strip() == '1')
 
 
 @endpoint('razer.device.lighting.profile_led', 'setGreenLED', in_sig='b')
@@ -75,6 +75,8 @@ def keypad_set_profile_led_green(self, enable):
         else:
             driver_file.write('0')
 
+    self.state_cache.update('razer.device.lighting.profile_led', 'getGreenLED', bool(enable))
+
 
 @endpoint('razer.device.lighting.profile_led', 'getBlueLED', out_sig='b')
 def keypad_get_profile_led_blue(self):
@@ -88,8 +90,7 @@ def keypad_get_profile_led_blue(self):
 
     driver_path = self.get_driver_path('profile_led_blue')
 
-    with open(driver_path, 'r') as driver_file:
-        return driver_file.read().strip() == '1'
+    return self.state_cache.get('razer.device.lighting.profile_led', 'getBlueLED', lambda: self.read_driver_file(driver_path).strip() == '1')
 
 
 @endpoint('razer.device.lighting.profile_led', 'setBlueLED', in_sig='b')
@@ -110,6 +111,8 @@ def keypad_set_profile_led_blue(self, enable):
         else:
             driver_file.write('0')
 
+    self.state_cache.update('razer.device.lighting.profile_led', 'getBlueLED', bool(enable))
+
 
 @endpoint('razer.device.macro', 'getModeModifier', out_sig='b')
 def keypad_get_mode_modifier(self):
@@ -33,5 +33,4 @@ def set_custom_kraken(self, rgbi):
         else:
             rgbi_list[index] = item
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(bytes(rgbi_list))
+    self.write_driver_file(driver_path, bytes(rgbi_list))
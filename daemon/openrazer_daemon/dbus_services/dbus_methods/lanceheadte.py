@@ -25,8 +25,7 @@ def set_logo_wave(self, direction):
     if direction not in self.WAVE_DIRS:
         direction = self.WAVE_DIRS[0]
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(direction))
+    self.write_driver_file(driver_path, str(direction))
 
 
 @endpoint('razer.device.lighting.scroll', 'setScrollWave', in_sig='i')
@@ -51,11 +50,10 @@ def set_scroll_wave(self, direction):
     if direction not in self.WAVE_DIRS:
         direction = self.WAVE_DIRS[0]
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(direction))
+    self.write_driver_file(driver_path, str(direction))
 
 
-@endpoint('razer.device.lighting.left', 'getLeftBrightness', out_sig='d')
+@endpoint('razer.device.lighting.left', 'getLeftBrightness', out_sig='d', state_only=True)
 def get_left_brightness(self):
     """
     Get the device's brightness
@@ -91,8 +89,7 @@ def set_left_brightness(self, brightness):
 
     brightness = int(round(brightness * (255.0 / 100.0)))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(brightness))
+    self.write_driver_file(driver_path, str(brightness))
 
     # Notify others
     self.send_effect_event('setBrightness', brightness)
@@ -120,8 +117,7 @@ def set_left_wave(self, direction):
     if direction not in self.WAVE_DIRS:
         direction = self.WAVE_DIRS[0]
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(direction))
+    self.write_driver_file(driver_path, str(direction))
 
 
 @endpoint('razer.device.lighting.left', 'setLeftStatic', in_sig='yyy')
@@ -189,8 +185,7 @@ def set_left_none(self):
 
     driver_path = self.get_driver_path('left_matrix_effect_none')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.left', 'setLeftReactive', in_sig='yyyy')
@@ -228,8 +223,7 @@ def set_left_reactive(self, red, green, blue, speed):
 
     payload = bytes([speed, red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.left', 'setLeftBreathRandom')
@@ -249,8 +243,7 @@ def set_left_breath_random(self):
 
     payload = b'1'
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.left', 'setLeftBreathSingle', in_sig='yyy')
@@ -280,8 +273,7 @@ def set_left_breath_single(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.left', 'setLeftBreathDual', in_sig='yyyyyy')
@@ -320,11 +312,10 @@ def set_left_breath_dual(self, red1, green1, blue1, red2, green2, blue2):
 
     payload = bytes([red1, green1, blue1, red2, green2, blue2])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
-@endpoint('razer.device.lighting.right', 'getRightBrightness', out_sig='d')
+@endpoint('razer.device.lighting.right', 'getRightBrightness', out_sig='d', state_only=True)
 def get_right_brightness(self):
     """
     Get the device's brightness
@@ -359,8 +350,7 @@ def set_right_brightness(self, brightness):
 
     brightness = int(round(brightness * (255.0 / 100.0)))
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(brightness))
+    self.write_driver_file(driver_path, str(brightness))
 
     # Notify others
     self.send_effect_event('setBrightness', brightness)
@@ -388,8 +378,7 @@ def set_right_wave(self, direction):
     if direction not in self.WAVE_DIRS:
         direction = self.WAVE_DIRS[0]
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(direction))
+    self.write_driver_file(driver_path, str(direction))
 
 
 @endpoint('razer.device.lighting.right', 'setRightStatic', in_sig='yyy')
@@ -457,8 +446,7 @@ def set_right_none(self):
 
     driver_path = self.get_driver_path('right_matrix_effect_none')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.right', 'setRightReactive', in_sig='yyyy')
@@ -496,8 +484,7 @@ def set_right_reactive(self, red, green, blue, speed):
 
     payload = bytes([speed, red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.right', 'setRightBreathRandom')
@@ -517,8 +504,7 @@ def set_right_breath_random(self):
 
     payload = b'1'
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.right', 'setRightBreathSingle', in_sig='yyy')
@@ -548,8 +534,7 @@ def set_right_breath_single(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.right', 'setRightBreathDual', in_sig='yyyyyy')
@@ -588,8 +573,7 @@ def set_right_breath_dual(self, red1, green1, blue1, red2, green2, blue2):
 
     payload = bytes([red1, green1, blue1, red2, green2, blue2])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.backlight', 'setBacklightWave', in_sig='i')
@@ -614,8 +598,7 @@ def set_backlight_wave(self, direction):
     if direction not in self.WAVE_DIRS:
         direction = self.WAVE_DIRS[0]
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(direction))
+    self.write_driver_file(driver_path, str(direction))
 
 
 @endpoint('razer.device.lighting.backlight', 'setBacklightStatic', in_sig='yyy')
@@ -683,8 +666,7 @@ def set_backlight_none(self):
 
     driver_path = self.get_driver_path('backlight_matrix_effect_none')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.backlight', 'setBacklightOn')
@@ -702,8 +684,7 @@ def set_backlight_on(self):
 
     driver_path = self.get_driver_path('backlight_matrix_effect_on')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.backlight', 'setBacklightReactive', in_sig='yyyy')
@@ -741,8 +722,7 @@ def set_backlight_reactive(self, red, green, blue, speed):
 
     payload = bytes([speed, red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.backlight', 'setBacklightBreathRandom')
@@ -762,8 +742,7 @@ def set_backlight_breath_random(self):
 
     payload = b'1'
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.backlight', 'setBacklightBreathSingle', in_sig='yyy')
@@ -793,8 +772,7 @@ def set_backlight_breath_single(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.backlight', 'setBacklightBreathDual', in_sig='yyyyyy')
@@ -833,5 +811,4 @@ def set_backlight_breath_dual(self, red1, green1, blue1, red2, green2, blue2):
 
     payload = bytes([red1, green1, blue1, red2, green2, blue2])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
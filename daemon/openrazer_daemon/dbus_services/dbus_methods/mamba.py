@@ -3,6 +3,7 @@
 import math
 import struct
 from openrazer_daemon.dbus_services import endpoint
+from openrazer_daemon.misc.state_cache import VOLATILE_TTL
 
 
 @endpoint('razer.device.power', 'getBattery', out_sig='d')
@@ -14,14 +15,16 @@ def get_battery(self):
 
     driver_path = self.get_driver_path('charge_level')
 
-    with open(driver_path, 'r') as driver_file:
-        battery_255 = float(driver_file.read().strip())
+    def read_battery():
+        battery_255 = float(self.read_driver_file(driver_path).strip())
         if battery_255 < 0:
             return -1.0
 
         battery_100 = (battery_255 / 255) * 100
         return battery_100
 
+    return self.state_cache.get('razer.device.power', 'getBattery', read_battery, ttl=VOLATILE_TTL)
+
 
 @endpoint('razer.device.power', 'isCharging', out_sig='b')
 def is_charging(self):
@@ -32,8 +35,7 @@ def is_charging(self):
 
     driver_path = self.get_driver_path('charge_status')
 
-    with open(driver_path, 'r') as driver_file:
-        return bool(int(driver_file.read().strip()))
+    return self.state_cache.get('razer.device.power', 'isCharging', lambda: bool(int(self.read_driver_file(driver_path).strip())), ttl=VOLATILE_TTL)
 
 
 @endpoint('razer.device.power', 'setIdleTime', in_sig='q')
@@ -48,8 +50,9 @@ def set_idle_time(self, idle_time):
 
     driver_path = self.get_driver_path('device_idle_time')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(idle_time))
+    self.write_driver_file(driver_path, str(idle_time))
+
+    self.state_cache.update('razer.device.power', 'getIdleTime', int(idle_time))
 
 
 @endpoint('razer.device.power', 'getIdleTime', out_sig='q')
@@ -64,11 +67,14 @@ def get_idle_time(self):
 
     driver_path = self.get_driver_path('device_idle_time')
 
-    with open(driver_path, 'r') as driver_file:
-        result = driver_file.read()
-        result = int(result.strip())
+    def read_idle_time():
+        with open(driver_path, 'r') as driver_file:
+            result = driver_file.read()
+            result = int(result.strip())
+
+        return result
 
-    return result
+    return self.state_cache.get('razer.device.power', 'getIdleTime', read_idle_time)
 
 
 @endpoint('razer.device.power', 'setLowBatteryThreshold', in_sig='y')
@@ -85,8 +91,9 @@ def set_low_battery_threshold(self, threshold):
 
     threshold = math.floor((threshold / 100) * 255)
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(threshold))
+    self.write_driver_file(driver_path, str(threshold))
+
+    self.state_cache.update('razer.device.power', 'getLowBatteryThreshold', round((threshold / 255) * 100))
 
 
 @endpoint('razer.device.power', 'getLowBatteryThreshold', out_sig='y')
@@ -101,11 +108,14 @@ def get_low_battery_threshold(self):
 
     driver_path = self.get_driver_path('charge_low_threshold')
 
-    with open(driver_path, 'r') as driver_file:
-        result = driver_file.read()
-        result = int(result.strip())
+    def read_low_battery_threshold():
+        with open(driver_path, 'r') as driver_file:
+            result = driver_file.read()
+            result = int(result.strip())
+
+        return round((result / 255) * 100)
 
-    return round((result / 255) * 100)
+    return self.state_cache.get('razer.device.power', 'getLowBatteryThreshold', read_low_battery_threshold)
 
 
 @endpoint('razer.device.lighting.power', 'setChargeEffect', in_sig='y')
@@ -124,8 +134,7 @@ def set_charge_effect(self, charge_effect):
 
     driver_path = self.get_driver_path('charge_effect')
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(bytes([charge_effect]))
+    self.write_driver_file(driver_path, bytes([charge_effect]))
 
 
 @endpoint('razer.device.lighting.power', 'setChargeColour', in_sig='yyy')
@@ -148,8 +157,7 @@ def set_charge_colour(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.dpi', 'setDPI', in_sig='qq')
@@ -178,12 +186,20 @@ def set_dpi_xy(self, dpi_x, dpi_y):
 
     driver_path = self.get_driver_path('dpi')
 
+    # What getDPI will read back, the driver sets a single value as X and Y
+    if 'available_dpi' in self.METHODS:
+        dpi = [dpi_x, 0]
+    elif dpi_y <= 0:
+        dpi = [dpi_x, dpi_x]
+    else:
+        dpi = [dpi_x, dpi_y]
+
     if self._testing:
-        with open(driver_path, 'w') as driver_file:
-            if dpi_y <= 0:
-                driver_file.write("{}".format(dpi_x))
-            else:
-                driver_file.write("{}:{}".format(dpi_x, dpi_y))
+        if 'available_dpi' in self.METHODS:
+            self.write_driver_file(driver_path, "{}".format(dpi_x))
+        else:
+            self.write_driver_file(driver_path, "{}:{}".format(*dpi))
+        self.state_cache.update('razer.device.dpi', 'getDPI', dpi, ttl=VOLATILE_TTL)
         return
 
     # If the application requests just one value to be written
@@ -199,8 +215,9 @@ def set_dpi_xy(self, dpi_x, dpi_y):
     self.set_persistence(None, "dpi_x", dpi_x)
     self.set_persistence(None, "dpi_y", dpi_y)
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(dpi_bytes)
+    self.write_driver_file(driver_path, dpi_bytes)
+
+    self.state_cache.update('razer.device.dpi', 'getDPI', dpi, ttl=VOLATILE_TTL)
 
 
 @endpoint('razer.device.dpi', 'getDPI', out_sig='ai')
@@ -215,23 +232,25 @@ def get_dpi_xy(self):
 
     driver_path = self.get_driver_path('dpi')
 
-    # try retrieving DPI from the hardware.
+    def read_dpi():
+        result = self.read_driver_file(driver_path)
+        dpi = [int(dpi) for dpi in result.strip().split(':')]
+
+        if 'available_dpi' in self.METHODS:
+            if len(dpi) != 1:
+                raise RuntimeError("Devices with available_dpi are expected to have only one DPI value returned from driver, got " + str(dpi))
+            dpi = [dpi[0], 0]
+
+        return dpi
+
+    # try retrieving DPI from the hardware, the DPI buttons change it.
     # if we can't (e.g. because the mouse has been disconnected)
     # return the value in local storage.
     try:
-        with open(driver_path, 'r') as driver_file:
-            result = driver_file.read()
-            dpi = [int(dpi) for dpi in result.strip().split(':')]
+        return self.state_cache.get('razer.device.dpi', 'getDPI', read_dpi, ttl=VOLATILE_TTL)
     except FileNotFoundError:
         return self.dpi
 
-    if 'available_dpi' in self.METHODS:
-        if len(dpi) != 1:
-            raise RuntimeError("Devices with available_dpi are expected to have only one DPI value returned from driver, got " + str(dpi))
-        dpi = dpi[0], 0
-
-    return dpi
-
 
 @endpoint('razer.device.dpi', 'setDPIStages', in_sig='ya(qq)')
 def set_dpi_stages(self, active_stage, dpi_stages):
@@ -250,8 +269,7 @@ def set_dpi_stages(self, active_stage, dpi_stages):
     for dpi_x, dpi_y in dpi_stages:
         dpi_bytes += struct.pack('>HH', dpi_x, dpi_y)
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(dpi_bytes)
+    self.write_driver_file(driver_path, dpi_bytes)
 
 
 @endpoint('razer.device.dpi', 'getDPIStages', out_sig='(ya(qq))')
@@ -281,14 +299,14 @@ def get_dpi_stages(self):
     return (active_stage, dpi_stages)
 
 
-@endpoint('razer.device.dpi', 'maxDPI', out_sig='i')
+@endpoint('razer.device.dpi', 'maxDPI', out_sig='i', state_only=True)
 def max_dpi(self):
     self.logger.debug("DBus call max_dpi")
 
     return self.DPI_MAX
 
 
-@endpoint('razer.device.dpi', 'availableDPI', out_sig='ai')
+@endpoint('razer.device.dpi', 'availableDPI', out_sig='ai', state_only=True)
 def available_dpi(self):
     self.logger.debug("DBus call available_dpi")
 
@@ -316,11 +334,10 @@ def set_poll_rate(self, rate):
     # remember poll rate
     self.poll_rate = rate
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(rate))
+    self.write_driver_file(driver_path, str(rate))
 
 
-@endpoint('razer.device.misc', 'getPollRate', out_sig='i')
+@endpoint('razer.device.misc', 'getPollRate', out_sig='i', state_only=True)
 def get_poll_rate(self):
     """
     Get the polling rate from the device
@@ -333,7 +350,7 @@ def get_poll_rate(self):
     return int(self.poll_rate)
 
 
-@endpoint('razer.device.misc', 'getSupportedPollRates', out_sig='aq')
+@endpoint('razer.device.misc', 'getSupportedPollRates', out_sig='aq', state_only=True)
 def get_supported_poll_rates(self):
     """
     Get the polling rates supported by the device
@@ -361,8 +378,7 @@ def set_hyperpolling_wireless_dongle_indicator_led_mode(self, mode):
 
     driver_path = self.get_driver_path('hyperpolling_wireless_dongle_indicator_led_mode')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(mode))
+    self.write_driver_file(driver_path, str(mode))
 
 
 @endpoint('razer.device.misc', 'setHyperPollingPair', in_sig='s')
@@ -377,8 +393,7 @@ def set_hyperpolling_wireless_dongle_pair(self, pid):
 
     driver_path = self.get_driver_path('hyperpolling_wireless_dongle_pair')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(pid)
+    self.write_driver_file(driver_path, pid)
 
 
 @endpoint('razer.device.misc', 'setHyperPollingUnpair', in_sig='s')
@@ -393,5 +408,4 @@ def set_hyperpolling_wireless_dongle_unpair(self, pid):
 
     driver_path = self.get_driver_path('hyperpolling_wireless_dongle_unpair')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(pid)
+    self.write_driver_file(driver_path, pid)
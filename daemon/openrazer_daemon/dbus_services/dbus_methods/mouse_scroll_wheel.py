@@ -1,6 +1,7 @@
 # SPDX-License-Identifier: GPL-2.0-or-later
 
 from openrazer_daemon.dbus_services import endpoint
+from openrazer_daemon.misc.state_cache import VOLATILE_TTL
 
 
 @endpoint('razer.device.scroll', 'setScrollMode', in_sig='y')
@@ -18,8 +19,9 @@ def set_scroll_mode(self, mode):
 
     driver_path = self.get_driver_path('scroll_mode')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(int(mode)))
+    self.write_driver_file(driver_path, str(int(mode)))
+
+    self.state_cache.update('razer.device.scroll', 'getScrollMode', int(mode), ttl=VOLATILE_TTL)
 
 
 @endpoint('razer.device.scroll', 'getScrollMode', out_sig='y')
@@ -34,8 +36,8 @@ def get_scroll_mode(self):
 
     driver_path = self.get_driver_path('scroll_mode')
 
-    with open(driver_path, 'r') as driver_file:
-        return int(driver_file.read().strip())
+    # Some mice switch the scroll mode with a button
+    return self.state_cache.get('razer.device.scroll', 'getScrollMode', lambda: int(self.read_driver_file(driver_path).strip()), ttl=VOLATILE_TTL)
 
 
 @endpoint('razer.device.scroll', 'setScrollAcceleration', in_sig='b')
@@ -50,8 +52,9 @@ def set_scroll_acceleration(self, enabled):
 
     driver_path = self.get_driver_path('scroll_acceleration')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(int(enabled)))
+    self.write_driver_file(driver_path, str(int(enabled)))
+
+    self.state_cache.update('razer.device.scroll', 'getScrollAcceleration', bool(enabled))
 
 
 @endpoint('razer.device.scroll', 'getScrollAcceleration', out_sig='b')
@@ -66,8 +69,7 @@ def get_scroll_acceleration(self):
 
     driver_path = self.get_driver_path('scroll_acceleration')
 
-    with open(driver_path, 'r') as driver_file:
-        return bool(int(driver_file.read().strip()))
+    return self.state_cache.get('razer.device.scroll', 'getScrollAcceleration', lambda: bool(int(self.read_driver_file(driver_path).strip())))
 
 
 @endpoint('razer.device.scroll', 'setScrollSmartReel', in_sig='b')
@@ -82,8 +84,9 @@ def set_scroll_smart_reel(self, enabled):
 
     driver_path = self.get_driver_path('scroll_smart_reel')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write(str(int(enabled)))
+    self.write_driver_file(driver_path, str(int(enabled)))
+
+    self.state_cache.update('razer.device.scroll', 'getScrollSmartReel', bool(enabled))
 
 
 @endpoint('razer.device.scroll', 'getScrollSmartReel', out_sig='b')
@@ -98,5 +101,4 @@ def get_scroll_smart_reel(self):
 
     driver_path = self.get_driver_path('scroll_smart_reel')
 
-    with open(driver_path, 'r') as driver_file:
-        return bool(int(driver_file.read().strip()))
+    return self.state_cache.get('razer.device.scroll', 'getScrollSmartReel', lambda: bool(int(self.read_driver_file(driver_path).strip())))
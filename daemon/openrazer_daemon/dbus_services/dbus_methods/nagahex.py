@@ -5,6 +5,7 @@ Naga Hex DPI
 """
 import struct
 from openrazer_daemon.dbus_services import endpoint
+from openrazer_daemon.misc.state_cache import VOLATILE_TTL
 
 
 @endpoint('razer.device.dpi', 'setDPI', in_sig='qq')
@@ -46,14 +47,15 @@ def set_dpi_xy_byte(self, dpi_x, dpi_y):
     self.set_persistence(None, "dpi_y", dpi_y_scaled)
 
     if self._testing:
-        with open(driver_path, 'w') as driver_file:
-            driver_file.write("{}:{}".format(dpi_x_scaled, dpi_y_scaled))
-        return
+        self.write_driver_file(driver_path, "{}:{}".format(dpi_x_scaled, dpi_y_scaled))
+    else:
+        dpi_bytes = struct.pack('>BB', dpi_x_scaled, dpi_y_scaled)
 
-    dpi_bytes = struct.pack('>BB', dpi_x_scaled, dpi_y_scaled)
+        self.write_driver_file(driver_path, dpi_bytes)
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(dpi_bytes)
+    # Same rounding as getDPI
+    dpi = [int(round(dpi_x_scaled / 255 * 6750, 2)), int(round(dpi_y_scaled / 255 * 6750, 2))]
+    self.state_cache.update('razer.device.dpi', 'getDPI', dpi, ttl=VOLATILE_TTL)
 
 
 @endpoint('razer.device.dpi', 'getDPI', out_sig='ai')
@@ -68,16 +70,18 @@ def get_dpi_xy_byte(self):
 
     driver_path = self.get_driver_path('dpi')
 
+    def read_dpi():
+        result = self.read_driver_file(driver_path)
+        dpi_x, dpi_y = [int(dpi) for dpi in result.strip().split(':')]
+        dpi_x = int(round(dpi_x / 255 * 6750, 2))
+        dpi_y = int(round(dpi_y / 255 * 6750, 2))
+
+        return [dpi_x, dpi_y]
+
     # try retrieving DPI from the hardware.
     # if we can't (e.g. because the mouse has been disconnected)
     # return the value in local storage.
     try:
-        with open(driver_path, 'r') as driver_file:
-            result = driver_file.read()
-            dpi_x, dpi_y = [int(dpi) for dpi in result.strip().split(':')]
-        dpi_x = int(round(dpi_x / 255 * 6750, 2))
-        dpi_y = int(round(dpi_y / 255 * 6750, 2))
+        return self.state_cache.get('razer.device.dpi', 'getDPI', read_dpi, ttl=VOLATILE_TTL)
     except FileNotFoundError:
-        dpi_x, dpi_y = self.dpi
-
-    return [dpi_x, dpi_y]
+        return list(self.dpi)
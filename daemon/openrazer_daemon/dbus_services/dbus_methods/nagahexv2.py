@@ -68,8 +68,7 @@ def set_logo_none(self):
 
     driver_path = self.get_driver_path('logo_matrix_effect_none')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.logo', 'setLogoOn')
@@ -87,8 +86,7 @@ def set_logo_on(self):
 
     driver_path = self.get_driver_path('logo_matrix_effect_on')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.logo', 'setLogoReactive', in_sig='yyyy')
@@ -125,8 +123,7 @@ def set_logo_reactive(self, red, green, blue, speed):
 
     payload = bytes([speed, red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.logo', 'setLogoBreathMono')
@@ -144,8 +141,7 @@ def set_logo_breath_mono(self):
 
     driver_path = self.get_driver_path('logo_matrix_effect_breath')
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(b'1')
+    self.write_driver_file(driver_path, b'1')
 
 
 @endpoint('razer.device.lighting.logo', 'setLogoBreathRandom')
@@ -165,8 +161,7 @@ def set_logo_breath_random(self):
 
     payload = b'1'
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.logo', 'setLogoBreathSingle', in_sig='yyy')
@@ -196,8 +191,7 @@ def set_logo_breath_single(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.logo', 'setLogoBreathDual', in_sig='yyyyyy')
@@ -236,8 +230,7 @@ def set_logo_breath_dual(self, red1, green1, blue1, red2, green2, blue2):
 
     payload = bytes([red1, green1, blue1, red2, green2, blue2])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.logo', 'setLogoBlinking', in_sig='yyy')
@@ -334,8 +327,7 @@ def set_scroll_none(self):
 
     driver_path = self.get_driver_path('scroll_matrix_effect_none')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.scroll', 'setScrollOn')
@@ -352,8 +344,7 @@ def set_scroll_on(self):
 
     driver_path = self.get_driver_path('scroll_matrix_effect_on')
 
-    with open(driver_path, 'w') as driver_file:
-        driver_file.write('1')
+    self.write_driver_file(driver_path, '1')
 
 
 @endpoint('razer.device.lighting.scroll', 'setScrollReactive', in_sig='yyyy')
@@ -390,8 +381,7 @@ def set_scroll_reactive(self, red, green, blue, speed):
 
     payload = bytes([speed, red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.scroll', 'setScrollBreathMono')
@@ -409,8 +399,7 @@ def set_scroll_breath_mono(self):
 
     driver_path = self.get_driver_path('scroll_matrix_effect_breath')
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(b'1')
+    self.write_driver_file(driver_path, b'1')
 
 
 @endpoint('razer.device.lighting.scroll', 'setScrollBreathRandom')
@@ -430,8 +419,7 @@ def set_scroll_breath_random(self):
 
     payload = b'1'
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.scroll', 'setScrollBreathSingle', in_sig='yyy')
@@ -461,8 +449,7 @@ def set_scroll_breath_single(self, red, green, blue):
 
     payload = bytes([red, green, blue])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.scroll', 'setScrollBreathDual', in_sig='yyyyyy')
@@ -501,8 +488,7 @@ def set_scroll_breath_dual(self, red1, green1, blue1, red2, green2, blue2):
 
     payload = bytes([red1, green1, blue1, red2, green2, blue2])
 
-    with open(driver_path, 'wb') as driver_file:
-        driver_file.write(payload)
+    self.write_driver_file(driver_path, payload)
 
 
 @endpoint('razer.device.lighting.scroll', 'setScrollBlinking', in_sig='yyy')
@@ -7,9 +7,12 @@ Service Object for DBus
 # Disable some pylint stuff
 # pylint: disable=no-member
 
+import inspect
 import types
+import _dbus_bindings
 import dbus
 import dbus.service
+from gi.repository import GLib
 
 
 def copy_func(function_reference, name=None):
@@ -31,6 +34,50 @@ def copy_func(function_reference, name=None):
         return types.FunctionType(function_reference.__code__, function_reference.__globals__, name or function_reference.func_name, function_reference.__defaults__, function_reference.__closure__)
 
 
+def make_worker_method(function, name, out_signature):
+    """
+    Wrap a method so D-Bus calls to it run on the object's I/O worker
+
+    dbus-python passes the reply and error callbacks as keyword arguments and
+    finds the method's arguments through its signature, so the wrapper gets
+    the signature of the wrapped function plus the callbacks. Calls from
+    inside the daemon don't pass callbacks and run straight away.
+
+    :param function: Function taking self as first argument
+    :type function: func
+
+    :param name: Name of function
+    :type name: str
+
+    :param out_signature: DBus function signature
+    :type out_signature: str
+
+    :return: Wrapped function
+    :rtype: func
+    """
+    returns_value = len(tuple(dbus.Signature(out_signature or ''))) > 0
+
+    def worker_method(self, *args, reply_handler=None, error_handler=None):
+        if reply_handler is None:
+            return function(self, *args)
+
+        def reply(result):
+            GLib.idle_add(reply_handler, *((result,) if returns_value else ()))
+
+        def error(err):
+            GLib.idle_add(error_handler, err)
+
+        self.io_worker.submit(function, (self,) + args, reply, error)
+
+    parameters = list(inspect.signature(function).parameters.values())
+    parameters.append(inspect.Parameter('reply_handler', inspect.Parameter.POSITIONAL_OR_KEYWORD, default=None))
+    parameters.append(inspect.Parameter('error_handler', inspect.Parameter.POSITIONAL_OR_KEYWORD, default=None))
+    worker_method.__signature__ = inspect.Signature(parameters)
+    worker_method.__name__ = name
+
+    return worker_method
+
+
 class DBusService(dbus.service.Object):
     """
     DBus Service object
@@ -39,6 +86,9 @@ class DBusService(dbus.service.Object):
     """
     BUS_NAME = 'org.razer'
 
+    # Interfaces part of the introspection XML by class key
+    _introspect_cache = {}
+
     def __init__(self, object_path):
         """
         Init the object
@@ -56,7 +106,53 @@ class DBusService(dbus.service.Object):
 
         self.add_to_connection(bus, object_path)
 
-    def add_dbus_method(self, interface_name, function_name, function, in_signature=None, out_signature=None, byte_arrays=False):
+    def _get_class_key(self):
+        """
+        Get the key of the object's class in the DBus class table
+
+        :return: Class key
+        :rtype: str
+        """
+        return self.__class__.__module__ + '.' + self.__class__.__name__
+
+    @dbus.service.method(dbus.INTROSPECTABLE_IFACE, in_signature='', out_signature='s', path_keyword='object_path', connection_keyword='connection')
+    def Introspect(self, object_path, connection):
+        """
+        Introspect the object
+
+        Same output as dbus-python, but the interfaces part is built once per
+        class and reused until methods are added or removed.
+        """
+        class_key = self._get_class_key()
+
+        interfaces_xml = self._introspect_cache.get(class_key)
+        if interfaces_xml is None:
+            interfaces_xml = ''
+            for name, funcs in self._dbus_class_table[class_key].items():
+                interfaces_xml += '  <interface name="%s">\n' % name
+
+                for func in funcs.values():
+                    if getattr(func, '_dbus_is_method', False):
+                        interfaces_xml += self.__class__._reflect_on_method(func)
+                    elif getattr(func, '_dbus_is_signal', False):
+                        interfaces_xml += self.__class__._reflect_on_signal(func)
+
+                interfaces_xml += '  </interface>\n'
+
+            self._introspect_cache[class_key] = interfaces_xml
+
+        reflection_data = _dbus_bindings.DBUS_INTROSPECT_1_0_XML_DOCTYPE_DECL_NODE
+        reflection_data += '<node name="%s">\n' % object_path
+        reflection_data += interfaces_xml
+
+        for name in connection.list_exported_child_objects(object_path):
+            reflection_data += '  <node name="%s"/>\n' % name
+
+        reflection_data += '</node>\n'
+
+        return reflection_data
+
+    def add_dbus_method(self, interface_name, function_name, function, in_signature=None, out_signature=None, byte_arrays=False, use_worker=False, async_reply=False):
         """
         Add method to DBus Object
 
@@ -77,16 +173,38 @@ class DBusService(dbus.service.Object):
 
         :param byte_arrays: Is byte array
         :type byte_arrays: bool
+
+        :param use_worker: Run calls on self.io_worker instead of the main loop
+        :type use_worker: bool
+
+        :param async_reply: Function takes reply_handler and error_handler and replies through them
+        :type async_reply: bool
         """
 
         # Get class key for use in the DBus introspection table
-        class_key = [key for key in self._dbus_class_table.keys() if key.endswith(self.__class__.__name__)][0]
+        class_key = self._get_class_key()
+
+        # Methods live on the class, so devices of the same class only need them added once
+        source_code = function.code if hasattr(function, 'code') else function.__code__
+        method_source = (source_code, in_signature, out_signature, byte_arrays, use_worker, async_reply)
+        registered = self._dbus_class_table[class_key].get(interface_name, {}).get(function_name)
+        if registered is not None and getattr(registered, '_method_source', None) == method_source:
+            return
 
         # Create a copy of the function so that if its used multiple times it won't affect other instances if the names changed
         function_deepcopy = copy_func(function, function_name)
-        func = dbus.service.method(interface_name, in_signature=in_signature, out_signature=out_signature, byte_arrays=byte_arrays)(function_deepcopy)
+        if use_worker or async_reply:
+            if use_worker:
+                function_deepcopy = make_worker_method(function_deepcopy, function_name, out_signature)
+            func = dbus.service.method(interface_name, in_signature=in_signature, out_signature=out_signature, byte_arrays=byte_arrays,
+                                       async_callbacks=('reply_handler', 'error_handler'))(function_deepcopy)
+        else:
+            func = dbus.service.method(interface_name, in_signature=in_signature, out_signature=out_signature, byte_arrays=byte_arrays)(function_deepcopy)
+
+        func._method_source = method_source
 
         # Add method to DBus tables
+        self._introspect_cache.pop(class_key, None)
         try:
             self._dbus_class_table[class_key][interface_name][function_name] = func
         except KeyError:
@@ -95,6 +213,17 @@ class DBusService(dbus.service.Object):
         # Add method to class as DBus expects it to be there.
         setattr(self.__class__, function_name, func)
 
+    def get_dbus_methods(self):
+        """
+        Get the methods added to the DBus Object
+
+        :return: Dict of interface name: list of method names
+        :rtype: dict
+        """
+        class_key = self._get_class_key()
+
+        return {interface_name: sorted(methods.keys()) for interface_name, methods in self._dbus_class_table[class_key].items()}
+
     def del_dbus_method(self, interface_name, function_name):
         """
         Remove method from DBus Object
@@ -107,10 +236,11 @@ class DBusService(dbus.service.Object):
         """
 
         # Get class key for use in the DBus introspection table
-        class_key = [key for key in self._dbus_class_table.keys() if key.endswith(self.__class__.__name__)][0]
+        class_key = self._get_class_key()
 
         # Remove method from DBus tables
         # Remove method from class
+        self._introspect_cache.pop(class_key, None)
         try:
             del self._dbus_class_table[class_key][interface_name][function_name]
             delattr(DBusService, function_name)
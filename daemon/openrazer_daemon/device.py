@@ -3,6 +3,7 @@
 """
 Class to hold a device and collections of them
 """
+from openrazer_daemon.misc import effect_sync
 
 
 class Device(object):
@@ -89,6 +90,9 @@ class DeviceCollection(object):
         self._id_map = {}
         self._serial_map = {}
 
+        # Make synced devices switch effects at the same moment
+        self.sync_barrier = False
+
     def add(self, device_id, device_serial, device_dbus):
         """
         Add device to collection
@@ -243,6 +247,7 @@ class DeviceCollection(object):
         :param msg: Messgae
         :type msg: tuple
         """
-        for child in self._id_map.values():
-            if child is not active_child:
-                child.notify_child(msg)
+        with effect_sync.fan_out(barrier=self.sync_barrier):
+            for child in self._id_map.values():
+                if child is not active_child:
+                    child.notify_child(msg)
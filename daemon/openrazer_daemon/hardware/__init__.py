@@ -4,6 +4,7 @@
 Hardware collection
 """
 import os
+import re
 from openrazer_daemon.hardware.device_base import RazerDevice
 
 # Hack to get a list of hardware modules to import
@@ -12,6 +13,9 @@ HARDWARE_MODULES = ['openrazer_daemon.hardware.' + os.path.splitext(hw_file)[0]
 # List of classes to exclude from the class finding
 EXCLUDED_CLASSES = ('RazerDevice', 'RazerDeviceBrightnessSuspend')
 
+# HID device ID like 0003:1532:0203.0004, bus:VID:PID.instance
+DEVICE_ID_REGEX = re.compile(r'^[0-9A-F]{4}:([0-9A-F]{4}):([0-9A-F]{4})\.[0-9A-F]{4}$')
+
 
 def get_device_classes():
     """
@@ -32,3 +36,45 @@ def get_device_classes():
             classes.append(class_instance)
 
     return sorted(classes, key=lambda cls: cls.__name__)
+
+
+def get_device_class_map(device_classes):
+    """
+    Index hardware classes by USB ID
+
+    :param device_classes: List of RazerDevice subclasses
+    :type device_classes: list of callable
+
+    :return: Dict of (USB_VID, USB_PID): class
+    :rtype: dict
+    """
+    return {(cls.USB_VID, cls.USB_PID): cls for cls in device_classes if cls.USB_VID is not None}
+
+
+def find_device_class(class_map, device_id, dev_path):
+    """
+    Find the hardware class of a device
+
+    Only the class with the device's VID and PID gets to match against it.
+
+    :param class_map: Dict from get_device_class_map
+    :type class_map: dict
+
+    :param device_id: Device ID like 0000:0000:0000.0000
+    :type device_id: str
+
+    :param dev_path: Device path. Normally '/sys/bus/hid/devices/0000:0000:0000.0000'
+    :type dev_path: str
+
+    :return: RazerDevice subclass or None
+    :rtype: callable or None
+    """
+    match = DEVICE_ID_REGEX.match(device_id)
+    if match is None:
+        return None
+
+    device_class = class_map.get((int(match.group(1), 16), int(match.group(2), 16)))
+    if device_class is not None and device_class.match(device_id, dev_path):
+        return device_class
+
+    return None
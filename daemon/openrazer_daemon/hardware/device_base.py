@@ -6,17 +6,25 @@ Hardware base class
 import configparser
 import re
 import os
-import types
 import inspect
 import logging
 import time
 import json
 import random
+import threading
+import dbus
+import dbus.service
+from gi.repository import GLib
 
 from openrazer_daemon.dbus_services.service import DBusService
 import openrazer_daemon.dbus_services.dbus_methods
 from openrazer_daemon.misc import effect_sync
 from openrazer_daemon.misc.battery_notifier import BatteryManager as _BatteryManager
+from openrazer_daemon.misc.fake_latency import FakeLatency
+from openrazer_daemon.misc.framebuffer import FramebufferStore
+from openrazer_daemon.misc.io_worker import DeviceIOWorker
+from openrazer_daemon.misc.startup_trace import TRACE
+from openrazer_daemon.misc.state_cache import DeviceStateCache
 
 
 # pylint: disable=too-many-instance-attributes
@@ -54,6 +62,20 @@ class RazerDevice(DBusService):
 
         # Serial cache
         self._serial = None
+        # See get_descriptor
+        self._descriptor = None
+
+        # Driver file paths and open file descriptors, see write_driver_file
+        self._driver_paths = {}
+        self._driver_fds = {}
+        self._driver_fds_lock = threading.Lock()
+
+        # D-Bus calls that talk to the driver run here, see add_dbus_method
+        self.io_worker = DeviceIOWorker(device_number)
+        self.io_worker.start()
+
+        # Getter results, see stateChanged
+        self.state_cache = DeviceStateCache(self._state_changed)
 
         # Local storage key name
         self.storage_name = "UnknownDevice"
@@ -73,6 +95,8 @@ class RazerDevice(DBusService):
         self._parent = None
         self._device_path = device_path
         self._device_number = device_number
+        # USB timings emulated for the fake driver
+        self._fake_latency = FakeLatency.load(device_path) if testing else None
         self.serial = self.get_serial()
 
         if self.USB_PID == 0x0f07:
@@ -119,6 +143,12 @@ class RazerDevice(DBusService):
         self.methods_internal = ['get_firmware', 'get_matrix_dims', 'has_matrix', 'get_device_name']
         self.methods_internal.extend(additional_methods)
 
+        # Framebuffers for custom frames, one per client by ID
+        rows, cols = self.MATRIX_DIMS or (0, 0)
+        self._framebuffers = FramebufferStore(rows * (3 + cols * 3))
+        if 'set_key_row' in self.METHODS and self.MATRIX_DIMS:
+            self.methods_internal.extend(['get_framebuffer', 'commit_framebuffer'])
+
         # Find event files in /dev/input/by-id/ by matching against regex
         self.event_files = []
 
@@ -148,6 +178,7 @@ class RazerDevice(DBusService):
             ('razer.device.misc', 'setDeviceMode', self.set_device_mode, 'yy', None),
             ('razer.device.misc', 'resumeDevice', self.resume_device, None, None),
             ('razer.device.misc', 'getVidPid', self.get_vid_pid, None, 'ai'),
+            ('razer.device.misc', 'getDescriptor', self.get_descriptor, None, 'a{sv}'),
             ('razer.device.misc', 'getDriverVersion', openrazer_daemon.dbus_services.dbus_methods.version, None, 's'),
             ('razer.device.misc', 'hasDedicatedMacroKeys', self.dedicated_macro_keys, None, 'b'),
             # Deprecated API, but kept for backwards compatibility
@@ -223,29 +254,33 @@ class RazerDevice(DBusService):
             }
         }
 
-        for m in methods:
-            self.logger.debug("Adding {}.{} method to DBus".format(m[0], m[1]))
-            self.add_dbus_method(m[0], m[1], m[2], in_signature=m[3], out_signature=m[4])
+        # Methods above that talk to the driver, the rest only use the daemon's state
+        driver_methods = ('suspendDevice', 'getDeviceMode', 'setDeviceMode', 'resumeDevice', 'restoreLastEffect', 'getDescriptor')
 
-        # this check is separate from the rest because backlight effects don't have prefixes in their names
-        if 'set_static_effect' in self.METHODS or 'bw_set_static' in self.METHODS:
-            self.zone["backlight"]["present"] = True
-            for m in effect_methods["backlight_chroma"]:
+        with TRACE.phase('device DBus registration'):
+            for m in methods:
                 self.logger.debug("Adding {}.{} method to DBus".format(m[0], m[1]))
-                self.add_dbus_method(m[0], m[1], m[2], in_signature=m[3], out_signature=m[4])
+                self.add_dbus_method(m[0], m[1], m[2], in_signature=m[3], out_signature=m[4], use_worker=m[1] in driver_methods)
 
-        for i in self.ZONES:
-            if 'set_' + i + '_static_classic' in self.METHODS \
-                    or 'set_' + i + '_static' in self.METHODS \
-                    or 'set_' + i + '_active' in self.METHODS \
-                    or 'set_' + i + '_on' in self.METHODS:
-                self.zone[i]["present"] = True
-                for m in effect_methods[i]:
+            # this check is separate from the rest because backlight effects don't have prefixes in their names
+            if 'set_static_effect' in self.METHODS or 'bw_set_static' in self.METHODS:
+                self.zone["backlight"]["present"] = True
+                for m in effect_methods["backlight_chroma"]:
                     self.logger.debug("Adding {}.{} method to DBus".format(m[0], m[1]))
                     self.add_dbus_method(m[0], m[1], m[2], in_signature=m[3], out_signature=m[4])
 
-        # Load additional DBus methods
-        self.load_methods()
+            for i in self.ZONES:
+                if 'set_' + i + '_static_classic' in self.METHODS \
+                        or 'set_' + i + '_static' in self.METHODS \
+                        or 'set_' + i + '_active' in self.METHODS \
+                        or 'set_' + i + '_on' in self.METHODS:
+                    self.zone[i]["present"] = True
+                    for m in effect_methods[i]:
+                        self.logger.debug("Adding {}.{} method to DBus".format(m[0], m[1]))
+                        self.add_dbus_method(m[0], m[1], m[2], in_signature=m[3], out_signature=m[4])
+
+            # Load additional DBus methods
+            self.load_methods()
 
         # load last DPI/poll rate state
         if self.persistence.has_section(self.storage_name):
@@ -320,17 +355,22 @@ class RazerDevice(DBusService):
         if 'get_battery' in self.METHODS:
             self._init_battery_manager()
 
-        self.restore_dpi_poll_rate()
-        self.restore_brightness()
-
-        if self.config.getboolean('Startup', "restore_persistence") is True:
-            self.restore_effect()
+        with TRACE.phase('device restore'):
+            self.restore_dpi_poll_rate()
+            self.restore_brightness()
 
-            # Some devices need setting a second time after encountering Razer Synapse on Windows
-            if self.config.getboolean('Startup', "persistence_dual_boot_quirk") is True:
-                self.logger.debug("Restoring effect persistence again (dual boot quirk)")
+            if self.config.getboolean('Startup', "restore_persistence") is True:
                 self.restore_effect()
 
+                # Some devices need setting a second time after encountering Razer Synapse on Windows
+                if self.config.getboolean('Startup', "persistence_dual_boot_quirk") is True:
+                    self.logger.debug("Restoring effect persistence again (dual boot quirk)")
+                    self.restore_effect()
+
+        # Read the descriptor's driver values now so getDeviceDescriptors finds it ready
+        self.io_worker.submit(self.get_descriptor, (), lambda _: None,
+                              lambda err: self.logger.warning("Failed to build the device descriptor: %s", err))
+
     def send_effect_event(self, effect_name, *args):
         """
         Send effect event
@@ -346,6 +386,26 @@ class RazerDevice(DBusService):
 
         self.notify_observers(tuple(payload))
 
+    @dbus.service.signal('razer.device.misc', signature='sa{sv}')
+    def stateChanged(self, interface, changed):  # pylint: disable=invalid-name
+        """
+        Emitted when a value returned by a getter changed
+
+        :param interface: Interface of the getters
+        :type interface: str
+
+        :param changed: Dict of getter name: new value
+        :type changed: dict
+        """
+        self.logger.debug("Emitted state changed signal for %s", ', '.join(changed))
+
+    def _state_changed(self, interface, name, value):
+        """
+        Called by the state cache, can be on the I/O worker so the signal is
+        sent from the main loop
+        """
+        GLib.idle_add(self.stateChanged, interface, {name: value})
+
     def dedicated_macro_keys(self):
         """
         Returns if the device has dedicated macro keys
@@ -516,7 +576,7 @@ class RazerDevice(DBusService):
             return
         self.logger.debug("Set persistence (%s, %s, %s)", zone, key, value)
 
-        self.persistence.status["changed"] = True
+        self.persistence.status.mark_changed(self.storage_name)
 
         if zone:
             self.zone[zone][key] = value
@@ -945,7 +1005,126 @@ class RazerDevice(DBusService):
         :return: Full path to driver
         :rtype: str
         """
-        return os.path.join(self._device_path, driver_filename)
+        driver_path = self._driver_paths.get(driver_filename)
+
+        if driver_path is None:
+            driver_path = os.path.join(self._device_path, driver_filename)
+            self._driver_paths[driver_filename] = driver_path
+
+        return driver_path
+
+    def _get_driver_fd(self, driver_path, flags):
+        """
+        Get the file descriptor of a driver file, opening it on first use
+
+        :param driver_path: Path from get_driver_path
+        :type driver_path: str
+
+        :param flags: os.O_RDONLY or os.O_WRONLY, some driver files are write only
+        :type flags: int
+
+        :return: File descriptor
+        :rtype: int
+        """
+        with self._driver_fds_lock:
+            fd = self._driver_fds.get((driver_path, flags))
+
+            if fd is None:
+                fd = os.open(driver_path, flags | os.O_CLOEXEC)
+                self._driver_fds[(driver_path, flags)] = fd
+
+        return fd
+
+    def _drop_driver_fd(self, driver_path, flags):
+        """
+        Close a cached file descriptor, e.g. after an error
+        """
+        with self._driver_fds_lock:
+            fd = self._driver_fds.pop((driver_path, flags), None)
+
+        if fd is not None:
+            os.close(fd)
+
+    def close_driver_files(self):
+        """
+        Close all cached driver file descriptors
+        """
+        with self._driver_fds_lock:
+            fds = list(self._driver_fds.values())
+            self._driver_fds.clear()
+
+        for fd in fds:
+            os.close(fd)
+
+    def write_driver_file(self, driver_path, payload):
+        """
+        Write to a driver file
+
+        The file is opened once and every write goes to offset 0 of the same
+        descriptor, which is a full store for sysfs attributes.
+
+        :param driver_path: Path from get_driver_path
+        :type driver_path: str
+
+        :param payload: Payload, strings are encoded as UTF-8
+        :type payload: bytes or str
+        """
+        if isinstance(payload, str):
+            payload = payload.encode('utf-8')
+
+        fd = self._get_driver_fd(driver_path, os.O_WRONLY)
+
+        if self._fake_latency is not None:
+            self._fake_latency.before_write(os.path.basename(driver_path), payload)
+
+        try:
+            os.pwrite(fd, payload, 0)
+
+            if self._testing:
+                # The fake driver uses regular files, drop what's left of a longer previous write
+                os.ftruncate(fd, len(payload))
+        except OSError:
+            self._drop_driver_fd(driver_path, os.O_WRONLY)
+            raise
+
+    def read_driver_file(self, driver_path, binary=False):
+        """
+        Read a driver file
+
+        Reading from offset 0 of the cached descriptor makes sysfs produce the
+        attribute again.
+
+        :param driver_path: Path from get_driver_path
+        :type driver_path: str
+
+        :param binary: Return bytes instead of a string
+        :type binary: bool
+
+        :return: File contents
+        :rtype: str or bytes
+        """
+        fd = self._get_driver_fd(driver_path, os.O_RDONLY)
+
+        if self._fake_latency is not None:
+            self._fake_latency.before_read(os.path.basename(driver_path))
+
+        try:
+            result = b''
+            while True:
+                data = os.pread(fd, 4096, len(result))
+                result += data
+                if len(data) < 4096:
+                    break
+        except OSError:
+            self._drop_driver_fd(driver_path, os.O_RDONLY)
+            raise
+
+        if self._fake_latency is not None:
+            result = self._fake_latency.after_read(os.path.basename(driver_path), result)
+
+        if binary:
+            return result
+        return result.decode('utf-8')
 
     def get_serial(self):
         """
@@ -1038,8 +1217,7 @@ class RazerDevice(DBusService):
 
         payload = b'1'
 
-        with open(driver_path, 'wb') as driver_file:
-            driver_file.write(payload)
+        self.write_driver_file(driver_path, payload)
 
     def _set_key_row(self, payload):
         """
@@ -1058,8 +1236,47 @@ class RazerDevice(DBusService):
 
         driver_path = self.get_driver_path('matrix_custom_frame')
 
-        with open(driver_path, 'wb') as driver_file:
-            driver_file.write(payload)
+        self.write_driver_file(driver_path, payload)
+
+    def create_framebuffer(self):
+        """
+        Create a framebuffer for one client
+
+        The framebuffer is big enough for a full frame in the
+        matrix_custom_frame format, which the client maps and draws into.
+
+        :return: File descriptor and ID of the framebuffer
+        :rtype: tuple
+        """
+        fd, framebuffer_id = self._framebuffers.create()
+        try:
+            # Duplicates the descriptor for the reply
+            unix_fd = dbus.types.UnixFd(fd)
+        finally:
+            os.close(fd)
+
+        return unix_fd, framebuffer_id
+
+    def read_framebuffer(self, framebuffer_id, length):
+        """
+        Get a frame from a client's framebuffer
+
+        :param framebuffer_id: Framebuffer ID from create_framebuffer
+        :type framebuffer_id: int
+
+        :param length: Length of the frame
+        :type length: int
+
+        :return: Binary payload
+        :rtype: bytes
+        """
+        return self._framebuffers.read(framebuffer_id, length)
+
+    def close_framebuffer(self):
+        """
+        Release all framebuffers, clients keep their mappings
+        """
+        self._framebuffers.close()
 
     def _init_battery_manager(self):
         """
@@ -1080,6 +1297,43 @@ class RazerDevice(DBusService):
         result = [self.USB_VID, self.USB_PID]
         return result
 
+    def get_descriptor(self):
+        """
+        Get the static properties and DBus methods of the device
+
+        Lets clients set up a device with one call instead of introspecting it
+        and asking for each property. The values don't change while the device
+        is connected, so they're only read from the driver once. Only call
+        it on the I/O worker, it's built there when the device is added.
+
+        :return: Dict of property name: value
+        :rtype: dbus.Dictionary
+        """
+        if self._descriptor is None:
+            methods = self.get_dbus_methods()
+            misc_methods = methods.get('razer.device.misc', [])
+
+            descriptor = {
+                'serial': self.get_serial(),
+                'name': self.getDeviceName(),  # pylint: disable=no-member
+                'type': self.getDeviceType() if 'getDeviceType' in misc_methods else 'unknown',  # pylint: disable=no-member
+                'firmware_version': self.getFirmware(),  # pylint: disable=no-member
+                'driver_version': self.getDriverVersion(),  # pylint: disable=no-member
+                'vid_pid': dbus.Array(self.get_vid_pid(), signature='i'),
+                'has_matrix': dbus.Boolean(self.HAS_MATRIX),
+                'matrix_dims': dbus.Array(self.MATRIX_DIMS if self.HAS_MATRIX and self.MATRIX_DIMS else [], signature='i'),
+                'dedicated_macro_keys': dbus.Boolean(self.DEDICATED_MACRO_KEYS),
+                'device_image': self.DEVICE_IMAGE or '',
+                'methods': dbus.Dictionary({interface: dbus.Array(names, signature='s') for interface, names in methods.items()}, signature='sas'),
+            }
+
+            if 'getKeyboardLayout' in misc_methods:
+                descriptor['keyboard_layout'] = self.getKeyboardLayout()  # pylint: disable=no-member
+
+            self._descriptor = dbus.Dictionary(descriptor, signature='sv')
+
+        return self._descriptor
+
     def get_image_json(self):
         # Deprecated API, but kept for backwards compatibility
         return json.dumps({
@@ -1097,19 +1351,15 @@ class RazerDevice(DBusService):
 
         Goes through the list in self.methods_internal and self.METHODS and loads each effect and adds it to DBus
         """
-        available_functions = {}
-        methods = dir(openrazer_daemon.dbus_services.dbus_methods)
-        for method in methods:
-            potential_function = getattr(openrazer_daemon.dbus_services.dbus_methods, method)
-            if isinstance(potential_function, types.FunctionType) and hasattr(potential_function, 'endpoint') and potential_function.endpoint:
-                available_functions[potential_function.__name__] = potential_function
+        available_functions = openrazer_daemon.dbus_services.dbus_methods.get_endpoints()
 
         self.methods_internal.extend(self.METHODS)
         for method_name in self.methods_internal:
             try:
                 new_function = available_functions[method_name]
                 self.logger.debug("Adding %s.%s method to DBus", new_function.interface, new_function.name)
-                self.add_dbus_method(new_function.interface, new_function.name, new_function, new_function.in_sig, new_function.out_sig, new_function.byte_arrays)
+                self.add_dbus_method(new_function.interface, new_function.name, new_function, new_function.in_sig, new_function.out_sig, new_function.byte_arrays,
+                                     use_worker=not new_function.state_only)
             except KeyError as e:
                 raise RuntimeError("Couldn't add method to DBus: " + str(e)) from None
 
@@ -1135,6 +1385,9 @@ class RazerDevice(DBusService):
         self.disable_notify = True
         self.disable_persistence = True
 
+        # The device might have lost its settings while suspended
+        self.state_cache.invalidate()
+
         self.restore_brightness()
         self._resume_device()
 
@@ -1166,15 +1419,21 @@ class RazerDevice(DBusService):
         Close any resources opened by subclasses
         """
         if not self._is_closed:
+            # Let calls still queued for the device finish
+            self.io_worker.stop()
+
             # If this is a mouse, retrieve current DPI for local storage
             # in case the user has changed the DPI on-the-fly
             # (e.g. the DPI buttons)
             if 'get_dpi_xy' in self.METHODS:
                 dpi_func = getattr(self, "getDPI", None)
                 if dpi_func is not None:
+                    self.state_cache.invalidate('razer.device.dpi', 'getDPI')
                     self.dpi = dpi_func()
 
             self._close()
+            self.close_driver_files()
+            self.close_framebuffer()
 
             self._is_closed = True
 
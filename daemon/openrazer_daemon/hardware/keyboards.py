@@ -86,9 +86,9 @@ class _RippleKeyboard(_MacroKeyboard):
 
             if effect_func is not None:
                 if effect_func_name == 'setRipple':
-                    effect_func(self.zone["backlight"]["colors"][0], self.zone["backlight"]["colors"][1], self.zone["backlight"]["colors"][2], self.ripple_manager._ripple_thread._refresh_rate)
+                    effect_func(self.zone["backlight"]["colors"][0], self.zone["backlight"]["colors"][1], self.zone["backlight"]["colors"][2], self.ripple_manager._ripple_effect._refresh_rate)
                 elif effect_func_name == 'setRippleRandomColour':
-                    effect_func(self.ripple_manager._ripple_thread._refresh_rate)
+                    effect_func(self.ripple_manager._ripple_effect._refresh_rate)
 
     def _close(self):
         super()._close()
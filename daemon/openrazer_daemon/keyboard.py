@@ -4,7 +4,6 @@
 Module to handle custom colours
 """
 
-import struct
 import subprocess
 
 
@@ -404,21 +403,28 @@ class RGB(object):
 class KeyboardColour(object):
     """
     Keyboard class which represents the colour state of the keyboard.
+
+    The colours live in one buffer laid out like a matrix_custom_frame
+    payload, a (row id, start column, stop column) header followed by the RGB
+    bytes of every column for each row, so the payload never has to be built.
     """
 
     def __init__(self, rows, columns):
         self.rows = rows
         self.columns = columns
+        self.row_length = 3 + columns * 3
+
+        # Row headers with all keys off, copied over the buffer to reset it
+        self._blank = bytearray(rows * self.row_length)
+        for row_id in range(0, rows):
+            self._blank[row_id * self.row_length:row_id * self.row_length + 3] = bytes((row_id, 0x00, columns - 1))
 
-        # Two-dimensional array to hold color data
-        self.colors = []
+        self.buffer = bytearray(self._blank)
+        self._view = memoryview(self.buffer)
 
         # Backup object (currently not used)
         self.backup = None
 
-        # Initialize array with empty values
-        self.reset_rows()
-
     def backup_configuration(self):
         """
         Backs up the current configuration
@@ -433,27 +439,38 @@ class KeyboardColour(object):
         if self.backup is None:
             raise NoBackupError()
 
-        self.colors = self.backup.colors
+        self.buffer[:] = self.backup.buffer
         self.backup = None
 
+    def key_offset(self, row, col):
+        """
+        Get the offset of a key's RGB bytes in the buffer
+
+        :param row: Row ID
+        :type row: int
+
+        :param col: Column ID
+        :type col: int
+
+        :return: Offset
+        :rtype: int
+        """
+        return row * self.row_length + 3 + col * 3
+
     def get_rows_raw(self):
         """
         Gets the raw representation of the rows
 
-        :return: Rows
-        :rtype: list
+        :return: RGB bytes of each row, views into the buffer
+        :rtype: list of memoryview
         """
-        return self.colors
+        return [self._view[self.key_offset(row_id, 0):(row_id + 1) * self.row_length] for row_id in range(0, self.rows)]
 
     def reset_rows(self):
         """
         Reset the rows of the keyboard
         """
-        self.colors.clear()
-
-        for row in range(0, self.rows):
-            # Create 22 rgb values
-            self.colors.append([RGB() for _ in range(0, self.columns)])
+        self.buffer[:] = self._blank
 
     def set_key_colour(self, row, col, colour):
         """
@@ -470,7 +487,11 @@ class KeyboardColour(object):
 
         :raises KeyDoesNotExistError: If given key does not exist
         """
-        self.colors[row][col].set(colour)
+        if not (0 <= row < self.rows and 0 <= col < self.columns):
+            raise KeyDoesNotExistError("The key ({0}, {1}) does not exist".format(row, col))
+
+        offset = self.key_offset(row, col)
+        self.buffer[offset:offset + 3] = bytes((RGB.clamp(colour[0]), RGB.clamp(colour[1]), RGB.clamp(colour[2])))
 
     def get_key_colour(self, key):
         """
@@ -485,7 +506,8 @@ class KeyboardColour(object):
             raise KeyDoesNotExistError("The key \"{0}\" does not exist".format(key))
 
         row_id, col_id = KEY_MAPPING[key]
-        return self.colors[row_id][col_id].get()
+        offset = self.key_offset(row_id, col_id)
+        return tuple(self.buffer[offset:offset + 3])
 
     def reset_key(self, row, col):
         """
@@ -499,40 +521,34 @@ class KeyboardColour(object):
 
         :raises KeyDoesNotExistError: If given key does not exist
         """
-        self.colors[row][col].set((0, 0, 0))
+        self.set_key_colour(row, col, (0, 0, 0))
 
     def get_row_binary(self, row_id):
         """
         Gets the binary payload for a given row
 
+        The view follows later changes to the colours.
+
         :param row_id: Row ID
         :type row_id: int
 
-        :return: Byte string of 67 bytes, Row ID byte then 22 RGB bytes
-        :rtype: bytearray
+        :return: Row ID, start and stop column bytes then the RGB bytes
+        :rtype: memoryview
         """
         assert isinstance(row_id, int), "Row ID is not an int"
 
-        payload = bytes([row_id, 0x00, len(self.colors[row_id]) - 1])
-
-        for rgb in self.colors[row_id]:
-            payload += bytes(rgb)
-
-        return payload
+        return self._view[row_id * self.row_length:(row_id + 1) * self.row_length]
 
     def get_total_binary(self):
         """
         Gets the binary payload for the whole keyboard
 
-        :return: Byte string of 6*67 bytes, (Row ID byte then 22 RGB bytes) * 6
-        :rtype: bytearray
-        """
-        payload = b''
-
-        for row in range(0, self.rows):
-            payload += self.get_row_binary(row)
+        The view follows later changes to the colours.
 
-        return payload
+        :return: The payload of every row
+        :rtype: memoryview
+        """
+        return self._view
 
     def get_from_total_binary(self, binary_blob):
         """
@@ -543,14 +559,10 @@ class KeyboardColour(object):
         """
         self.reset_rows()
 
-        for row_id in range(0, self.rows):
-            binary_blob = binary_blob[1:]  # Skip first byte
-
-            for col_id, binary_rgb in enumerate([binary_blob[i:i + 3] for i in range(0, 66, 3)]):
-                rgb = struct.unpack('=BBB', binary_rgb)
-                self.colors[row_id][col_id].set(rgb)
-
-            binary_blob = binary_blob[66:]  # Skip the current row
+        # Rows are loaded in place, whatever the blob's row ids are
+        for row_id in range(0, min(self.rows, len(binary_blob) // self.row_length)):
+            start = self.key_offset(row_id, 0)
+            self.buffer[start:start + self.columns * 3] = binary_blob[start:start + self.columns * 3]
 
 
 def get_keyboard_layout():
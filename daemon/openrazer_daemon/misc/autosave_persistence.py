@@ -3,36 +3,138 @@
 """
 A class that writes persistence data to disk when device state is updated.
 
-Due to the architecture of the daemon, it's not as simple to know when
-something has changed, so for now, an interval will periodically check for
-changes in memory and write them to disk. This also avoids excessive
-writes when lots of variables change at once.
+Devices mark their section as changed whenever their state is updated, which
+wakes up the writer. It waits for the changes to settle, so a UI slider
+moving the brightness doesn't cause a write per step, and then only rebuilds
+the sections of the devices that changed.
 
 This is essential because many desktop environments actually kill off
 the daemon upon logout/shutdown, thereby persistence isn't retained across
-sessions.
+sessions. The file is replaced atomically so being killed mid-write can't
+leave it truncated.
 
 A known issue is that this doesn't monitor DPI changes via hardware buttons,
 so this won't be persisted until the state is updated via the API.
 """
+import os
+import tempfile
+import threading
 import time
 
 
+def write_atomic(path, write_fn):
+    """
+    Replace a file without ever leaving a partially written one behind
+
+    :param path: File path
+    :type path: str
+
+    :param write_fn: Function writing the contents to a text file object
+    :type write_fn: callable
+    """
+    directory = os.path.dirname(os.path.abspath(path))
+    fd, tmp_path = tempfile.mkstemp(prefix='.' + os.path.basename(path) + '.', dir=directory)
+
+    try:
+        with os.fdopen(fd, 'w') as tmp_file:
+            write_fn(tmp_file)
+            tmp_file.flush()
+            os.fsync(tmp_file.fileno())
+
+        if os.path.exists(path):
+            os.chmod(tmp_path, os.stat(path).st_mode & 0o7777)
+
+        os.replace(tmp_path, path)
+    except BaseException:
+        try:
+            os.unlink(tmp_path)
+        except OSError:
+            pass
+        raise
+
+    # Make the rename itself durable
+    try:
+        dir_fd = os.open(directory, os.O_RDONLY | os.O_DIRECTORY)
+    except OSError:
+        return
+    try:
+        os.fsync(dir_fd)
+    except OSError:
+        pass
+    finally:
+        os.close(dir_fd)
+
+
+class PersistenceStatus(object):
+    """
+    Tracks which devices' persistence sections have changed
+    """
+
+    def __init__(self):
+        self._lock = threading.Lock()
+        self._dirty = set()
+        self.changed = threading.Event()
+
+    def mark_changed(self, storage_name):
+        """
+        Mark a device's section as changed
+
+        :param storage_name: Persistence section of the device
+        :type storage_name: str
+        """
+        with self._lock:
+            self._dirty.add(storage_name)
+        self.changed.set()
+
+    def take(self):
+        """
+        Get and clear the changed sections
+
+        :return: Section names
+        :rtype: set
+        """
+        with self._lock:
+            dirty, self._dirty = self._dirty, set()
+            self.changed.clear()
+        return dirty
+
+
 class PersistenceAutoSave(object):
-    def __init__(self, persistence, persistence_file, persistence_status, logger, interval, persistence_save_fn):
-        self.persistence = persistence
+    """
+    Writes the changed sections shortly after the last change
+
+    Writes happen once no change came in for `delay` seconds, or `max_delay`
+    seconds after the first change if the state keeps changing.
+    """
+
+    def __init__(self, persistence_file, persistence_status, logger, delay, max_delay, persistence_save_fn):
         self.persistence_file = persistence_file
         self.persistence_status = persistence_status
         self.persistence_save_fn = persistence_save_fn
         self.logger = logger
-        self.interval = interval
+        self.delay = delay
+        self.max_delay = max_delay
+
+    def _wait_for_quiet(self):
+        """
+        Wait until changes stop coming in or max_delay has passed
+        """
+        deadline = time.monotonic() + self.max_delay
+        changed = self.persistence_status.changed
+
+        while True:
+            changed.clear()
+            timeout = min(self.delay, deadline - time.monotonic())
+            if timeout <= 0 or not changed.wait(timeout):
+                return
 
     def watch(self):
         # Run indefinitely until process is terminated
         while True:
-            time.sleep(self.interval)
+            self.persistence_status.changed.wait()
+            self._wait_for_quiet()
 
-            if self.persistence_status["changed"]:
-                self.logger.debug("State recently changed, writing to disk")
-                self.persistence_status["changed"] = False
-                self.persistence_save_fn(self.persistence_file)
+            storage_names = self.persistence_status.take()
+            if storage_names:
+                self.logger.debug("State recently changed, writing to disk: %s", ', '.join(sorted(storage_names)))
+                self.persistence_save_fn(self.persistence_file, storage_names)
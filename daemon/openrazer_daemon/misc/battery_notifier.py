@@ -3,112 +3,172 @@
 """
 This will do until I can be bothered to create indicator applet to do battery level
 """
+import collections
+import heapq
+import itertools
 import logging
 import threading
-import datetime
 import time
 import subprocess
 
+# Retry bogus or failed readings after this long, doubling up to the frequency
+BOGUS_RETRY_DELAY = 10
 
-class BatteryNotifier(threading.Thread):
-    """
-    Thread to notify about battery
+
+class BatteryScheduler(threading.Thread):
     """
+    Reads the battery level of all devices from one thread
 
-    def __init__(self, parent, device_id, device_name):
-        super().__init__()
-        self._logger = logging.getLogger('razer.device{0}.batterynotifier'.format(device_id))
+    The next due time of each device is kept in a heap and the thread sleeps
+    until the earliest one, so it only wakes up when a reading is due. The
+    readings are done on the devices' I/O workers and handed back to this
+    thread.
+    """
 
-        self.event = threading.Event()
-        self.frequency = 0
-        self.percent = 0
+    def __init__(self):
+        super().__init__(name='BatteryScheduler', daemon=True)
+        self._logger = logging.getLogger('razer.batteryscheduler')
 
+        self._condition = threading.Condition()
+        self._heap = []
+        self._counter = itertools.count()
+        self._results = collections.deque()
         self._shutdown = False
-        self._device_name = device_name
 
-        # Could save reference to parent but only need battery level function
-        self._get_battery_func = parent.getBattery
+    def schedule(self, manager, delay):
+        """
+        Schedule the next reading of a device, replacing the pending one
 
-        self._last_notify_time = datetime.datetime(1970, 1, 1)
+        :param manager: Battery manager of the device
+        :type manager: BatteryManager
 
-    @property
-    def shutdown(self):
+        :param delay: Seconds from now
+        :type delay: float
         """
-        Get the shutdown flag
+        with self._condition:
+            manager.generation += 1
+            heapq.heappush(self._heap, (time.monotonic() + delay, next(self._counter), manager.generation, manager))
+            self._condition.notify()
+
+    def cancel(self, manager):
         """
-        return self._shutdown
+        Drop the pending reading of a device
 
-    @shutdown.setter
-    def shutdown(self, value):
+        :param manager: Battery manager of the device
+        :type manager: BatteryManager
         """
-        Set the shutdown flag
+        with self._condition:
+            # Stale heap entries are skipped when they come up
+            manager.generation += 1
 
-        :param value: Shutdown
-        :type value: bool
+    def post_result(self, manager, battery_level, error):
         """
-        self._shutdown = value
+        Hand a reading back to the scheduler thread
 
-    def show_notification(self, summary: str, message: str, icon: str) -> None:
-        try:
-            subprocess.run(["notify-send", "-a", "OpenRazer", "-i", icon, "-t", "4000", summary, message],
-                           check=True, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
-        except subprocess.CalledProcessError as e:
-            self._logger.warning(f"Failed to show notification: {e.output.strip()}")
+        :param manager: Battery manager of the device
+        :type manager: BatteryManager
 
-    def notify_battery(self):
-        now = datetime.datetime.now()
+        :param battery_level: Battery level or None on error
+        :type battery_level: float or None
 
-        if (now - self._last_notify_time).seconds > self.frequency:
-            battery_level = self._get_battery_func()
-            battery_percent = round(battery_level)
+        :param error: Exception raised by the reading or None
+        :type error: Exception or None
+        """
+        with self._condition:
+            self._results.append((manager, battery_level, error))
+            self._condition.notify()
 
-            # Sometimes due to various issues we don't get the percentage correctly.
-            # Just ignore them and don't show a bogus notification.
-            # See also: https://github.com/openrazer/openrazer/issues/2122
-            if battery_level in (0.0, -1.0):
-                self._logger.debug("Got bogus battery value: {0}, ignoring.".format(battery_level))
-                # Since we don't update _last_notify_time here we're going to retry very soon again.
-                # Sleep a bit so we don't spam the device with requests.
-                time.sleep(10)
-                return
+    def _wait_for_work(self):
+        """
+        Sleep until a reading is due or a result came in
 
-            # Update the last notified time so that we alert in the configured frequency.
-            self._last_notify_time = now
+        :return: Managers due for a reading and results, or None on shutdown
+        :rtype: tuple or None
+        """
+        with self._condition:
+            while not self._shutdown:
+                now = time.monotonic()
+                due = []
+                while self._heap and self._heap[0][0] <= now:
+                    _, _, generation, manager = heapq.heappop(self._heap)
+                    if generation == manager.generation:
+                        due.append(manager)
 
-            title = self._device_name
-            message = "Battery is {0}%".format(battery_percent)
-            icon = "battery-full"
+                if due or self._results:
+                    results = list(self._results)
+                    self._results.clear()
+                    return due, results
 
-            if battery_level <= 10.0:
-                message = "Battery is low ({0}%). Please charge your device".format(battery_percent)
-                icon = "battery-empty"
+                timeout = self._heap[0][0] - now if self._heap else None
+                self._condition.wait(timeout)
 
-            elif battery_level <= 30.0:
-                icon = "battery-low"
+        return None
 
-            elif battery_level <= 70.0:
-                icon = "battery-good"
+    def run(self):
+        """
+        Scheduler loop
+        """
+        while True:
+            work = self._wait_for_work()
+            if work is None:
+                break
 
-            elif battery_level == 100.0:
-                message = "Battery is fully charged ({0}%)".format(battery_percent)
+            due, results = work
+            for manager, battery_level, error in results:
+                try:
+                    manager.handle_reading(battery_level, error)
+                except Exception:
+                    self._logger.exception("Failed to handle battery reading")
 
-            self._logger.debug("{0} Battery at {1}%".format(self._device_name, battery_percent))
+            for manager in due:
+                manager.read_battery()
 
-            if battery_level <= self.percent:
-                self.show_notification(summary=title, message=message, icon=icon)
+        self._logger.debug("Shutting down battery scheduler")
 
-    def run(self):
+    def stop(self):
         """
-        Main thread function
+        Stop the scheduler loop
         """
+        with self._condition:
+            self._shutdown = True
+            self._condition.notify()
+
+        if self.is_alive():
+            self.join(timeout=2)
+
 
-        while not self._shutdown:
-            if self.event.is_set() and self.frequency > 0:
-                self.notify_battery()
+_SCHEDULER = None
+_SCHEDULER_LOCK = threading.Lock()
 
-            time.sleep(0.1)
 
-        self._logger.debug("Shutting down battery notifier")
+def get_battery_scheduler():
+    """
+    Get the battery scheduler shared by all devices, starting it on first use
+
+    :return: Battery scheduler
+    :rtype: BatteryScheduler
+    """
+    global _SCHEDULER  # pylint: disable=global-statement
+
+    with _SCHEDULER_LOCK:
+        if _SCHEDULER is None:
+            _SCHEDULER = BatteryScheduler()
+            _SCHEDULER.start()
+
+        return _SCHEDULER
+
+
+def stop_battery_scheduler():
+    """
+    Stop the shared battery scheduler if it was started
+    """
+    global _SCHEDULER  # pylint: disable=global-statement
+
+    with _SCHEDULER_LOCK:
+        scheduler, _SCHEDULER = _SCHEDULER, None
+
+    if scheduler is not None:
+        scheduler.stop()
 
 
 class BatteryManager(object):
@@ -116,54 +176,174 @@ class BatteryManager(object):
     Class which manages the overall process of notifing battery levels
     """
 
-    def __init__(self, parent, device_number, device_name):
+    def __init__(self, parent, device_number, device_name, scheduler=None):
         self._logger = logging.getLogger('razer.device{0}.batterymanager'.format(device_number))
         self._parent = parent
+        self._device_name = device_name
+
+        # Could save reference to parent but only need battery level function
+        self._get_battery_func = parent.getBattery
+        self._io_worker = getattr(parent, 'io_worker', None)
+
+        if scheduler is None:
+            scheduler = get_battery_scheduler()
+        self._scheduler = scheduler
+
+        self._active = False
+        self._frequency = 0
+        self._percent = 0
+
+        self._last_notify_time = None
+        self._retry_delay = BOGUS_RETRY_DELAY
 
-        self._battery_thread = BatteryNotifier(parent, device_number, device_name)
-        self._battery_thread.start()
+        # Bumped by the scheduler to invalidate pending readings
+        self.generation = 0
 
         self._is_closed = False
 
     def close(self):
         """
-        Close the manager, stop ripple thread
+        Close the manager, drop pending readings
         """
         if not self._is_closed:
             self._logger.debug("Closing Battery Manager")
             self._is_closed = True
 
-            self._battery_thread.shutdown = True
-            self._battery_thread.join(timeout=2)
-            if self._battery_thread.is_alive():
-                self._logger.error("Could not stop BatteryNotify thread")
+            self._scheduler.cancel(self)
 
     def __del__(self):
         self.close()
 
+    def _enabled(self):
+        return not self._is_closed and self._active and self._frequency > 0
+
+    def _reschedule(self):
+        """
+        Schedule the next reading after the settings changed
+        """
+        if not self._enabled():
+            self._scheduler.cancel(self)
+            return
+
+        if self._last_notify_time is None:
+            delay = 0
+        else:
+            delay = max(0, self._last_notify_time + self._frequency - time.monotonic())
+
+        self._scheduler.schedule(self, delay)
+
+    def read_battery(self):
+        """
+        Read the battery level on the device's I/O worker
+        """
+        def reply(battery_level):
+            self._scheduler.post_result(self, battery_level, None)
+
+        def error(err):
+            self._scheduler.post_result(self, None, err)
+
+        if self._io_worker is None:
+            try:
+                reply(self._get_battery_func())
+            except Exception as err:  # pylint: disable=broad-except
+                error(err)
+        else:
+            self._io_worker.submit(self._get_battery_func, (), reply, error)
+
+    def _retry(self):
+        """
+        Try again later, backing off while the readings stay bad
+        """
+        self._scheduler.schedule(self, self._retry_delay)
+        self._retry_delay = min(self._retry_delay * 2, max(self._frequency, BOGUS_RETRY_DELAY))
+
+    def show_notification(self, summary: str, message: str, icon: str) -> None:
+        try:
+            subprocess.run(["notify-send", "-a", "OpenRazer", "-i", icon, "-t", "4000", summary, message],
+                           check=True, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+        except subprocess.CalledProcessError as e:
+            self._logger.warning(f"Failed to show notification: {e.output.strip()}")
+        except OSError as e:
+            self._logger.warning(f"Failed to show notification: {e}")
+
+    def handle_reading(self, battery_level, error):
+        """
+        Notify about a battery reading and schedule the next one
+
+        :param battery_level: Battery level or None on error
+        :type battery_level: float or None
+
+        :param error: Exception raised by the reading or None
+        :type error: Exception or None
+        """
+        if not self._enabled():
+            return
+
+        if error is not None:
+            self._logger.warning("Failed to read battery level: {0}".format(error))
+            self._retry()
+            return
+
+        # Sometimes due to various issues we don't get the percentage correctly.
+        # Just ignore them and don't show a bogus notification.
+        # See also: https://github.com/openrazer/openrazer/issues/2122
+        if battery_level in (0.0, -1.0):
+            self._logger.debug("Got bogus battery value: {0}, retrying in {1}s.".format(battery_level, self._retry_delay))
+            self._retry()
+            return
+
+        self._retry_delay = BOGUS_RETRY_DELAY
+
+        # Update the last notified time so that we alert in the configured frequency.
+        self._last_notify_time = time.monotonic()
+        self._scheduler.schedule(self, self._frequency)
+
+        battery_percent = round(battery_level)
+
+        title = self._device_name
+        message = "Battery is {0}%".format(battery_percent)
+        icon = "battery-full"
+
+        if battery_level <= 10.0:
+            message = "Battery is low ({0}%). Please charge your device".format(battery_percent)
+            icon = "battery-empty"
+
+        elif battery_level <= 30.0:
+            icon = "battery-low"
+
+        elif battery_level <= 70.0:
+            icon = "battery-good"
+
+        elif battery_level == 100.0:
+            message = "Battery is fully charged ({0}%)".format(battery_percent)
+
+        self._logger.debug("{0} Battery at {1}%".format(self._device_name, battery_percent))
+
+        if battery_level <= self._percent:
+            self.show_notification(summary=title, message=message, icon=icon)
+
     @property
     def active(self):
-        return self._battery_thread.event.is_set()
+        return self._active
 
     @active.setter
     def active(self, value):
-        if value:
-            self._battery_thread.event.set()
-        else:
-            self._battery_thread.event.clear()
+        self._active = bool(value)
+        self._reschedule()
 
     @property
     def frequency(self):
-        return self._battery_thread.frequency
+        return self._frequency
 
     @frequency.setter
     def frequency(self, frequency):
-        self._battery_thread.frequency = frequency
+        self._frequency = frequency
+        self._reschedule()
 
     @property
     def percent(self):
-        return self._battery_thread.percent
+        return self._percent
 
     @percent.setter
     def percent(self, percent):
-        self._battery_thread.percent = percent
+        self._percent = percent
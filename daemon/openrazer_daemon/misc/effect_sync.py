@@ -2,9 +2,77 @@
 
 """
 Class to manage syncing of effects
+
+Synced effects are run on each device's I/O worker, so they are applied to
+all devices at the same time instead of one after another.
 """
+import contextlib
 import inspect
 import logging
+import threading
+
+# How long devices wait for each other when switching effects together
+SYNC_BARRIER_TIMEOUT = 1.0
+
+_fan_out_state = threading.local()
+
+
+class EffectFanOut(object):
+    """
+    Collects the synced effects of one notification and starts them together
+    """
+
+    def __init__(self, barrier):
+        self._barrier = barrier
+        self._jobs = []
+
+    def add(self, effect_sync, effect_name, args):
+        """
+        Add an effect for a device
+
+        :param effect_sync: EffectSync of the target device
+        :type effect_sync: EffectSync
+
+        :param effect_name: Name of the effect
+        :type effect_name: str
+
+        :param args: Arguments for the specified effect
+        :type args: tuple
+        """
+        self._jobs.append((effect_sync, effect_name, args))
+
+    def dispatch(self):
+        """
+        Queue the effects on the devices' I/O workers
+
+        With a barrier the devices first wait for each other, so calls that
+        were already queued on one device don't delay only its switch.
+        """
+        barrier = None
+        if self._barrier and len(self._jobs) > 1:
+            barrier = threading.Barrier(len(self._jobs), timeout=SYNC_BARRIER_TIMEOUT)
+
+        for effect_sync, effect_name, args in self._jobs:
+            effect_sync.submit_effect(effect_name, args, barrier)
+
+
+@contextlib.contextmanager
+def fan_out(barrier=False):
+    """
+    Group the effects synced within the block and dispatch them at the end
+
+    :param barrier: Make the devices switch at the same moment
+    :type barrier: bool
+    """
+    group = EffectFanOut(barrier)
+    previous = getattr(_fan_out_state, 'group', None)
+    _fan_out_state.group = group
+
+    try:
+        yield group
+    finally:
+        _fan_out_state.group = previous
+        group.dispatch()
 
 
 class EffectSync(object):
@@ -40,7 +108,46 @@ class EffectSync(object):
             # Device is the device the msg originated from (could be parent device)
             if msg[1] is not self._parent:
                 # Msg from another device
-                self.run_effect(msg[2], *msg[3:])
+                group = getattr(_fan_out_state, 'group', None)
+                if group is not None:
+                    group.add(self, msg[2], msg[3:])
+                else:
+                    self.submit_effect(msg[2], msg[3:])
+
+    def submit_effect(self, effect_name, args, barrier=None):
+        """
+        Run the effect on the parent's I/O worker, or straight away without one
+
+        :param effect_name: Name of the effect
+        :type effect_name: str
+
+        :param args: Arguments for the specified effect
+        :type args: tuple
+
+        :param barrier: Barrier to wait at before running the effect
+        :type barrier: threading.Barrier or None
+        """
+        io_worker = getattr(self._parent, 'io_worker', None)
+        if io_worker is None:
+            self.run_effect(effect_name, *args)
+            return
+
+        def run():
+            if barrier is not None:
+                try:
+                    barrier.wait()
+                except threading.BrokenBarrierError:
+                    self._logger.debug("Devices didn't sync up in time, switching anyway")
+
+            self.run_effect(effect_name, *args)
+
+        def error(err):
+            self._logger.warning("Couldn't sync effect %s: %s", effect_name, err)
+            if barrier is not None:
+                # Don't leave the other devices waiting for us
+                barrier.abort()
+
+        io_worker.submit(run, (), lambda result: None, error)
 
     def run_effect(self, effect_name, *args):
         """
@@ -326,4 +433,5 @@ class EffectSync(object):
         :rtype: int
         """
         func_sig = inspect.signature(func)
-        return len(func_sig.parameters)
+        # Leave out the optional reply and error handlers of methods run on the I/O worker
+        return len([param for param in func_sig.parameters.values() if param.default is inspect.Parameter.empty])
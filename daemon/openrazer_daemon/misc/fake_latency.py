@@ -0,0 +1,147 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+"""
+Emulates the time real devices take to answer, for the fake driver
+
+The fake driver is a directory of plain files, so reads and writes finish
+instantly. When a fake device is created with a latency profile, the daemon
+sleeps in its driver file reads and writes for as long as the driver would
+wait for the USB responses, so scheduling and caching can be measured without
+hardware. See get_latency_profile in openrazer._fake_driver for the profile.
+"""
+import errno
+import json
+import os
+import random
+import threading
+import time
+
+LATENCY_FILE = 'fake_latency'
+
+
+def count_frame_rows(payload):
+    """
+    Count the rows in a custom frame, the driver sends one report per row
+
+    :param payload: Rows of row id, start column, stop column and RGB values
+    :type payload: bytes
+
+    :return: Number of rows
+    :rtype: int
+    """
+    rows = 0
+    index = 0
+    while index + 3 <= len(payload):
+        start, stop = payload[index + 1], payload[index + 2]
+        index += 3 + max(0, stop - start + 1) * 3
+        rows += 1
+
+    return max(rows, 1)
+
+
+class FakeLatency(object):
+    """
+    Latency profile of one fake device
+    """
+
+    def __init__(self, profile, rand=None):
+        self._profile = profile
+        self._random = rand or random.Random()
+        self._lock = threading.Lock()
+        self._start_time = time.monotonic()
+
+    @classmethod
+    def load(cls, device_path):
+        """
+        Load the profile the fake driver wrote for a device
+
+        :param device_path: Device directory
+        :type device_path: str
+
+        :return: Latency or None if the device doesn't have a profile
+        :rtype: FakeLatency or None
+        """
+        try:
+            with open(os.path.join(device_path, LATENCY_FILE)) as latency_file:
+                return cls(json.load(latency_file))
+        except FileNotFoundError:
+            return None
+
+    def _get(self, filename, key):
+        return self._profile.get('files', {}).get(filename, {}).get(key, self._profile.get(key, 0))
+
+    def _transfer(self, filename, reports):
+        """
+        Sleep for the given number of USB reports
+
+        :raises OSError: EIO if the transfer fails
+        """
+        with self._lock:
+            failed = self._random.random() < self._get(filename, 'failure_probability')
+
+            # A busy device gets the report again
+            busy_probability = min(self._get(filename, 'busy_probability'), 0.99)
+            while self._random.random() < busy_probability:
+                reports += 1
+
+            wait_min_us = self._get(filename, 'wait_min_us')
+            wait_max_us = max(wait_min_us, self._get(filename, 'wait_max_us'))
+            delay = sum(self._random.uniform(wait_min_us, wait_max_us) for _ in range(reports)) / 1000000
+
+        if delay > 0:
+            time.sleep(delay)
+
+        if failed:
+            raise OSError(errno.EIO, os.strerror(errno.EIO), filename)
+
+    def before_read(self, filename):
+        """
+        Wait like the driver would before a read returns
+
+        :param filename: Driver file name
+        :type filename: str
+
+        :raises OSError: EIO if the read fails
+        """
+        self._transfer(filename, 1)
+
+    def before_write(self, filename, payload):
+        """
+        Wait like the driver would before a write returns
+
+        :param filename: Driver file name
+        :type filename: str
+
+        :param payload: Written data
+        :type payload: bytes
+
+        :raises OSError: EIO if the write fails
+        """
+        reports = count_frame_rows(payload) if filename == 'matrix_custom_frame' else 1
+        self._transfer(filename, reports)
+
+    def after_read(self, filename, result):
+        """
+        Change what's read to follow the device's state
+
+        :param filename: Driver file name
+        :type filename: str
+
+        :param result: Read data
+        :type result: bytes
+
+        :return: Data the device would return
+        :rtype: bytes
+        """
+        if filename == 'charge_level':
+            drift = self._get(filename, 'charge_drift_s')
+            if drift > 0:
+                try:
+                    level = int(result.strip())
+                except ValueError:
+                    return result
+
+                steps = int((time.monotonic() - self._start_time) / drift)
+                return str(max(0, level - steps)).encode('utf-8')
+
+        return result
@@ -0,0 +1,287 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+"""
+Frame scheduler compositing the software effects of all devices
+"""
+import logging
+import math
+import threading
+import time
+
+
+class FrameStats(object):
+    """
+    Timing counters of a single frame client
+
+    All times are in seconds.
+    """
+
+    def __init__(self):
+        self.frames = 0
+        self.dropped = 0
+
+        self.last_frame_time = 0.0
+        self.max_frame_time = 0.0
+        self.total_frame_time = 0.0
+
+        self.last_jitter = 0.0
+        self.max_jitter = 0.0
+
+    def add_frame(self, frame_time, jitter):
+        """
+        Record a rendered frame
+
+        :param frame_time: Time the frame callback took
+        :type frame_time: float
+
+        :param jitter: How late the frame started compared to its deadline
+        :type jitter: float
+        """
+        self.frames += 1
+
+        self.last_frame_time = frame_time
+        self.max_frame_time = max(self.max_frame_time, frame_time)
+        self.total_frame_time += frame_time
+
+        self.last_jitter = jitter
+        self.max_jitter = max(self.max_jitter, jitter)
+
+    def as_dict(self):
+        """
+        Get the counters
+
+        :return: Counters, with the average frame time added
+        :rtype: dict
+        """
+        return {
+            'frames': self.frames,
+            'dropped': self.dropped,
+            'last_frame_time': self.last_frame_time,
+            'max_frame_time': self.max_frame_time,
+            'avg_frame_time': self.total_frame_time / self.frames if self.frames else 0.0,
+            'last_jitter': self.last_jitter,
+            'max_jitter': self.max_jitter,
+        }
+
+
+class FrameClient(object):
+    """
+    An effect registered with the frame scheduler
+    """
+
+    def __init__(self, name, render, write, period):
+        self.name = name
+        self.render = render
+        self.write = write
+        self.period = period
+        self.deadline = 0.0
+        self.stats = FrameStats()
+
+
+class FrameScheduler(threading.Thread):
+    """
+    Renders the software effects of all devices on a shared tick
+
+    Effects are render callbacks returning a frame, which the scheduler hands
+    to the effect's write callback. All frames due on a tick are rendered
+    first and then written out together, so several devices running effects
+    cost one wakeup per tick instead of one thread each.
+
+    Deadlines are absolute on the monotonic clock and aligned to multiples of
+    the period since the scheduler started. Render and USB time don't make the
+    frame rate drift and effects with the same period always share a tick.
+    When a client falls more than a period behind the missed frames are
+    dropped instead of being rendered back to back.
+    """
+
+    def __init__(self):
+        super().__init__(name='FrameScheduler', daemon=True)
+
+        self._logger = logging.getLogger('razer.framescheduler')
+
+        self._lock = threading.Lock()
+        self._wake = threading.Event()
+        self._clients = []
+        self._epoch = time.monotonic()
+
+        self._shutdown = False
+
+    def _next_tick(self, period, after):
+        """
+        Get the first tick of a period that is not before a given time
+
+        :param period: Time between frames in seconds
+        :type period: float
+
+        :param after: Monotonic time
+        :type after: float
+
+        :return: Monotonic time of the tick
+        :rtype: float
+        """
+        return self._epoch + math.ceil((after - self._epoch) / period) * period
+
+    def register(self, name, render, period, write=None):
+        """
+        Add an effect, its first frame is rendered on the next tick
+
+        :param name: Name used in the logs
+        :type name: str
+
+        :param render: Function returning the next frame, or None to skip writing it
+        :type render: callable
+
+        :param period: Time between frames in seconds
+        :type period: float
+
+        :param write: Function sending a frame to the device
+        :type write: callable
+
+        :return: Client handle for set_period and unregister
+        :rtype: FrameClient
+        """
+        client = FrameClient(name, render, write, period)
+
+        with self._lock:
+            client.deadline = self._next_tick(period, time.monotonic())
+            self._clients.append(client)
+        self._wake.set()
+
+        return client
+
+    def unregister(self, client):
+        """
+        Remove an effect
+
+        The client's last frame might still be written when this returns.
+
+        :param client: Client handle from register
+        :type client: FrameClient
+        """
+        with self._lock:
+            if client in self._clients:
+                self._clients.remove(client)
+        self._wake.set()
+
+    def set_period(self, client, period):
+        """
+        Change the frame period of an effect
+
+        :param client: Client handle from register
+        :type client: FrameClient
+
+        :param period: Time between frames in seconds
+        :type period: float
+        """
+        with self._lock:
+            client.period = period
+            client.deadline = self._next_tick(period, time.monotonic())
+        self._wake.set()
+
+    def _call(self, client, func, *args):
+        """
+        Run a client callback, logging instead of raising its errors
+        """
+        try:
+            return func(*args)
+        except Exception:
+            self._logger.exception("Frame callback of %s failed", client.name)
+            return None
+
+    def _run_tick(self, clients):
+        """
+        Render all due frames, write them and schedule the next ones
+
+        :param clients: Clients whose deadline has passed
+        :type clients: list of FrameClient
+        """
+        frames = []
+        for client in clients:
+            start = time.monotonic()
+            frame = self._call(client, client.render)
+            frames.append((client, frame, start, time.monotonic() - start))
+
+        for client, frame, start, render_time in frames:
+            write_start = time.monotonic()
+            if frame is not None and client.write is not None:
+                self._call(client, client.write, frame)
+            end = time.monotonic()
+
+            client.stats.add_frame(render_time + end - write_start, start - client.deadline)
+
+            client.deadline += client.period
+            if client.deadline <= end:
+                missed = int((end - client.deadline) // client.period) + 1
+                client.deadline += missed * client.period
+                client.stats.dropped += missed
+
+    def run(self):
+        """
+        Scheduler loop
+        """
+        while not self._shutdown:
+            # Clear before looking at the clients, a wakeup that lands after
+            # this is either seen below or makes the next wait return at once
+            self._wake.clear()
+            with self._lock:
+                clients = list(self._clients)
+
+            if not clients:
+                self._wake.wait()
+                continue
+
+            timeout = min(client.deadline for client in clients) - time.monotonic()
+            if timeout > 0:
+                # Registrations wake us up early so the deadlines get recomputed
+                if self._wake.wait(timeout):
+                    continue
+
+            now = time.monotonic()
+            with self._lock:
+                due = [client for client in self._clients if client.deadline <= now]
+
+            self._run_tick(due)
+
+    def stop(self):
+        """
+        Stop the scheduler loop
+        """
+        self._shutdown = True
+        self._wake.set()
+
+        if self.is_alive():
+            self.join(timeout=2)
+
+
+_SCHEDULER = None
+_SCHEDULER_LOCK = threading.Lock()
+
+
+def get_frame_scheduler():
+    """
+    Get the frame scheduler shared by all devices, starting it on first use
+
+    :return: Frame scheduler
+    :rtype: FrameScheduler
+    """
+    global _SCHEDULER  # pylint: disable=global-statement
+
+    with _SCHEDULER_LOCK:
+        if _SCHEDULER is None:
+            _SCHEDULER = FrameScheduler()
+            _SCHEDULER.start()
+
+        return _SCHEDULER
+
+
+def stop_frame_scheduler():
+    """
+    Stop the shared frame scheduler if it was started
+    """
+    global _SCHEDULER  # pylint: disable=global-statement
+
+    with _SCHEDULER_LOCK:
+        scheduler, _SCHEDULER = _SCHEDULER, None
+
+    if scheduler is not None:
+        scheduler.stop()
@@ -0,0 +1,110 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+"""
+Shared memory framebuffers for custom frames
+
+Clients map a framebuffer, draw a frame into it and only send its ID and
+length over the bus, instead of the whole frame.
+"""
+import collections
+import fcntl
+import mmap
+import os
+import threading
+
+# Framebuffers kept per device, the oldest client has to get a new one
+MAX_FRAMEBUFFERS = 8
+
+
+class FramebufferNotFoundError(ValueError):
+    """
+    Raised when a client commits a framebuffer the daemon has dropped
+
+    Has its own DBus error name so clients can tell it apart from other
+    errors and get a new framebuffer.
+    """
+    _dbus_error_name = 'org.razer.Error.FramebufferNotFound'
+
+
+class FramebufferStore(object):
+    """
+    Framebuffers of one device, one per client by ID
+
+    Every caller gets its own buffer so clients can't draw into each other's
+    frames, only the newest max_framebuffers are kept.
+    """
+
+    def __init__(self, size, max_framebuffers=MAX_FRAMEBUFFERS):
+        self._size = size
+        self._max_framebuffers = max_framebuffers
+
+        self._lock = threading.Lock()
+        self._framebuffers = collections.OrderedDict()
+        self._framebuffer_id = 0
+
+    def create(self):
+        """
+        Create a framebuffer
+
+        The framebuffer is a memfd whose size is sealed so a client can't
+        truncate it under the daemon's mapping. The caller owns the returned
+        descriptor and has to close it.
+
+        :return: File descriptor and ID of the framebuffer
+        :rtype: tuple
+        """
+        fd = os.memfd_create('openrazer-framebuffer', os.MFD_CLOEXEC | os.MFD_ALLOW_SEALING)
+        try:
+            os.ftruncate(fd, self._size)
+            fcntl.fcntl(fd, fcntl.F_ADD_SEALS, fcntl.F_SEAL_SHRINK | fcntl.F_SEAL_GROW | fcntl.F_SEAL_SEAL)
+            framebuffer = mmap.mmap(fd, self._size)
+        except Exception:
+            os.close(fd)
+            raise
+
+        with self._lock:
+            self._framebuffer_id += 1
+            framebuffer_id = self._framebuffer_id
+            self._framebuffers[framebuffer_id] = framebuffer
+
+            while len(self._framebuffers) > self._max_framebuffers:
+                _, old_framebuffer = self._framebuffers.popitem(last=False)
+                old_framebuffer.close()
+
+        return fd, framebuffer_id
+
+    def read(self, framebuffer_id, length):
+        """
+        Get a frame from a framebuffer
+
+        :param framebuffer_id: Framebuffer ID from create
+        :type framebuffer_id: int
+
+        :param length: Length of the frame
+        :type length: int
+
+        :return: Binary payload
+        :rtype: bytes
+
+        :raises FramebufferNotFoundError: If the framebuffer was dropped
+        :raises ValueError: If the length is out of range
+        """
+        with self._lock:
+            framebuffer = self._framebuffers.get(framebuffer_id)
+            if framebuffer is None:
+                raise FramebufferNotFoundError("Framebuffer {0} not found, call getFramebuffer again".format(framebuffer_id))
+
+            if not 0 < length <= len(framebuffer):
+                raise ValueError("Frame length {0} out of range".format(length))
+
+            # Copy so the client can draw the next frame while this one is sent
+            return framebuffer[:length]
+
+    def close(self):
+        """
+        Release all framebuffers, clients keep their mappings
+        """
+        with self._lock:
+            for framebuffer in self._framebuffers.values():
+                framebuffer.close()
+            self._framebuffers.clear()
@@ -0,0 +1,264 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+"""
+Waits for hotplugged devices to be ready before they are added
+"""
+import logging
+import os
+import re
+import threading
+import time
+
+# Add a device anyway if it hasn't settled after this long
+SETTLE_TIMEOUT = 1.0
+# Recheck pending devices this often, for changes udev doesn't tell us about
+POLL_INTERVAL = 0.02
+
+EVENT_FILE_DIR = '/dev/input/by-id/'
+SYS_INPUT_DIR = '/sys/class/input/'
+
+# HID device names like 0003:1532:0203.0001, bus, VID, PID and instance
+HID_ID_REGEX = re.compile(r'^[0-9A-F]{4}:([0-9A-F]{4}):[0-9A-F]{4}\.[0-9A-F]{4}$')
+
+USB_CLASS_HID = b'03'
+
+
+class PendingDevice(object):
+    """
+    HID interfaces seen for one USB device
+    """
+
+    def __init__(self, key, usb_device):
+        self.key = key
+        self.usb_device = usb_device
+        self.devices = {}
+        self.start_time = time.monotonic()
+
+
+class HotplugSettler(threading.Thread):
+    """
+    Collects udev add events per USB device and hands them on once the device is ready
+
+    A USB device is ready when each of its HID interfaces has been bound, one
+    of them has a device_type file we can read, and the event files of the
+    matching device class exist for it. Devices that don't get there within
+    SETTLE_TIMEOUT are handed on anyway.
+
+    find_class(device_id, dev_path) returns the hardware class of a HID
+    device or None, callback(devices) gets the udev devices of a USB device.
+    Only HID devices with one of vendor_ids are collected, the rest are
+    ignored straight away.
+    """
+
+    def __init__(self, find_class, callback, vendor_ids, timeout=SETTLE_TIMEOUT, poll_interval=POLL_INTERVAL,
+                 event_file_dir=EVENT_FILE_DIR, sys_input_dir=SYS_INPUT_DIR):
+        super().__init__(name='HotplugSettler', daemon=True)
+
+        self._logger = logging.getLogger('razer.hotplug')
+
+        self._find_class = find_class
+        self._callback = callback
+        self._vendor_ids = frozenset(vendor_ids)
+        self._timeout = timeout
+        self._poll_interval = poll_interval
+        self._event_file_dir = event_file_dir
+        self._sys_input_dir = sys_input_dir
+
+        self._condition = threading.Condition()
+        self._pending = {}
+        self._shutdown = False
+
+    @staticmethod
+    def _get_usb_device(device):
+        try:
+            return device.find_parent('usb', 'usb_device')
+        except (AttributeError, LookupError):
+            return None
+
+    def add(self, device):
+        """
+        Add a HID device from a udev add or bind event
+
+        :param device: Udev device
+        :type device: pyudev.device._device.Device
+        """
+        match = HID_ID_REGEX.match(device.sys_name)
+        if match is None or int(match.group(1), 16) not in self._vendor_ids:
+            return
+
+        usb_device = self._get_usb_device(device)
+        if usb_device is not None:
+            key = usb_device.sys_path
+        else:
+            # Group by bus, VID and PID like the daemon's interface matching
+            key = device.sys_name.split('.')[0]
+
+        with self._condition:
+            pending = self._pending.get(key)
+            if pending is None:
+                pending = self._pending[key] = PendingDevice(key, usb_device)
+            pending.devices[device.sys_name] = device
+            self._condition.notify()
+
+    def remove(self, device):
+        """
+        Forget a device removed before it settled
+
+        :param device: Udev device
+        :type device: pyudev.device._device.Device
+        """
+        with self._condition:
+            for key, pending in list(self._pending.items()):
+                pending.devices.pop(device.sys_name, None)
+                if not pending.devices:
+                    del self._pending[key]
+
+    def wake(self):
+        """
+        Recheck the pending devices, e.g. after an input device appeared
+        """
+        with self._condition:
+            self._condition.notify()
+
+    def _interfaces_bound(self, pending):
+        """
+        Check every HID interface of the USB device has its HID device
+        """
+        if pending.usb_device is None:
+            return True
+
+        expected = set()
+        bound = set()
+        for child in pending.usb_device.children:
+            if child.subsystem == 'usb' and child.device_type == 'usb_interface':
+                if child.attributes.get('bInterfaceClass') == USB_CLASS_HID:
+                    expected.add(child.sys_path)
+            elif child.subsystem == 'hid' and child.parent is not None:
+                bound.add(child.parent.sys_path)
+                # Pick up interfaces whose events we haven't had yet
+                pending.devices.setdefault(child.sys_name, child)
+
+        return expected <= bound
+
+    def _event_files_ready(self, device_class, sys_path):
+        """
+        Check the event files of the device class exist for the device at sys_path
+
+        Other devices of the same model have event files with the same names,
+        so only links that lead to an input device below sys_path count.
+        """
+        if device_class.EVENT_FILE_REGEX is None:
+            return True
+
+        try:
+            names = os.listdir(self._event_file_dir)
+        except OSError:
+            return False
+
+        for name in names:
+            if device_class.EVENT_FILE_REGEX.match(name) is None:
+                continue
+
+            event_name = os.path.basename(os.path.realpath(os.path.join(self._event_file_dir, name)))
+            input_path = os.path.realpath(os.path.join(self._sys_input_dir, event_name))
+            if input_path.startswith(sys_path + os.sep):
+                return True
+
+        return False
+
+    def _is_settled(self, pending):
+        """
+        Check if a USB device is ready to be added
+
+        :param pending: Pending device
+        :type pending: PendingDevice
+
+        :return: True if ready
+        :rtype: bool
+        """
+        if not self._interfaces_bound(pending):
+            return False
+
+        for device in pending.devices.values():
+            try:
+                device_class = self._find_class(device.sys_name, device.sys_path)
+            except OSError:  # Interface went away or isn't populated yet
+                continue
+
+            if device_class is None:
+                continue
+
+            # udev rules have to change the group before we can use it
+            if not os.access(os.path.join(device.sys_path, 'device_type'), os.R_OK):
+                return False
+
+            # Event files can belong to any interface of the USB device
+            if pending.usb_device is not None:
+                return self._event_files_ready(device_class, pending.usb_device.sys_path)
+            return self._event_files_ready(device_class, os.path.dirname(device.sys_path))
+
+        return False
+
+    def _collect_settled(self):
+        """
+        Take the pending devices that are ready or timed out
+
+        :return: Lists of udev devices
+        :rtype: list of list
+        """
+        now = time.monotonic()
+        result = []
+
+        for key, pending in list(self._pending.items()):
+            try:
+                settled = self._is_settled(pending)
+            except Exception:  # pylint: disable=broad-except
+                # Let adding the device deal with it instead of stopping the settler
+                self._logger.exception("Failed to check if %s settled, adding anyway", key)
+            else:
+                if settled:
+                    self._logger.debug("%s settled after %.3fs", key, now - pending.start_time)
+                elif now - pending.start_time >= self._timeout:
+                    self._logger.debug("%s didn't settle, adding anyway", key)
+                else:
+                    continue
+
+            del self._pending[key]
+            result.append(list(pending.devices.values()))
+
+        return result
+
+    def run(self):
+        """
+        Settle loop
+        """
+        while True:
+            with self._condition:
+                while not self._shutdown and not self._pending:
+                    self._condition.wait()
+
+                if self._shutdown:
+                    break
+
+                settled = self._collect_settled()
+
+                if not settled:
+                    self._condition.wait(self._poll_interval)
+                    continue
+
+            for devices in settled:
+                try:
+                    self._callback(devices)
+                except Exception:
+                    self._logger.exception("Failed to add devices")
+
+    def stop(self):
+        """
+        Stop the settle loop
+        """
+        with self._condition:
+            self._shutdown = True
+            self._condition.notify()
+
+        if self.is_alive():
+            self.join(timeout=2)
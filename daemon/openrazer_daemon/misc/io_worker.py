@@ -0,0 +1,118 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+"""
+Per device worker thread for driver I/O
+"""
+import logging
+import queue
+import threading
+
+# Calls waiting for a device before new ones are refused
+IO_QUEUE_SIZE = 32
+
+
+class DeviceBusyError(Exception):
+    """
+    Raised when a device's I/O queue is full
+    """
+
+
+class DeviceIOWorker(threading.Thread):
+    """
+    Runs the calls of one device in order on its own thread
+
+    Slow devices, like wireless receivers that take hundreds of milliseconds
+    to answer, then only hold up calls to themselves instead of the daemon's
+    main loop.
+    """
+
+    def __init__(self, device_number, queue_size=IO_QUEUE_SIZE):
+        super().__init__(name='DeviceIOWorker-{0}'.format(device_number), daemon=True)
+
+        self._logger = logging.getLogger('razer.device{0}.ioworker'.format(device_number))
+        self._queue = queue.Queue(maxsize=queue_size)
+
+    def submit(self, func, args, reply_cb, error_cb):
+        """
+        Queue a call
+
+        :param func: Function to call
+        :type func: callable
+
+        :param args: Arguments of the function
+        :type args: tuple
+
+        :param reply_cb: Called with the function's return value
+        :type reply_cb: callable
+
+        :param error_cb: Called with the exception if the function raises or the queue is full
+        :type error_cb: callable
+        """
+        try:
+            self._queue.put_nowait((func, args, reply_cb, error_cb))
+        except queue.Full:
+            self._logger.warning("I/O queue full, refusing %s", getattr(func, '__name__', func))
+            error_cb(DeviceBusyError("Device is busy"))
+
+    def run(self):
+        """
+        Worker loop
+        """
+        while True:
+            job = self._queue.get()
+            if job is None:
+                break
+
+            func, args, reply_cb, error_cb = job
+            try:
+                result = func(*args)
+            except Exception as err:  # pylint: disable=broad-except
+                error_cb(err)
+            else:
+                reply_cb(result)
+
+    def stop(self):
+        """
+        Stop the worker once the queued calls have run
+        """
+        if self.is_alive():
+            self._queue.put(None)
+            if threading.current_thread() is not self:
+                self.join(timeout=2)
+
+
+def submit_all(calls, reply_cb):
+    """
+    Queue calls on their workers and collect the results
+
+    Like asyncio.gather with return_exceptions, reply_cb is called once all
+    calls have run, with their results in the order of calls and the
+    exception in place of the result of a call that raised.
+
+    :param calls: Tuples of worker, function and arguments
+    :type calls: list of tuple
+
+    :param reply_cb: Called with the list of results
+    :type reply_cb: callable
+    """
+    results = [None] * len(calls)
+    remaining = [len(calls)]
+    lock = threading.Lock()
+
+    if not calls:
+        reply_cb(results)
+        return
+
+    def make_done(index):
+        def done(result):
+            with lock:
+                results[index] = result
+                remaining[0] -= 1
+                finished = remaining[0] == 0
+            if finished:
+                reply_cb(results)
+        return done
+
+    for index, (worker, func, args) in enumerate(calls):
+        done = make_done(index)
+        worker.submit(func, args, done, done)
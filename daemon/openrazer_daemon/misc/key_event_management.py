@@ -14,7 +14,7 @@ Each event is in the format of
 * unsigned short code
 * signed int value
 """
-import datetime
+import collections
 import fcntl
 import json
 import logging
@@ -27,15 +27,20 @@ import time
 
 # pylint: disable=import-error
 from openrazer_daemon.keyboard import KEY_MAPPING, TARTARUS_KEY_MAPPING, EVENT_MAPPING, TARTARUS_EVENT_MAPPING, NAGA_HEX_V2_EVENT_MAPPING, NAGA_HEX_V2_KEY_MAPPING, ORBWEAVER_EVENT_MAPPING, ORBWEAVER_KEY_MAPPING
-from .macro import MacroKey, MacroRunner, macro_dict_to_obj
+from .macro import MacroKey, MacroRunner, CompiledMacro, get_macro_keyboard, macro_dict_to_obj
 
 EVENT_FORMAT = '@llHHI'
 EVENT_SIZE = struct.calcsize(EVENT_FORMAT)
+# Events drained per read() call
+EVENT_BATCH = 64
 
-EPOLL_TIMEOUT = 0.01
 SPIN_SLEEP = 0.01
 
 EVIOCGRAB = 0x40044590
+EVIOCSCLOCKID = 0x400445a0
+CLOCK_MONOTONIC = 1
+
+KEY_ACTIONS = ('release', 'press', 'autorepeat')
 
 COLOUR_CHOICES = (
     (255, 0, 0),    # Red
@@ -69,6 +74,10 @@ def random_colour_picker(last_choice, iterable):
 class KeyWatcher(threading.Thread):
     """
     Thread to watch keyboard event files and return keypresses
+
+    Each event file is drained with one read() into a reusable buffer per
+    wakeup. The thread blocks in epoll until an event arrives or it is asked to
+    shut down, so keys are handed on as soon as the kernel has them.
     """
     @staticmethod
     def parse_event_record(data):
@@ -78,33 +87,20 @@ class KeyWatcher(threading.Thread):
         :param data: Binary data
         :type data: bytes
 
-        :return: Tuple of event time, key_action, key_code
+        :return: Tuple of event time in nanoseconds, key_action, key_code
         :rtype: tuple
         """
         # Event Seconds, Event Microseconds, Event Type, Event Code, Event Value
-        ev_sec, ev_usec, ev_type, ev_code, ev_value = struct.unpack(EVENT_FORMAT, data)
+        return KeyWatcher._parse_event(*struct.unpack(EVENT_FORMAT, data))
 
+    @staticmethod
+    def _parse_event(ev_sec, ev_usec, ev_type, ev_code, ev_value):
         if ev_type != 0x01:  # input-event-codes.h EV_KEY 0x01
             return None, None, None
 
-        if ev_value == 0:
-            key_action = 'release'
-        elif ev_value == 1:
-            key_action = 'press'
-        elif ev_value == 2:
-            key_action = 'autorepeat'
-        else:
-            key_action = 'unknown'
-
-        seconds = ev_sec + (ev_usec * 0.000001)
-        date = datetime.datetime.fromtimestamp(seconds)
-
-        result = (date, key_action, ev_code)
-
-        if ev_type == ev_code == ev_value == 0:
-            return None, None, None
+        key_action = KEY_ACTIONS[ev_value] if ev_value < len(KEY_ACTIONS) else 'unknown'
 
-        return result
+        return ev_sec * 1000000000 + ev_usec * 1000, key_action, ev_code
 
     def __init__(self, device_id, event_files, parent, use_epoll=True):
         super().__init__()
@@ -115,12 +111,24 @@ class KeyWatcher(threading.Thread):
         self._use_epoll = use_epoll
         self._parent = parent
 
-        self.open_event_files = [open(event_file, 'rb') for event_file in self._event_files]
+        self._buffer = bytearray(EVENT_SIZE * EVENT_BATCH)
+        self._buffer_view = memoryview(self._buffer)
+
+        # Written to on shutdown to wake up epoll
+        self._wake_read, self._wake_write = os.pipe2(os.O_NONBLOCK | os.O_CLOEXEC)
+
+        self.open_event_files = [open(event_file, 'rb', buffering=0) for event_file in self._event_files]
         # Set open files to non blocking mode
         for event_file in self.open_event_files:
             flags = fcntl.fcntl(event_file.fileno(), fcntl.F_GETFL)
             fcntl.fcntl(event_file.fileno(), fcntl.F_SETFL, flags | os.O_NONBLOCK)
 
+            # Event times from the monotonic clock, the fake driver's files don't support it
+            try:
+                fcntl.ioctl(event_file.fileno(), EVIOCSCLOCKID, struct.pack('i', CLOCK_MONOTONIC))
+            except OSError:
+                pass
+
     def run(self):
         """
         Main event loop
@@ -134,20 +142,19 @@ class KeyWatcher(threading.Thread):
         # Register files with select
         for event_fd in event_file_map.keys():
             poll_object.register(event_fd, select.EPOLLIN | select.EPOLLPRI)
+        poll_object.register(self._wake_read, select.EPOLLIN)
 
         # Loop
         while not self._shutdown:
-            # epoll is nice but it wasn't getting events properly :(
-
             try:  # Cheap hack until i merged new code
                 if self._use_epoll:
                     self._poll_epoll(poll_object, event_file_map)
                 else:
                     self._poll_read()
+                    time.sleep(SPIN_SLEEP)
             except (IOError, OSError):  # Basically if there's an error, most likely device has been removed then it'll get deleted properly
-                pass
-
-            time.sleep(SPIN_SLEEP)
+                # Don't spin if the files are gone
+                time.sleep(SPIN_SLEEP)
 
         # Unbind files and close them
         for event_fd, event_file in event_file_map.items():
@@ -155,43 +162,45 @@ class KeyWatcher(threading.Thread):
             event_file.close()
 
         poll_object.close()
+        os.close(self._wake_read)
+        os.close(self._wake_write)
 
-    def _poll_epoll(self, poll_object, event_file_map):
-        events = poll_object.poll(EPOLL_TIMEOUT)
-
-        if len(events) != 0:
-            # pylint: disable=unused-variable
-            for event_fd, mask in events:
-                while True:
-                    key_data = event_file_map[event_fd].read(EVENT_SIZE)
-                    if not key_data:
-                        break
+    def _read_events(self, event_file):
+        """
+        Drain an event file and pass its key events on
 
-                    date, key_action, key_code = self.parse_event_record(key_data)
+        :param event_file: Unbuffered non blocking event file
+        :type event_file: io.FileIO
+        """
+        while True:
+            length = event_file.readinto(self._buffer)
+            if not length:
+                break
 
-                    # Skip if date, key_action and key_code is none as that's a spacer record
-                    if date is None:
-                        continue
+            for record in struct.iter_unpack(EVENT_FORMAT, self._buffer_view[:length - length % EVENT_SIZE]):
+                event_time, key_action, key_code = self._parse_event(*record)
 
-                    # Now if key is pressed then we record
-                    self._parent.key_action(date, key_code, key_action)
+                # Skip anything that isn't a key
+                if event_time is None:
+                    continue
 
-    def _poll_read(self):
-        for event_file in self.open_event_files:
+                # Now if key is pressed then we record
+                self._parent.key_action(event_time, key_code, key_action)
 
-            key_data = event_file.read(EVENT_SIZE)
+            if length < len(self._buffer):
+                break
 
-            if key_data is None:
+    def _poll_epoll(self, poll_object, event_file_map):
+        # pylint: disable=unused-variable
+        for event_fd, mask in poll_object.poll():
+            if event_fd == self._wake_read:
                 continue
 
-            date, key_action, key_code = self.parse_event_record(key_data)
-
-            # Skip if date, key_action and key_code is none as that's a spacer record
-            if date is None:
-                continue
+            self._read_events(event_file_map[event_fd])
 
-            # Now if key is pressed then we record
-            self._parent.key_action(date, key_code, key_action)
+    def _poll_read(self):
+        for event_file in self.open_event_files:
+            self._read_events(event_file)
 
     @property
     def shutdown(self):
@@ -213,6 +222,12 @@ class KeyWatcher(threading.Thread):
         """
         self._shutdown = value
 
+        if value:
+            try:
+                os.write(self._wake_write, b'\x00')
+            except OSError:
+                pass
+
 
 class KeyboardKeyManager(object):
     """
@@ -251,6 +266,7 @@ class KeyboardKeyManager(object):
 
         self._recording_macro = False
         self._macros = {}
+        self._compiled_macros = {}
 
         self._current_macro_bind_key = None
         self._current_macro_combo = []
@@ -258,9 +274,12 @@ class KeyboardKeyManager(object):
         self._threads = set()
         self._clean_counter = 0
 
+        # Keys ordered by expiry time, only touched with the access lock held.
+        # Readers get the immutable snapshot published after every change.
         self._temp_key_store_active = False
-        self._temp_key_store = []
-        self._temp_expire_time = datetime.timedelta(seconds=2)
+        self._temp_key_store = collections.deque()
+        self._temp_key_snapshot = ()
+        self._temp_expire_time = 2.0
 
         self._last_colour_choice = None
 
@@ -275,25 +294,57 @@ class KeyboardKeyManager(object):
         """
         Get the temporary key store
 
-        :return: List of keys
-        :rtype: list
+        Doesn't lock, so the ripple effect can read it every frame without
+        waiting for the key watcher.
+
+        :return: Tuple of (expire_time, (key_row, key_col), colour), oldest first. Times are from time.monotonic()
+        :rtype: tuple
         """
-        # Locking so it doesn't mutate whilst copying
-        self._access_lock.acquire()
-        now = datetime.datetime.now()
+        snapshot = self._temp_key_snapshot
+        now = time.monotonic()
 
-        # Remove expired keys from store
-        try:
-            # Get date and if its less than now its expired
-            while self._temp_key_store[0][0] < now:
-                self._temp_key_store.pop(0)
-        except IndexError:
-            pass
+        # Skip keys that expired since the snapshot was published
+        index = 0
+        while index < len(snapshot) and snapshot[index][0] < now:
+            index += 1
 
-        # Creating a copy as then it doesn't mutate whilst iterating
-        result = self._temp_key_store[:]
-        self._access_lock.release()
-        return result
+        return snapshot[index:] if index else snapshot
+
+    def _expire_temp_keys(self, now):
+        """
+        Remove expired keys from the temporary key store
+
+        Needs the access lock held.
+
+        :param now: Monotonic time
+        :type now: float
+        """
+        store = self._temp_key_store
+        if store and store[0][0] < now:
+            while store and store[0][0] < now:
+                store.popleft()
+            self._publish_temp_keys()
+
+    def _add_temp_key(self, now, key, colour):
+        """
+        Add a key to the temporary key store
+
+        Needs the access lock held.
+
+        :param now: Monotonic time
+        :type now: float
+
+        :param key: Row and column of the key
+        :type key: tuple
+
+        :param colour: Colour of the key
+        :type colour: tuple
+        """
+        self._temp_key_store.append((now + self._temp_expire_time, key, colour))
+        self._publish_temp_keys()
+
+    def _publish_temp_keys(self):
+        self._temp_key_snapshot = tuple(self._temp_key_store)
 
     @property
     def temp_key_store_state(self):
@@ -338,8 +389,8 @@ class KeyboardKeyManager(object):
           then it will record keys, then pressing FN+F9 will save macro.
         * Pressing any macro key will run macro.
         * Pressing FN+F10 will toggle game mode.
-        :param event_time: Time event occurred
-        :type event_time: datetime.datetime
+        :param event_time: Time event occurred in nanoseconds
+        :type event_time: int
 
         :param key_id: Key Event ID
         :type key_id: int
@@ -363,15 +414,10 @@ class KeyboardKeyManager(object):
                 # Quit out early
                 return
 
-        now = datetime.datetime.now()
+        now = time.monotonic()
 
         # Remove expired keys from store
-        try:
-            # Get date and if its less than now its expired
-            while self._temp_key_store[0][0] < now:
-                self._temp_key_store.pop(0)
-        except IndexError:
-            pass
+        self._expire_temp_keys(now)
 
         # Clean up any threads
         if self._clean_counter > 20 and len(self._threads) > 0:
@@ -398,7 +444,7 @@ class KeyboardKeyManager(object):
                 if self._temp_key_store_active:
                     colour = random_colour_picker(self._last_colour_choice, COLOUR_CHOICES)
                     self._last_colour_choice = colour
-                    self._temp_key_store.append((now + self._temp_expire_time, self.KEY_MAP[key_name], colour))
+                    self._add_temp_key(now, self.KEY_MAP[key_name], colour)
 
                 # Macro FN+F9 logic
                 if key_name == 'MACROMODE':
@@ -498,11 +544,29 @@ class KeyboardKeyManager(object):
 
         start_time = self._current_macro_combo[0][0]
         for event_time, key, state in self._current_macro_combo:
-            delay = (event_time - start_time).microseconds
+            delay = (event_time - start_time) // 1000
             start_time = event_time
             new_macro.append(MacroKey(key, delay, state))
 
-        self._macros[self._current_macro_bind_key] = new_macro
+        self.bind_macro(self._current_macro_bind_key, new_macro)
+
+    def bind_macro(self, macro_key, macro_list):
+        """
+        Bind a macro to a key, compiling it so playing it is quick
+
+        :param macro_key: Macro bind key
+        :type macro_key: str
+
+        :param macro_list: List of macro objects
+        :type macro_list: list
+        """
+        self._macros[macro_key] = macro_list
+        self._compiled_macros[macro_key] = CompiledMacro(macro_list)
+
+        # Create the virtual keyboard now, it takes a moment before the
+        # desktop picks up a new input device
+        if not self._testing:
+            get_macro_keyboard()
 
     def clean_macro_threads(self):
         """
@@ -530,7 +594,7 @@ class KeyboardKeyManager(object):
         :type macro_key: str
         """
         self._logger.info("Running Macro %s:%s", macro_key, str(self._macros[macro_key]))
-        macro_thread = MacroRunner(self._device_id, macro_key, self._macros[macro_key])
+        macro_thread = MacroRunner(self._device_id, macro_key, self._compiled_macros[macro_key])
         macro_thread.start()
         self._threads.add(macro_thread)
 
@@ -542,6 +606,7 @@ class KeyboardKeyManager(object):
         :param key_name: Key Name
         :type key_name: str
         """
+        self._compiled_macros.pop(key_name, None)
         try:
             del self._macros[key_name]
         except KeyError:
@@ -579,7 +644,7 @@ class KeyboardKeyManager(object):
         :type macro_json: str
         """
         macro_list = [macro_dict_to_obj(macro_object_dict) for macro_object_dict in json.loads(macro_json)]
-        self._macros[macro_key] = macro_list
+        self.bind_macro(macro_key, macro_list)
 
     def close(self):
         """
@@ -645,8 +710,8 @@ class GamepadKeyManager(KeyboardKeyManager):
           then it will record keys, then pressing FN+F9 will save macro.
         * Pressing any macro key will run macro.
         * Pressing FN+F10 will toggle game mode.
-        :param event_time: Time event occurred
-        :type event_time: datetime.datetime
+        :param event_time: Time event occurred in nanoseconds
+        :type event_time: int
 
         :param key_id: Key Event ID
         :type key_id: int
@@ -661,15 +726,10 @@ class GamepadKeyManager(KeyboardKeyManager):
         if not self._event_files_locked:
             self.grab_event_files(True)
 
-        now = datetime.datetime.now()
+        now = time.monotonic()
 
         # Remove expired keys from store
-        try:
-            # Get date and if its less than now its expired
-            while self._temp_key_store[0][0] < now:
-                self._temp_key_store.pop(0)
-        except IndexError:
-            pass
+        self._expire_temp_keys(now)
 
         # Clean up any threads
         if self._clean_counter > 20 and len(self._threads) > 0:
@@ -685,7 +745,7 @@ class GamepadKeyManager(KeyboardKeyManager):
             if self._temp_key_store_active:
                 colour = random_colour_picker(self._last_colour_choice, COLOUR_CHOICES)
                 self._last_colour_choice = colour
-                self._temp_key_store.append((now + self._temp_expire_time, self.GAMEPAD_KEY_MAPPING[key_name], colour))
+                self._add_temp_key(now, self.GAMEPAD_KEY_MAPPING[key_name], colour)
 
             # if self._testing:
             # if key_press:
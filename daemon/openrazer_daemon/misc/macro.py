@@ -9,12 +9,54 @@ Launching programs etc...
 import logging
 import subprocess
 import threading
+import time
 
 # pylint: disable=import-error
-from openrazer_daemon.keyboard import XTE_MAPPING
+from openrazer_daemon.keyboard import EVENT_MAPPING, XTE_MAPPING
+from openrazer_daemon.misc.uinput import UInputKeyboard, pack_key_event, warn_xte_fallback, KEY_DOWN, KEY_UP
 
 # This determines if the macro keys are executed with their natural spacing
-XTE_SLEEP = False
+NATURAL_SPACING = True
+
+# Linux key codes of the keys macros can press
+UINPUT_KEY_CODES = {key_name: key_code for key_code, key_name in EVENT_MAPPING.items() if XTE_MAPPING.get(key_name, key_name) is not None}
+
+_KEYBOARD = None
+_KEYBOARD_FAILED = False
+_KEYBOARD_LOCK = threading.Lock()
+
+
+def get_macro_keyboard():
+    """
+    Get the virtual keyboard macros are played on, creating it on first use
+
+    :return: Keyboard or None if uinput can't be used
+    :rtype: UInputKeyboard or None
+    """
+    global _KEYBOARD, _KEYBOARD_FAILED  # pylint: disable=global-statement
+
+    with _KEYBOARD_LOCK:
+        if _KEYBOARD is None and not _KEYBOARD_FAILED:
+            try:
+                _KEYBOARD = UInputKeyboard('OpenRazer Macro Keyboard', UINPUT_KEY_CODES.values())
+            except OSError as err:
+                warn_xte_fallback(err)
+                _KEYBOARD_FAILED = True
+
+        return _KEYBOARD
+
+
+def close_macro_keyboard():
+    """
+    Remove the virtual keyboard if it was created
+    """
+    global _KEYBOARD  # pylint: disable=global-statement
+
+    with _KEYBOARD_LOCK:
+        keyboard, _KEYBOARD = _KEYBOARD, None
+
+    if keyboard is not None:
+        keyboard.close()
 
 
 class MacroObject(object):
@@ -143,17 +185,58 @@ class MacroScript(MacroObject):
         proc.communicate()
 
 
-class MacroRunner(threading.Thread):
+class KeySequence(object):
     """
-    Thread to run macros
+    Run of key events between other macro actions
     """
 
-    def __init__(self, device_id, macro_bind, macro_data):
-        super().__init__()
+    def __init__(self):
+        # List of (offset in ns from the start, packed events)
+        self.events = []
+        self.xte = ''
 
-        self._logger = logging.getLogger('razer.device{0}.macro{1}'.format(device_id, macro_bind))
-        self._macro_data = macro_data
-        self._macro_bind = macro_bind
+
+class CompiledMacro(object):
+    """
+    Macro turned into ready to write events when it's bound
+
+    Key events are packed for uinput with their offsets from the start of the
+    sequence, events without a pause between them are written together. The
+    XTE script is kept as a fallback for when uinput can't be used.
+    """
+
+    def __init__(self, macro_data):
+        self.macro_data = macro_data
+        self.steps = []
+
+        sequence = None
+        offset = 0
+
+        for event in macro_data:
+            if not isinstance(event, MacroKey):
+                sequence = None
+                self.steps.append(event)
+                continue
+
+            if sequence is None:
+                sequence = KeySequence()
+                offset = 0
+                self.steps.append(sequence)
+
+            sequence.xte += self.xte_line(event)
+
+            key_code = UINPUT_KEY_CODES.get(event.key_id)
+            if key_code is None:
+                continue
+
+            if NATURAL_SPACING:
+                offset += int(event.pre_pause) * 1000
+
+            packed = pack_key_event(key_code, KEY_UP if event.state == 'UP' else KEY_DOWN)
+            if sequence.events and sequence.events[-1][0] == offset:
+                sequence.events[-1] = (offset, sequence.events[-1][1] + packed)
+            else:
+                sequence.events.append((offset, packed))
 
     @staticmethod
     def xte_line(key_event):
@@ -172,7 +255,7 @@ class MacroRunner(threading.Thread):
         cmd = ''
 
         if key is not None:
-            if XTE_SLEEP:
+            if NATURAL_SPACING:
                 cmd += 'usleep {0}\n'.format(key_event.pre_pause)
 
             if key_event.state == 'UP':
@@ -182,30 +265,61 @@ class MacroRunner(threading.Thread):
 
         return cmd
 
+
+class MacroRunner(threading.Thread):
+    """
+    Thread to run macros
+    """
+
+    def __init__(self, device_id, macro_bind, macro):
+        super().__init__()
+
+        self._logger = logging.getLogger('razer.device{0}.macro{1}'.format(device_id, macro_bind))
+        self._macro = macro
+        self._macro_bind = macro_bind
+
+    @staticmethod
+    def play_keys(keyboard, events):
+        """
+        Write key events at their offsets from now
+
+        The deadlines are absolute, so time spent writing doesn't add up
+        over long macros.
+
+        :param keyboard: Virtual keyboard
+        :type keyboard: UInputKeyboard
+
+        :param events: List of (offset in ns, packed events)
+        :type events: list of tuple
+        """
+        start = time.monotonic_ns()
+
+        for offset, packed in events:
+            delay = start + offset - time.monotonic_ns()
+            if delay > 0:
+                time.sleep(delay / 1e9)
+
+            keyboard.write(packed)
+
     def run(self):
         """
         Main thread function
         """
+        keyboard = get_macro_keyboard()
 
-        # TODO move the xte-munging to the init
-        xte = ''
+        for step in self._macro.steps:
+            if not isinstance(step, KeySequence):
+                step.execute()
 
-        for event in self._macro_data:
-            if isinstance(event, MacroKey):
-                xte += self.xte_line(event)
-            else:
-                if xte != '':
-                    proc = subprocess.Popen(['xte'], stdin=subprocess.PIPE)
-                    proc.communicate(input=xte.encode('ascii'))
-                    xte = ''
-
-                # Now run everything else (this just allows for less calls to xte
-                if not isinstance(event, MacroKey):
-                    event.execute()
-
-        if xte != '':
-            proc = subprocess.Popen(['xte'], stdin=subprocess.PIPE)
-            proc.communicate(input=xte.encode('ascii'))
+            elif keyboard is not None:
+                try:
+                    self.play_keys(keyboard, step.events)
+                except OSError as err:
+                    self._logger.warning("Failed to write macro keys: %s", err)
+
+            elif step.xte != '':
+                proc = subprocess.Popen(['xte'], stdin=subprocess.PIPE)
+                proc.communicate(input=step.xte.encode('ascii'))
 
         self._logger.debug("Finished running macro %s", self._macro_bind)
 
@@ -3,65 +3,126 @@
 """
 Contains the functions and classes to perform ripple effects
 """
-import datetime
+import bisect
 import logging
 import math
-import threading
+import os
 import time
 
 # pylint: disable=import-error
 from openrazer_daemon.keyboard import KeyboardColour
+from openrazer_daemon.misc.frame_scheduler import get_frame_scheduler
 
 
-class RippleEffectThread(threading.Thread):
+class RippleRenderer(object):
     """
-    Ripple thread.
+    Draws ripples straight into a matrix_custom_frame payload
 
-    This thread contains the run loop which performs all the circle calculations and generating of the binary payload
+    For every ripple origin the distances to all keys are computed once and
+    kept sorted, so drawing a ripple is two bisects for the ring
+    rad - 2 <= distance <= rad plus a slice assignment per lit key.
     """
+    RING_WIDTH = 2
 
-    def __init__(self, parent, device_number):
-        super().__init__()
+    def __init__(self, rows, cols):
+        self._grid = KeyboardColour(rows, cols)
 
-        self._logger = logging.getLogger('razer.device{0}.ripplethread'.format(device_number))
-        self._parent = parent
+        # (row, col, offset of the RGB bytes in the frame)
+        self._cells = []
+        for row in range(0, rows):
+            for col in range(0, cols):
+                self._cells.append((row, col, self._grid.key_offset(row, col)))
 
-        self._colour = (0, 255, 0)
-        self._refresh_rate = 0.040
+        if rows == 6 and cols == 22:
+            # The logo location is physically at (6, 11), logically at (0, 20)
+            self._cells = [cell for cell in self._cells if cell[:2] != (0, 20)]
+            self._cells.append((6, 11, self._grid.key_offset(0, 20)))
 
-        self._shutdown = False
-        self._active = False
+        # (row, col) -> (sorted distances, matching RGB offsets)
+        self._tables = {}
 
-        self._rows, self._cols = self._parent._parent.MATRIX_DIMS
+    def _table(self, origin_row, origin_col):
+        """
+        Get the distance table of a ripple origin, building it on first use
 
-        self._keyboard_grid = KeyboardColour(self._rows, self._cols)
+        :param origin_row: Row of the ripple centre
+        :type origin_row: int
 
-    @property
-    def shutdown(self):
-        """
-        Get the shutdown flag
+        :param origin_col: Column of the ripple centre
+        :type origin_col: int
+
+        :return: Tuple of sorted distances and the RGB offsets of those keys
+        :rtype: tuple
         """
-        return self._shutdown
+        table = self._tables.get((origin_row, origin_col))
+
+        if table is None:
+            distances = sorted((math.hypot(origin_row - row, origin_col - col), offset) for row, col, offset in self._cells)
+            table = ([distance for distance, _ in distances], [offset for _, offset in distances])
+            self._tables[(origin_row, origin_col)] = table
+
+        return table
 
-    @shutdown.setter
-    def shutdown(self, value):
+    def render(self, ripples):
         """
-        Set the shutdown flag
+        Draw a frame
 
-        :param value: Shutdown
-        :type value: bool
+        Where ripples overlap the one earliest in the list wins.
+
+        :param ripples: List of (row, col, radius, colour) tuples
+        :type ripples: list of tuple
+
+        :return: matrix_custom_frame payload, only valid until the next render
+        :rtype: memoryview
         """
-        self._shutdown = value
+        self._grid.reset_rows()
+        frame = self._grid.buffer
+
+        # Draw in reverse so earlier ripples are drawn over later ones
+        for row, col, radius, colour in reversed(ripples):
+            distances, offsets = self._table(row, col)
+            start = bisect.bisect_left(distances, radius - self.RING_WIDTH)
+            end = bisect.bisect_right(distances, radius)
+
+            rgb = bytes(colour)
+            for offset in offsets[start:end]:
+                frame[offset:offset + 3] = rgb
+
+        return self._grid.get_total_binary()
+
+
+class RippleEffect(object):
+    """
+    Ripple effect
+
+    Registers with the frame scheduler while enabled, which asks it for a frame
+    every tick and writes it out together with the other devices' frames
+    """
+    EXPIRE_DIFF = 2.0
+
+    def __init__(self, parent, device_number):
+        self._logger = logging.getLogger('razer.device{0}.rippleeffect'.format(device_number))
+        self._parent = parent
+        self._device_number = device_number
+
+        self._colour = (0, 255, 0)
+        self._refresh_rate = 0.040
+
+        self._frame_client = None
+
+        self._rows, self._cols = self._parent._parent.MATRIX_DIMS
+
+        self._renderer = RippleRenderer(self._rows, self._cols)
 
     @property
     def active(self):
         """
-        Get if the thread is active
+        Get if the effect is active
 
         :return: Active
         :rtype: bool
         """
-        return self._active
+        return self._frame_client is not None
 
     @property
     def key_list(self):
@@ -73,6 +134,20 @@ class RippleEffectThread(threading.Thread):
         """
         return self._parent.key_list
 
+    @property
+    def frame_stats(self):
+        """
+        Get the frame timing counters of the running effect
+
+        :return: Counters, see FrameStats.as_dict, or None if not active
+        :rtype: dict or None
+        """
+        client = self._frame_client
+        if client is None:
+            return None
+
+        return client.stats.as_dict()
+
     def enable(self, colour, refresh_rate):
         """
         Enable the ripple effect
@@ -89,85 +164,45 @@ class RippleEffectThread(threading.Thread):
         else:
             self._colour = colour
         self._refresh_rate = refresh_rate
-        self._active = True
+
+        scheduler = get_frame_scheduler()
+        if self._frame_client is None:
+            self._frame_client = scheduler.register('device{0}.ripple'.format(self._device_number), self.render_frame, refresh_rate, self._parent.write_frame)
+        else:
+            scheduler.set_period(self._frame_client, refresh_rate)
 
     def disable(self):
         """
         Disable the ripple effect
         """
-        self._active = False
-
-    def run(self):
-        """
-        Event loop
-        """
-        # pylint: disable=too-many-nested-blocks,too-many-branches
-        expire_diff = datetime.timedelta(seconds=2)
-
-        # self._parent: RippleManager
-        # self._parent._parent: The device class (e.g. RazerBlackWidowUltimate2013)
-        if self._rows == 6 and self._cols == 22:
-            needslogohandling = True
-            # a virtual 7th row for logo handling
-            self._rows += 1
-        else:
-            needslogohandling = False
-
-        # TODO time execution and then sleep for _refresh_rate - time_taken
-        while not self._shutdown:
-            if self._active:
-                # Clear keyboard
-                self._keyboard_grid.reset_rows()
-
-                now = datetime.datetime.now()
-
-                radiuses = []
+        client, self._frame_client = self._frame_client, None
 
-                for expire_time, (key_row, key_col), colour in self.key_list:
-                    event_time = expire_time - expire_diff
+        if client is not None:
+            get_frame_scheduler().unregister(client)
+            self._logger.debug("Ripple stopped: %s", client.stats.as_dict())
 
-                    now_diff = now - event_time
-
-                    # Current radius is based off a time metric
-                    if self._colour is not None:
-                        colour = self._colour
-                    radiuses.append((key_row, key_col, now_diff.total_seconds() * 24, colour))
+    def render_frame(self):
+        """
+        Render one frame
 
-                # Iterate through the rows
-                for row in range(0, self._rows):
-                    # Iterate through the columns
-                    for col in range(0, self._cols):
-                        # The logo location is physically at (6, 11), logically at (0, 20)
-                        # Skip when we come across the logo location, as the ripple would look wrong
-                        if needslogohandling and row == 0 and col == 20:
-                            continue
+        :return: matrix_custom_frame payload
+        :rtype: memoryview
+        """
+        now = time.monotonic()
 
-                        if needslogohandling and row == 6:
-                            if col != 11:
-                                continue
+        radiuses = []
 
-                            # To account for logo placement
-                            for cirlce_centre_row, circle_centre_col, rad, colour in radiuses:
-                                radius = math.sqrt(math.pow(cirlce_centre_row - row, 2) + math.pow(circle_centre_col - col, 2))
-                                if rad >= radius >= rad - 2:
-                                    # Again, (0, 20) is the logical location of the logo led
-                                    self._keyboard_grid.set_key_colour(0, 20, colour)
-                                    break
-                        else:
-                            for cirlce_centre_row, circle_centre_col, rad, colour in radiuses:
-                                radius = math.sqrt(math.pow(cirlce_centre_row - row, 2) + math.pow(circle_centre_col - col, 2))
-                                if rad >= radius >= rad - 2:
-                                    self._keyboard_grid.set_key_colour(row, col, colour)
-                                    break
+        for expire_time, (key_row, key_col), colour in self.key_list:
+            event_time = expire_time - self.EXPIRE_DIFF
 
-                # Set the colors on the device
-                payload = self._keyboard_grid.get_total_binary()
+            now_diff = now - event_time
 
-                self._parent.set_rgb_matrix(payload)
-                self._parent.refresh_keyboard()
+            # Current radius is based off a time metric
+            if self._colour is not None:
+                colour = self._colour
+            radiuses.append((key_row, key_col, now_diff * 24, colour))
 
-            # Sleep until the next ripple refresh
-            time.sleep(self._refresh_rate)
+        return self._renderer.render(radiuses)
 
 
 class RippleManager(object):
@@ -182,18 +217,22 @@ class RippleManager(object):
 
         self._is_closed = False
 
-        self._ripple_thread = RippleEffectThread(self, device_number)
-        self._ripple_thread.start()
+        # Newer kernel drivers can render the ripple themselves
+        self._driver_effect = os.path.exists(self._parent.get_driver_path('soft_effect'))
+        self._driver_effect_active = False
+        self._driver_keymap_set = False
+
+        self._ripple_effect = RippleEffect(self, device_number)
 
     @property
     def key_list(self):
         """
         Get the list of keys from the key manager
 
-        :return: List of tuples (expire_time, (key_row, key_col), random_colour)
-        :rtype: list of tuple
+        :return: Tuples (expire_time, (key_row, key_col), random_colour)
+        :rtype: tuple of tuple
         """
-        result = []
+        result = ()
         if hasattr(self._parent, 'key_manager'):
             result = self._parent.key_manager.temp_key_store
 
@@ -214,6 +253,70 @@ class RippleManager(object):
         """
         self._parent._set_custom_effect()
 
+    def write_frame(self, payload):
+        """
+        Send a rendered frame and show it
+
+        :param payload: Binary payload
+        :type payload: bytes
+        """
+        self.set_rgb_matrix(payload)
+        self.refresh_keyboard()
+
+    def _set_driver_keymap(self):
+        """
+        Send the matrix size and key positions to the driver effect engine
+        """
+        rows, cols = self._parent.MATRIX_DIMS
+        key_manager = self._parent.key_manager
+        event_map = getattr(key_manager, 'GAMEPAD_EVENT_MAPPING', key_manager.EVENT_MAP)
+        key_map = getattr(key_manager, 'GAMEPAD_KEY_MAPPING', key_manager.KEY_MAP)
+
+        payload = bytearray((rows, cols))
+        for key_code, key_name in event_map.items():
+            if key_name not in key_map:
+                continue
+
+            key_row, key_col = key_map[key_name]
+            if key_row < rows and key_col < cols:
+                payload.extend((key_code >> 8, key_code & 0xFF, key_row, key_col))
+
+        self._parent.write_driver_file(self._parent.get_driver_path('soft_effect_keymap'), payload)
+
+        self._driver_keymap_set = True
+
+    def _set_driver_ripple(self, colour, refresh_rate):
+        """
+        Start the ripple in the driver effect engine
+
+        :param colour: Colour tuple like (0, 255, 255), (None, None, None) for random colours
+        :type colour: tuple
+
+        :param refresh_rate: Refresh rate in seconds
+        :type refresh_rate: float
+        """
+        if not self._driver_keymap_set:
+            self._set_driver_keymap()
+
+        period_ms = max(0, min(255, int(refresh_rate * 1000)))
+        if colour[0] is None:
+            payload = bytes((0x01, period_ms))
+        else:
+            payload = bytes((0x01, colour[0], colour[1], colour[2], period_ms))
+
+        self._parent.write_driver_file(self._parent.get_driver_path('soft_effect'), payload)
+
+        self._driver_effect_active = True
+
+    def _stop_driver_ripple(self):
+        """
+        Stop the ripple in the driver effect engine
+        """
+        if self._driver_effect_active:
+            self._driver_effect_active = False
+
+            self._parent.write_driver_file(self._parent.get_driver_path('soft_effect'), b'\x00')
+
     def notify(self, msg):
         """
         Receive notificatons from the device (we only care about effects)
@@ -231,26 +334,34 @@ class RippleManager(object):
             # Device is the device the msg originated from (could be parent device)
             if msg[2] == 'setRipple':
                 # Get (red, green, blue) tuple (args 3:6), and refreshrate arg 6
-                self._parent.key_manager.temp_key_store_state = True
-                self._ripple_thread.enable(msg[3:6], msg[6])
+                if self._driver_effect:
+                    self._set_driver_ripple(msg[3:6], msg[6])
+                else:
+                    self._parent.key_manager.temp_key_store_state = True
+                    self._ripple_effect.enable(msg[3:6], msg[6])
             else:
                 # Effect other than ripple so stop
-                self._ripple_thread.disable()
+                self._ripple_effect.disable()
+                self._stop_driver_ripple()
 
                 self._parent.key_manager.temp_key_store_state = False
 
     def close(self):
         """
-        Close the manager, stop ripple thread
+        Close the manager, stop ripple effect
         """
         if not self._is_closed:
             self._logger.debug("Closing Ripple Manager")
             self._is_closed = True
 
-            self._ripple_thread.shutdown = True
-            self._ripple_thread.join(timeout=2)
-            if self._ripple_thread.is_alive():
-                self._logger.error("Could not stop RippleEffect thread")
+            self._ripple_effect.disable()
+
+            # Don't leave the driver rippling after the daemon is gone,
+            # the device may already be unplugged
+            try:
+                self._stop_driver_ripple()
+            except OSError as err:
+                self._logger.debug("Failed to stop driver ripple: %s", err)
 
     def __del__(self):
         self.close()
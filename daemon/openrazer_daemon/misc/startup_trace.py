@@ -0,0 +1,85 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+"""
+Times the phases of daemon startup
+
+Enabled with --trace-startup, the daemon then logs how long each phase of
+startup took once it's ready to serve DBus.
+"""
+import contextlib
+import threading
+import time
+
+
+class StartupTrace(object):
+    """
+    Collects the time spent in named phases
+
+    Phases with the same name add up, so per device phases like DBus
+    registration show the total over all devices. Phases can be nested, a
+    phase's time includes the phases inside it.
+    """
+
+    def __init__(self):
+        self.enabled = False
+
+        self._lock = threading.Lock()
+        self._start_time = time.monotonic()
+        # Phase name: [total seconds, count], in the order they were first seen
+        self._phases = {}
+
+    def start(self):
+        """
+        Start tracing from now
+        """
+        with self._lock:
+            self.enabled = True
+            self._start_time = time.monotonic()
+            self._phases.clear()
+
+    @contextlib.contextmanager
+    def phase(self, name):
+        """
+        Time the block as the given phase
+
+        :param name: Phase name
+        :type name: str
+        """
+        if not self.enabled:
+            yield
+            return
+
+        start = time.monotonic()
+        try:
+            yield
+        finally:
+            duration = time.monotonic() - start
+            with self._lock:
+                totals = self._phases.setdefault(name, [0.0, 0])
+                totals[0] += duration
+                totals[1] += 1
+
+    def report(self, logger):
+        """
+        Log the time spent per phase
+
+        :param logger: Logger
+        :type logger: logging.Logger
+        """
+        if not self.enabled:
+            return
+
+        with self._lock:
+            phases = [(name, totals[0], totals[1]) for name, totals in self._phases.items()]
+            total = time.monotonic() - self._start_time
+
+        name_len = max([len(name) for name, _, _ in phases] + [len('total')]) + 2
+        format_str = '{0:-<' + str(name_len) + '} {1:9.2f}ms{2}'
+
+        logger.info("Startup trace:")
+        for name, duration, count in phases:
+            logger.info(format_str.format(name + ' ', duration * 1000, ' ({0}x)'.format(count) if count > 1 else ''))
+        logger.info(format_str.format('total ', total * 1000, ''))
+
+
+TRACE = StartupTrace()
@@ -0,0 +1,116 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+"""
+Cache of device state read through DBus getters
+
+Getters answer from here instead of reading the driver on every call. Values
+the daemon writes are stored when it writes them, values the device can change
+on its own (e.g. DPI buttons, charging) are read again once they're older than
+VOLATILE_TTL.
+"""
+import threading
+import time
+
+# Seconds before a value the device can change on its own is read again
+VOLATILE_TTL = 2.0
+
+
+class DeviceStateCache(object):
+    """
+    Per device cache of getter results
+
+    Values are keyed by the interface and name of the getter they're returned
+    from. on_change is called with the interface, name and new value whenever
+    a stored value changes, so the device can tell clients about it.
+    """
+
+    def __init__(self, on_change=None):
+        self._on_change = on_change
+
+        self._lock = threading.Lock()
+        # (interface, name): [value, expiry time or None, valid]
+        self._values = {}
+
+    def get(self, interface, name, read_func, ttl=None):
+        """
+        Get a value, reading it with read_func if it's not cached or too old
+
+        :param interface: Getter interface
+        :type interface: str
+
+        :param name: Getter name
+        :type name: str
+
+        :param read_func: Reads the value from the driver
+        :type read_func: callable
+
+        :param ttl: Seconds the value stays valid, None until it's updated or invalidated
+        :type ttl: float or None
+
+        :return: Value
+        """
+        key = (interface, name)
+
+        with self._lock:
+            entry = self._values.get(key)
+            if entry is not None and entry[2] and (entry[1] is None or entry[1] > time.monotonic()):
+                return entry[0]
+
+        # Don't hold the lock while talking to the driver
+        value = read_func()
+        self._store(key, value, ttl, notify_new=False)
+
+        return value
+
+    def update(self, interface, name, value, ttl=None):
+        """
+        Store a value the daemon has written to the device
+
+        :param interface: Getter interface
+        :type interface: str
+
+        :param name: Getter name
+        :type name: str
+
+        :param value: Value as returned by the getter
+
+        :param ttl: Seconds the value stays valid, None until it's updated or invalidated
+        :type ttl: float or None
+        """
+        self._store((interface, name), value, ttl, notify_new=True)
+
+    def invalidate(self, interface=None, name=None):
+        """
+        Read values from the driver again on their next get
+
+        :param interface: Getter interface, None for all values
+        :type interface: str or None
+
+        :param name: Getter name, None for all getters of the interface
+        :type name: str or None
+        """
+        with self._lock:
+            for key, entry in self._values.items():
+                if interface is None or (key[0] == interface and (name is None or key[1] == name)):
+                    # Keep the value so the next read can tell if it changed
+                    entry[2] = False
+
+    def _store(self, key, value, ttl, notify_new):
+        """
+        Store a value and report it if it changed
+
+        :param notify_new: Report values that weren't cached before
+        :type notify_new: bool
+        """
+        expiry = None if ttl is None else time.monotonic() + ttl
+
+        with self._lock:
+            entry = self._values.get(key)
+            if entry is None:
+                changed = notify_new
+            else:
+                changed = entry[0] != value
+            self._values[key] = [value, expiry, True]
+
+        if changed and self._on_change is not None:
+            self._on_change(key[0], key[1], value)
@@ -0,0 +1,119 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+"""
+Virtual keyboard used to play macros
+
+Events written to it go through the kernel like those of a real keyboard,
+so they work the same on X11 and Wayland.
+"""
+import fcntl
+import logging
+import os
+import struct
+import threading
+
+UINPUT_PATH = '/dev/uinput'
+
+UI_DEV_CREATE = 0x5501
+UI_DEV_DESTROY = 0x5502
+UI_SET_EVBIT = 0x40045564
+UI_SET_KEYBIT = 0x40045565
+
+EV_SYN = 0x00
+EV_KEY = 0x01
+SYN_REPORT = 0x00
+BUS_VIRTUAL = 0x06
+
+KEY_UP = 0
+KEY_DOWN = 1
+
+# struct input_event, the kernel fills in the time
+INPUT_EVENT = struct.Struct('llHHi')
+# struct uinput_user_dev: name, input_id, ff_effects_max, absmax, absmin, absfuzz, absflat
+UINPUT_USER_DEV = struct.Struct('80sHHHHI256i')
+
+_XTE_WARNED = False
+_XTE_WARNED_LOCK = threading.Lock()
+
+
+def pack_key_event(key_code, value):
+    """
+    Pack a key event followed by a sync report
+
+    :param key_code: Linux key code
+    :type key_code: int
+
+    :param value: KEY_DOWN or KEY_UP
+    :type value: int
+
+    :return: Events ready to be written
+    :rtype: bytes
+    """
+    return INPUT_EVENT.pack(0, 0, EV_KEY, key_code, value) + INPUT_EVENT.pack(0, 0, EV_SYN, SYN_REPORT, 0)
+
+
+def warn_xte_fallback(err):
+    """
+    Log that macros are played with xte instead of uinput, only the first time
+
+    :param err: Error that stopped uinput from being used
+    :type err: Exception
+    """
+    global _XTE_WARNED  # pylint: disable=global-statement
+
+    with _XTE_WARNED_LOCK:
+        if _XTE_WARNED:
+            return
+        _XTE_WARNED = True
+
+    logging.getLogger('razer.macro').warning("Can't use %s for macros, falling back to xte which only works on X11: %s. "
+                                             "The udev rule 70-razer-uinput.rules gives the plugdev group access to it.", UINPUT_PATH, err)
+
+
+class UInputKeyboard(object):
+    """
+    Keyboard created through uinput
+
+    :raises OSError: If uinput isn't available or accessible
+    """
+
+    def __init__(self, name, key_codes, path=UINPUT_PATH):
+        self._lock = threading.Lock()
+        self._fd = os.open(path, os.O_WRONLY | os.O_CLOEXEC)
+
+        try:
+            fcntl.ioctl(self._fd, UI_SET_EVBIT, EV_KEY)
+            fcntl.ioctl(self._fd, UI_SET_EVBIT, EV_SYN)
+            for key_code in sorted(key_codes):
+                fcntl.ioctl(self._fd, UI_SET_KEYBIT, key_code)
+
+            os.write(self._fd, UINPUT_USER_DEV.pack(name.encode('utf-8')[:79], BUS_VIRTUAL, 0, 0, 1, 0, *([0] * 256)))
+            fcntl.ioctl(self._fd, UI_DEV_CREATE)
+        except OSError:
+            os.close(self._fd)
+            raise
+
+    def write(self, events):
+        """
+        Write packed events
+
+        :param events: Events from pack_key_event
+        :type events: bytes
+        """
+        with self._lock:
+            os.write(self._fd, events)
+
+    def close(self):
+        """
+        Remove the keyboard
+        """
+        with self._lock:
+            if self._fd is None:
+                return
+
+            try:
+                fcntl.ioctl(self._fd, UI_DEV_DESTROY)
+            except OSError:
+                pass
+            os.close(self._fd)
+            self._fd = None
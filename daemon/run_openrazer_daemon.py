@@ -53,6 +53,8 @@ def parse_args():
 
     parser.add_argument('--test-dir', type=str, help='Directory containing test driver structure')
 
+    parser.add_argument('--trace-startup', action='store_true', help='Log how long each phase of startup takes')
+
     return parser.parse_args()
 
 
@@ -143,7 +145,8 @@ def run_daemon():
                          console_log=args.foreground,
                          config_file=args.config,
                          persistence_file=args.persistence,
-                         test_dir=args.test_dir)
+                         test_dir=args.test_dir,
+                         trace_startup=args.trace_startup)
     try:
         daemon.run()
     except KeyboardInterrupt:
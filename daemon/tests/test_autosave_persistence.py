@@ -0,0 +1,90 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import logging
+import os
+import shutil
+import tempfile
+import threading
+import unittest
+
+from openrazer_daemon.misc.autosave_persistence import PersistenceAutoSave, PersistenceStatus, write_atomic
+
+
+class WriteAtomicTest(unittest.TestCase):
+    def setUp(self):
+        self.tmp_dir = tempfile.mkdtemp()
+        self.path = os.path.join(self.tmp_dir, 'persistence.conf')
+
+    def tearDown(self):
+        shutil.rmtree(self.tmp_dir)
+
+    def test_replaces_file(self):
+        with open(self.path, 'w') as f:
+            f.write('old')
+        os.chmod(self.path, 0o600)
+
+        write_atomic(self.path, lambda f: f.write('new'))
+
+        with open(self.path) as f:
+            self.assertEqual(f.read(), 'new')
+        self.assertEqual(os.stat(self.path).st_mode & 0o777, 0o600)
+        self.assertEqual(os.listdir(self.tmp_dir), ['persistence.conf'])
+
+    def test_failed_write_keeps_old_file(self):
+        with open(self.path, 'w') as f:
+            f.write('old')
+
+        def fail(f):
+            f.write('partial')
+            raise RuntimeError()
+
+        with self.assertRaises(RuntimeError):
+            write_atomic(self.path, fail)
+
+        with open(self.path) as f:
+            self.assertEqual(f.read(), 'old')
+        self.assertEqual(os.listdir(self.tmp_dir), ['persistence.conf'])
+
+
+class PersistenceAutoSaveTest(unittest.TestCase):
+    def setUp(self):
+        self.status = PersistenceStatus()
+        self.writes = []
+        self.written = threading.Event()
+
+        self.autosave = PersistenceAutoSave('persistence.conf', self.status, logging.getLogger('test'), 0.05, 0.5, self._save)
+        thread = threading.Thread(target=self.autosave.watch, daemon=True)
+        thread.start()
+
+    def _save(self, persistence_file, storage_names):
+        self.writes.append(storage_names)
+        self.written.set()
+
+    def test_changes_coalesced(self):
+        for _ in range(5):
+            self.status.mark_changed('BlackWidow')
+        self.status.mark_changed('Mamba')
+
+        self.assertTrue(self.written.wait(1))
+        self.assertEqual(self.writes, [{'BlackWidow', 'Mamba'}])
+
+    def test_constant_changes_written_by_max_delay(self):
+        stop = threading.Event()
+
+        def slider():
+            while not stop.wait(0.01):
+                self.status.mark_changed('BlackWidow')
+
+        thread = threading.Thread(target=slider)
+        thread.start()
+        try:
+            self.assertTrue(self.written.wait(2))
+        finally:
+            stop.set()
+            thread.join()
+
+        self.assertEqual(self.writes[0], {'BlackWidow'})
+
+
+if __name__ == '__main__':
+    unittest.main()
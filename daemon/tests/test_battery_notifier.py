@@ -0,0 +1,113 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import threading
+import time
+import unittest
+import unittest.mock
+
+import openrazer_daemon.misc.battery_notifier
+from openrazer_daemon.misc.battery_notifier import BatteryManager, BatteryScheduler
+from openrazer_daemon.misc.io_worker import DeviceIOWorker
+
+
+class DummyBatteryDevice(object):
+    def __init__(self, readings):
+        self.readings = list(readings)
+        self.read_count = 0
+        self.done = threading.Event()
+        self.io_worker = DeviceIOWorker(1)
+        self.io_worker.start()
+
+    def getBattery(self):
+        self.read_count += 1
+        if len(self.readings) == 1:
+            self.done.set()
+            return self.readings[0]
+        return self.readings.pop(0)
+
+
+def wait_for(predicate, timeout=1.0):
+    deadline = time.monotonic() + timeout
+    while not predicate():
+        if time.monotonic() > deadline:
+            return False
+        time.sleep(0.01)
+    return True
+
+
+class BatteryManagerTest(unittest.TestCase):
+    def setUp(self):
+        self.scheduler = BatteryScheduler()
+        self.scheduler.start()
+        self.managers = []
+
+    def tearDown(self):
+        for manager, device in self.managers:
+            manager.close()
+            device.io_worker.stop()
+        self.scheduler.stop()
+
+    def _make_manager(self, readings, frequency=600, percent=33, active=True):
+        device = DummyBatteryDevice(readings)
+        manager = BatteryManager(device, 1, 'Test Device', scheduler=self.scheduler)
+        manager.show_notification = unittest.mock.MagicMock()
+        manager.percent = percent
+        manager.active = active
+        manager.frequency = frequency
+
+        self.managers.append((manager, device))
+        return manager, device
+
+    def test_read_on_activation(self):
+        manager, device = self._make_manager([20.0])
+
+        self.assertTrue(wait_for(lambda: manager.show_notification.called))
+
+        self.assertEqual(device.read_count, 1)
+        self.assertEqual(manager.show_notification.call_count, 1)
+        self.assertEqual(manager.show_notification.call_args[1]['icon'], 'battery-low')
+
+    def test_no_notification_above_percent(self):
+        manager, device = self._make_manager([80.0])
+
+        self.assertTrue(wait_for(lambda: manager._last_notify_time is not None))
+
+        self.assertFalse(manager.show_notification.called)
+
+    def test_frequency(self):
+        manager, device = self._make_manager([20.0, 20.0, 20.0], frequency=0.05)
+
+        self.assertTrue(device.done.wait(1))
+        self.assertGreaterEqual(device.read_count, 3)
+
+    @unittest.mock.patch('openrazer_daemon.misc.battery_notifier.BOGUS_RETRY_DELAY', 0.05)
+    def test_bogus_retry(self):
+        manager, device = self._make_manager([0.0, -1.0, 20.0])
+
+        self.assertTrue(wait_for(lambda: manager.show_notification.called))
+
+        self.assertEqual(device.read_count, 3)
+        # Bogus values don't notify
+        self.assertEqual(manager.show_notification.call_count, 1)
+
+    def test_inactive(self):
+        manager, device = self._make_manager([20.0], frequency=0.01, active=False)
+
+        self.assertFalse(device.done.wait(0.1))
+        self.assertEqual(device.read_count, 0)
+
+    def test_shared_scheduler(self):
+        devices = [self._make_manager([20.0, 20.0], frequency=0.05)[1] for _ in range(5)]
+
+        for device in devices:
+            self.assertTrue(device.done.wait(1))
+
+    def test_global_scheduler(self):
+        scheduler = openrazer_daemon.misc.battery_notifier.get_battery_scheduler()
+
+        self.assertIs(scheduler, openrazer_daemon.misc.battery_notifier.get_battery_scheduler())
+        self.assertTrue(scheduler.is_alive())
+
+        openrazer_daemon.misc.battery_notifier.stop_battery_scheduler()
+
+        self.assertFalse(scheduler.is_alive())
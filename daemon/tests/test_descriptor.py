@@ -0,0 +1,130 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import unittest
+import unittest.mock
+
+try:
+    import dbus
+    from openrazer_daemon.hardware.device_base import RazerDevice
+except ImportError:
+    RazerDevice = None
+
+try:
+    from openrazer.client.devices import get_descriptor as client_get_descriptor
+except ImportError:
+    client_get_descriptor = None
+
+
+class DummyDevice(object):
+    HAS_MATRIX = True
+    MATRIX_DIMS = [6, 22]
+    DEDICATED_MACRO_KEYS = True
+    DEVICE_IMAGE = 'https://example.com/keyboard.png'
+    USB_VID = 0x1532
+    USB_PID = 0x0203
+
+    def __init__(self, methods):
+        self._descriptor = None
+        self._methods = methods
+        self.driver_reads = 0
+
+    def get_dbus_methods(self):
+        return self._methods
+
+    def get_serial(self):
+        return 'XX0000000001'
+
+    def get_vid_pid(self):
+        return [self.USB_VID, self.USB_PID]
+
+    def getDeviceName(self):
+        self.driver_reads += 1
+        return 'Razer BlackWidow Chroma'
+
+    def getDeviceType(self):
+        return 'keyboard'
+
+    def getFirmware(self):
+        self.driver_reads += 1
+        return 'v1.0'
+
+    def getDriverVersion(self):
+        return '3.9.0'
+
+    def getKeyboardLayout(self):
+        self.driver_reads += 1
+        return 'en_US'
+
+
+@unittest.skipIf(RazerDevice is None, "needs dbus and gi")
+class DescriptorTest(unittest.TestCase):
+    def test_keyboard(self):
+        device = DummyDevice({
+            'razer.device.misc': ['getDeviceType', 'getKeyboardLayout'],
+            'razer.device.lighting.chroma': ['setCustom', 'setKeyRow'],
+        })
+
+        descriptor = RazerDevice.get_descriptor(device)
+
+        self.assertEqual(dict(descriptor), {
+            'serial': 'XX0000000001',
+            'name': 'Razer BlackWidow Chroma',
+            'type': 'keyboard',
+            'firmware_version': 'v1.0',
+            'driver_version': '3.9.0',
+            'vid_pid': [0x1532, 0x0203],
+            'has_matrix': True,
+            'matrix_dims': [6, 22],
+            'dedicated_macro_keys': True,
+            'device_image': 'https://example.com/keyboard.png',
+            'methods': {
+                'razer.device.misc': ['getDeviceType', 'getKeyboardLayout'],
+                'razer.device.lighting.chroma': ['setCustom', 'setKeyRow'],
+            },
+            'keyboard_layout': 'en_US',
+        })
+        self.assertEqual(descriptor.signature, 'sv')
+
+    def test_without_optional_getters(self):
+        device = DummyDevice({'razer.device.dpi': ['getDPI']})
+        device.HAS_MATRIX = False
+        device.DEVICE_IMAGE = None
+
+        descriptor = RazerDevice.get_descriptor(device)
+
+        self.assertEqual(descriptor['type'], 'unknown')
+        self.assertEqual(list(descriptor['matrix_dims']), [])
+        self.assertEqual(descriptor['device_image'], '')
+        self.assertNotIn('keyboard_layout', descriptor)
+
+    def test_driver_read_once(self):
+        device = DummyDevice({'razer.device.misc': ['getKeyboardLayout']})
+
+        first = RazerDevice.get_descriptor(device)
+        reads = device.driver_reads
+        self.assertIs(RazerDevice.get_descriptor(device), first)
+        self.assertEqual(device.driver_reads, reads)
+
+
+@unittest.skipIf(client_get_descriptor is None, "needs dbus and the openrazer client")
+class ClientDescriptorTest(unittest.TestCase):
+    def test_descriptor(self):
+        device_dbus = unittest.mock.Mock()
+        device_dbus.getDescriptor.return_value = {'serial': 'XX0000000001'}
+
+        self.assertEqual(client_get_descriptor(device_dbus), {'serial': 'XX0000000001'})
+
+    def test_older_daemon(self):
+        device_dbus = unittest.mock.Mock()
+        device_dbus.getDescriptor.side_effect = dbus.exceptions.DBusException(
+            "No such method 'getDescriptor'", name='org.freedesktop.DBus.Error.UnknownMethod')
+
+        self.assertIsNone(client_get_descriptor(device_dbus))
+
+    def test_other_errors_are_raised(self):
+        device_dbus = unittest.mock.Mock()
+        device_dbus.getDescriptor.side_effect = dbus.exceptions.DBusException(
+            "Device busy", name='org.freedesktop.DBus.Python.openrazer_daemon.misc.io_worker.DeviceBusyError')
+
+        with self.assertRaises(dbus.exceptions.DBusException):
+            client_get_descriptor(device_dbus)
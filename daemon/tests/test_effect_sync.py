@@ -1,9 +1,12 @@
 # SPDX-License-Identifier: GPL-2.0-or-later
 
+import threading
+import time
 import unittest
 import unittest.mock
 
 import openrazer_daemon.misc.effect_sync
+from openrazer_daemon.misc.io_worker import DeviceIOWorker
 
 # msg type = effect, arg = orig_device, arg = effect_name, arg.. = arg..
 MSG1 = ('effect', None, 'setBrightness', 255)
@@ -62,6 +65,25 @@ class DummyHardwareBlackWidowChroma(DummyHardwareDevice):
         self.effect_call = ('setBreathSingle', red, green, blue)
 
 
+class DummyWorkerDevice(DummyHardwareDevice):
+    """
+    Device with an I/O worker whose effects take a while like wireless ones
+    """
+
+    def __init__(self, number, delay):
+        super().__init__()
+        self.delay = delay
+        self.call_time = None
+        self.done = threading.Event()
+        self.io_worker = DeviceIOWorker(number)
+        self.io_worker.start()
+
+    def setSpectrum(self, reply_handler=None, error_handler=None):
+        self.call_time = time.monotonic()
+        time.sleep(self.delay)
+        self.done.set()
+
+
 class EffectSyncTest(unittest.TestCase):
     @unittest.mock.patch('openrazer_daemon.misc.effect_sync.logging.getLogger', logger_mock)
     def setUp(self):
@@ -85,6 +107,13 @@ class EffectSyncTest(unittest.TestCase):
 
         self.assertEqual(num_args, 2)
 
+        # Reply and error handlers of worker methods don't count
+        def func_worker(x, reply_handler=None, error_handler=None): return x
+
+        num_args = self.effect_sync.get_num_arguments(func_worker)
+
+        self.assertEqual(num_args, 1)
+
     def test_notify_invalid_message(self):
         self.effect_sync.notify("test")
 
@@ -158,3 +187,60 @@ class EffectSyncTest(unittest.TestCase):
 
         # Logger should have called .exception
         self.assertTrue(self.effect_sync._logger.exception.called)
+
+
+class EffectFanOutTest(unittest.TestCase):
+    @unittest.mock.patch('openrazer_daemon.misc.effect_sync.logging.getLogger', logger_mock)
+    def setUp(self):
+        self.devices = [DummyWorkerDevice(number, 0.2) for number in range(4)]
+        self.syncs = [openrazer_daemon.misc.effect_sync.EffectSync(device, number) for number, device in enumerate(self.devices)]
+
+    def tearDown(self):
+        for device in self.devices:
+            device.io_worker.stop()
+
+    def _wait_all(self):
+        for device in self.devices:
+            self.assertTrue(device.done.wait(2))
+
+    def test_fan_out_parallel(self):
+        start = time.monotonic()
+
+        with openrazer_daemon.misc.effect_sync.fan_out():
+            for effect_sync in self.syncs:
+                effect_sync.notify(('effect', None, 'setSpectrum'))
+
+        # Dispatching doesn't wait for the devices
+        self.assertLess(time.monotonic() - start, 0.1)
+
+        self._wait_all()
+
+        # Took about max(latency), not sum(latency)
+        self.assertLess(time.monotonic() - start, 0.6)
+
+    def test_fan_out_barrier(self):
+        # One device is still busy with an earlier call
+        self.devices[0].io_worker.submit(time.sleep, (0.3,), lambda result: None, lambda err: None)
+
+        with openrazer_daemon.misc.effect_sync.fan_out(barrier=True):
+            for effect_sync in self.syncs:
+                effect_sync.notify(('effect', None, 'setSpectrum'))
+
+        self._wait_all()
+
+        call_times = [device.call_time for device in self.devices]
+        self.assertLess(max(call_times) - min(call_times), 0.1)
+
+    def test_fan_out_barrier_busy_device(self):
+        # A full queue must not leave the other devices waiting at the barrier
+        self.devices[0].io_worker.submit = lambda func, args, reply_cb, error_cb: error_cb(Exception("busy"))
+        self.devices[0].done.set()
+
+        start = time.monotonic()
+        with openrazer_daemon.misc.effect_sync.fan_out(barrier=True):
+            for effect_sync in self.syncs:
+                effect_sync.notify(('effect', None, 'setSpectrum'))
+
+        self._wait_all()
+
+        self.assertLess(time.monotonic() - start, openrazer_daemon.misc.effect_sync.SYNC_BARRIER_TIMEOUT)
@@ -0,0 +1,88 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import errno
+import json
+import os
+import random
+import shutil
+import tempfile
+import time
+import unittest
+
+from openrazer_daemon.misc.fake_latency import LATENCY_FILE, FakeLatency, count_frame_rows
+
+
+def make_profile(**overrides):
+    profile = {
+        'wait_min_us': 0,
+        'wait_max_us': 0,
+        'busy_probability': 0.0,
+        'failure_probability': 0.0,
+        'charge_drift_s': 0,
+        'files': {},
+    }
+    profile.update(overrides)
+    return profile
+
+
+class FakeLatencyTest(unittest.TestCase):
+    def setUp(self):
+        self.tmp_dir = tempfile.mkdtemp()
+
+    def tearDown(self):
+        shutil.rmtree(self.tmp_dir)
+
+    def test_load(self):
+        self.assertIsNone(FakeLatency.load(self.tmp_dir))
+
+        with open(os.path.join(self.tmp_dir, LATENCY_FILE), 'w') as latency_file:
+            json.dump(make_profile(), latency_file)
+
+        self.assertIsInstance(FakeLatency.load(self.tmp_dir), FakeLatency)
+
+    def test_count_frame_rows(self):
+        # Row 0 and 1, columns 0 to 2
+        frame = bytes([0, 0, 2] + [255] * 9 + [1, 0, 2] + [0] * 9)
+
+        self.assertEqual(count_frame_rows(frame), 2)
+        self.assertEqual(count_frame_rows(b''), 1)
+
+    def test_wait(self):
+        latency = FakeLatency(make_profile(wait_min_us=20000, wait_max_us=20000, files={'dpi': {'wait_min_us': 0, 'wait_max_us': 0}}))
+
+        start = time.monotonic()
+        latency.before_read('charge_level')
+        self.assertGreaterEqual(time.monotonic() - start, 0.02)
+
+        # One report per row
+        start = time.monotonic()
+        latency.before_write('matrix_custom_frame', bytes([0, 0, 0, 1, 2, 3, 1, 0, 0, 1, 2, 3]))
+        self.assertGreaterEqual(time.monotonic() - start, 0.04)
+
+        start = time.monotonic()
+        latency.before_write('dpi', b'800:800')
+        self.assertLess(time.monotonic() - start, 0.01)
+
+    def test_busy_and_failure(self):
+        latency = FakeLatency(make_profile(wait_min_us=1000, wait_max_us=1000, busy_probability=0.5, failure_probability=0.5), random.Random(1))
+
+        failures = 0
+        start = time.monotonic()
+        for _ in range(20):
+            try:
+                latency.before_read('dpi')
+            except OSError as err:
+                self.assertEqual(err.errno, errno.EIO)
+                failures += 1
+
+        self.assertGreater(failures, 0)
+        self.assertLess(failures, 20)
+        # Busy reports are sent again
+        self.assertGreater(time.monotonic() - start, 0.025)
+
+    def test_charge_drift(self):
+        latency = FakeLatency(make_profile(charge_drift_s=0.01))
+        time.sleep(0.05)
+
+        self.assertLess(int(latency.after_read('charge_level', b'255\n')), 255)
+        self.assertEqual(latency.after_read('dpi', b'800:800'), b'800:800')
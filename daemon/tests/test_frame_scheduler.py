@@ -0,0 +1,88 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import threading
+import time
+import unittest
+
+from openrazer_daemon.misc.frame_scheduler import FrameScheduler
+
+
+class FrameSchedulerTest(unittest.TestCase):
+    def setUp(self):
+        self.scheduler = FrameScheduler()
+        self.scheduler.start()
+
+    def tearDown(self):
+        self.scheduler.stop()
+
+    def test_frames_on_deadlines(self):
+        times = []
+        done = threading.Event()
+
+        def callback():
+            times.append(time.monotonic())
+            # Slow frames must not stretch the period
+            time.sleep(0.005)
+            if len(times) == 6:
+                done.set()
+
+        client = self.scheduler.register('test', callback, 0.02)
+        self.assertTrue(done.wait(2))
+        self.scheduler.unregister(client)
+
+        # 5 periods from the first frame, not 5 * (period + render time)
+        self.assertLess(times[5] - times[0], 0.02 * 5 + 0.015)
+        self.assertEqual(client.stats.dropped, 0)
+        self.assertGreaterEqual(client.stats.frames, 6)
+
+    def test_slow_frames_are_dropped(self):
+        done = threading.Event()
+        calls = []
+
+        def callback():
+            calls.append(None)
+            if len(calls) == 1:
+                time.sleep(0.055)
+            else:
+                done.set()
+
+        client = self.scheduler.register('test', callback, 0.01)
+        self.assertTrue(done.wait(2))
+        self.scheduler.unregister(client)
+
+        # The 5 frames missed during the slow one are skipped, not caught up
+        self.assertGreaterEqual(client.stats.dropped, 5)
+
+    def test_unregister_stops_frames(self):
+        calls = []
+
+        client = self.scheduler.register('test', lambda: calls.append(None), 0.01)
+        time.sleep(0.05)
+        self.scheduler.unregister(client)
+        count = len(calls)
+        time.sleep(0.05)
+
+        self.assertGreater(count, 0)
+        self.assertLessEqual(len(calls), count + 1)
+
+    def test_shared_tick_batches_writes(self):
+        events = []
+        done = threading.Event()
+
+        def render(name):
+            events.append(('render', name, time.monotonic()))
+            return name
+
+        def write(frame):
+            events.append(('write', frame, time.monotonic()))
+            if len(events) >= 8:
+                done.set()
+
+        first = self.scheduler.register('first', lambda: render('a'), 0.02, write)
+        second = self.scheduler.register('second', lambda: render('b'), 0.02, write)
+        self.assertTrue(done.wait(2))
+        self.scheduler.unregister(first)
+        self.scheduler.unregister(second)
+
+        # Both effects render on the same tick before either frame is written
+        self.assertEqual([event[:2] for event in events[:4]], [('render', 'a'), ('render', 'b'), ('write', 'a'), ('write', 'b')])
@@ -0,0 +1,203 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import fcntl
+import mmap
+import os
+import unittest
+import unittest.mock
+
+from openrazer_daemon.misc.framebuffer import MAX_FRAMEBUFFERS, FramebufferNotFoundError, FramebufferStore
+
+try:
+    import dbus
+    from openrazer.client.fx import RazerAdvancedFX
+except ImportError:
+    RazerAdvancedFX = None
+
+# One 6x22 keyboard frame in matrix_custom_frame format
+FRAME_SIZE = 6 * (3 + 22 * 3)
+
+
+class FramebufferStoreTest(unittest.TestCase):
+    def setUp(self):
+        self.store = FramebufferStore(FRAME_SIZE)
+
+    def tearDown(self):
+        self.store.close()
+
+    def map(self, fd):
+        try:
+            return mmap.mmap(fd, os.fstat(fd).st_size)
+        finally:
+            os.close(fd)
+
+    def test_create_is_sealed(self):
+        fd, framebuffer_id = self.store.create()
+        try:
+            self.assertEqual(os.fstat(fd).st_size, FRAME_SIZE)
+
+            seals = fcntl.fcntl(fd, fcntl.F_GET_SEALS)
+            self.assertEqual(seals, fcntl.F_SEAL_SHRINK | fcntl.F_SEAL_GROW | fcntl.F_SEAL_SEAL)
+
+            with self.assertRaises(OSError):
+                os.ftruncate(fd, 1)
+            with self.assertRaises(OSError):
+                fcntl.fcntl(fd, fcntl.F_ADD_SEALS, fcntl.F_SEAL_WRITE)
+        finally:
+            os.close(fd)
+
+    def test_read_sees_client_frame(self):
+        fd, framebuffer_id = self.store.create()
+        framebuffer = self.map(fd)
+
+        framebuffer[:3] = b'\x00\x00\x15'
+        self.assertEqual(self.store.read(framebuffer_id, 3), b'\x00\x00\x15')
+
+        # Reads are copies, drawing the next frame doesn't change them
+        frame = self.store.read(framebuffer_id, FRAME_SIZE)
+        framebuffer[:3] = b'\x01\x02\x03'
+        self.assertEqual(frame[:3], b'\x00\x00\x15')
+
+        framebuffer.close()
+
+    def test_clients_get_own_framebuffer(self):
+        fd_1, framebuffer_id_1 = self.store.create()
+        fd_2, framebuffer_id_2 = self.store.create()
+        framebuffer_1 = self.map(fd_1)
+        framebuffer_2 = self.map(fd_2)
+
+        self.assertNotEqual(framebuffer_id_1, framebuffer_id_2)
+        framebuffer_1[:1] = b'\x01'
+        framebuffer_2[:1] = b'\x02'
+        self.assertEqual(self.store.read(framebuffer_id_1, 1), b'\x01')
+        self.assertEqual(self.store.read(framebuffer_id_2, 1), b'\x02')
+
+        framebuffer_1.close()
+        framebuffer_2.close()
+
+    def test_read_length_out_of_range(self):
+        fd, framebuffer_id = self.store.create()
+        os.close(fd)
+
+        for length in (0, FRAME_SIZE + 1):
+            with self.assertRaises(ValueError) as ctx:
+                self.store.read(framebuffer_id, length)
+            self.assertNotIsInstance(ctx.exception, FramebufferNotFoundError)
+
+    def test_eviction(self):
+        framebuffer_ids = []
+        for _ in range(MAX_FRAMEBUFFERS + 2):
+            fd, framebuffer_id = self.store.create()
+            os.close(fd)
+            framebuffer_ids.append(framebuffer_id)
+
+        # The two oldest are gone, the rest still work
+        for framebuffer_id in framebuffer_ids[:2]:
+            with self.assertRaises(FramebufferNotFoundError):
+                self.store.read(framebuffer_id, FRAME_SIZE)
+        for framebuffer_id in framebuffer_ids[2:]:
+            self.assertEqual(self.store.read(framebuffer_id, FRAME_SIZE), bytes(FRAME_SIZE))
+
+    def test_commit_to_evicted_id(self):
+        fd, framebuffer_id = self.store.create()
+        framebuffer = self.map(fd)
+        for _ in range(MAX_FRAMEBUFFERS):
+            new_fd, _ = self.store.create()
+            os.close(new_fd)
+
+        # The client keeps its mapping but has to get a new framebuffer
+        framebuffer[:1] = b'\x01'
+        with self.assertRaises(FramebufferNotFoundError) as ctx:
+            self.store.read(framebuffer_id, 1)
+        self.assertEqual(ctx.exception._dbus_error_name, 'org.razer.Error.FramebufferNotFound')
+
+        framebuffer.close()
+
+    def test_close(self):
+        fd, framebuffer_id = self.store.create()
+        os.close(fd)
+
+        self.store.close()
+        with self.assertRaises(FramebufferNotFoundError):
+            self.store.read(framebuffer_id, 1)
+
+
+class DummyUnixFd(object):
+    def __init__(self, fd):
+        self._fd = fd
+
+    def take(self):
+        return self._fd
+
+
+@unittest.skipIf(RazerAdvancedFX is None, "needs dbus and the openrazer client")
+class FramebufferClientTest(unittest.TestCase):
+    def setUp(self):
+        self.store = FramebufferStore(FRAME_SIZE)
+
+        self.lighting_dbus = unittest.mock.Mock()
+        self.lighting_dbus.getFramebuffer.side_effect = self.get_framebuffer
+        self.lighting_dbus.commitFramebuffer.side_effect = self.commit_framebuffer
+        self.frames = []
+
+        # Skip __init__, it connects to the daemon
+        self.fx = RazerAdvancedFX.__new__(RazerAdvancedFX)
+        self.fx._lighting_dbus = self.lighting_dbus
+        self.fx._framebuffer = None
+        self.fx._framebuffer_id = None
+
+    def tearDown(self):
+        self.store.close()
+
+    def get_framebuffer(self):
+        fd, framebuffer_id = self.store.create()
+        return DummyUnixFd(fd), framebuffer_id
+
+    def commit_framebuffer(self, framebuffer_id, length):
+        try:
+            self.frames.append(self.store.read(framebuffer_id, length))
+        except FramebufferNotFoundError as err:
+            raise dbus.exceptions.DBusException(str(err), name=err._dbus_error_name)
+
+    def test_draw_through_framebuffer(self):
+        self.fx._draw(b'\x00\x00\x01\x01\x02\x03')
+
+        self.assertEqual(self.frames, [b'\x00\x00\x01\x01\x02\x03'])
+        self.lighting_dbus.setKeyRow.assert_not_called()
+        self.lighting_dbus.setCustom.assert_not_called()
+
+    def test_evicted_framebuffer_is_replaced(self):
+        self.fx._draw(b'\x00\x00\x00\x01\x01\x01')
+        self.store.close()
+        self.fx._draw(b'\x00\x00\x00\x02\x02\x02')
+
+        self.assertEqual(self.frames, [b'\x00\x00\x00\x01\x01\x01', b'\x00\x00\x00\x02\x02\x02'])
+        self.assertEqual(self.lighting_dbus.getFramebuffer.call_count, 2)
+        self.lighting_dbus.setKeyRow.assert_not_called()
+
+    def test_older_daemon_falls_back_to_set_key_row(self):
+        self.lighting_dbus.getFramebuffer.side_effect = dbus.exceptions.DBusException(
+            "No such method 'getFramebuffer'", name='org.freedesktop.DBus.Error.UnknownMethod')
+
+        self.fx._draw(b'\x00\x00\x00\x01\x01\x01')
+        self.fx._draw(b'\x00\x00\x00\x02\x02\x02')
+
+        self.assertEqual(self.lighting_dbus.setKeyRow.call_args_list,
+                         [unittest.mock.call(b'\x00\x00\x00\x01\x01\x01'), unittest.mock.call(b'\x00\x00\x00\x02\x02\x02')])
+        self.assertEqual(self.lighting_dbus.setCustom.call_count, 2)
+        # Only asked once
+        self.assertEqual(self.lighting_dbus.getFramebuffer.call_count, 1)
+
+    def test_other_errors_are_raised(self):
+        self.lighting_dbus.getFramebuffer.side_effect = dbus.exceptions.DBusException(
+            "Device busy", name='org.freedesktop.DBus.Python.openrazer_daemon.misc.io_worker.DeviceBusyError')
+        with self.assertRaises(dbus.exceptions.DBusException):
+            self.fx._draw(b'\x00\x00\x00\x01\x01\x01')
+        self.lighting_dbus.setKeyRow.assert_not_called()
+
+        self.lighting_dbus.getFramebuffer.side_effect = self.get_framebuffer
+        self.lighting_dbus.commitFramebuffer.side_effect = dbus.exceptions.DBusException(
+            "Frame length 7 out of range", name='org.freedesktop.DBus.Python.ValueError')
+        with self.assertRaises(dbus.exceptions.DBusException):
+            self.fx._draw(b'\x00\x00\x00\x01\x01\x01')
+        self.lighting_dbus.setKeyRow.assert_not_called()
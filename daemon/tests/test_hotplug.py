@@ -0,0 +1,164 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import os
+import re
+import shutil
+import tempfile
+import threading
+import time
+import unittest
+
+from openrazer_daemon.misc.hotplug import HotplugSettler
+
+
+class FakeUdevDevice(object):
+    def __init__(self, sys_path, subsystem, device_type=None, parent=None, attributes=None):
+        self.sys_path = sys_path
+        self.sys_name = os.path.basename(sys_path)
+        self.subsystem = subsystem
+        self.device_type = device_type
+        self.parent = parent
+        self.attributes = attributes or {}
+        self.children = []
+
+    def find_parent(self, subsystem, device_type):
+        parent = self.parent
+        while parent is not None:
+            if parent.subsystem == subsystem and parent.device_type == device_type:
+                return parent
+            parent = parent.parent
+        raise LookupError()
+
+
+class FakeDeviceClass(object):
+    EVENT_FILE_REGEX = re.compile(r'.*Razer_Test-event-kbd')
+
+    @classmethod
+    def match(cls, device_id, dev_path):
+        return device_id.startswith('0003:1532:0203') and 'device_type' in os.listdir(dev_path)
+
+
+class HotplugSettlerTest(unittest.TestCase):
+    def setUp(self):
+        # sysfs paths are compared after resolving links
+        self.tmp_dir = os.path.realpath(tempfile.mkdtemp())
+        self.event_dir = os.path.join(self.tmp_dir, 'by-id')
+        self.dev_input_dir = os.path.join(self.tmp_dir, 'dev-input')
+        self.sys_input_dir = os.path.join(self.tmp_dir, 'sys-class-input')
+        for path in (self.event_dir, self.dev_input_dir, self.sys_input_dir):
+            os.mkdir(path)
+
+        self.usb_device = FakeUdevDevice(os.path.join(self.tmp_dir, '1-1'), 'usb', 'usb_device')
+        self.interfaces = []
+        for i in range(2):
+            interface = FakeUdevDevice(os.path.join(self.tmp_dir, '1-1', '1-1:1.{0}'.format(i)), 'usb', 'usb_interface', self.usb_device, {'bInterfaceClass': b'03'})
+            self.interfaces.append(interface)
+            self.usb_device.children.append(interface)
+
+        self.added = []
+        self.added_event = threading.Event()
+        self.find_class = self._find_class
+        self.settler = HotplugSettler(lambda device_id, dev_path: self.find_class(device_id, dev_path), self._callback, {0x1532},
+                                      timeout=0.5, poll_interval=0.005, event_file_dir=self.event_dir, sys_input_dir=self.sys_input_dir)
+        self.settler.start()
+
+    def tearDown(self):
+        self.settler.stop()
+        shutil.rmtree(self.tmp_dir)
+
+    @staticmethod
+    def _find_class(device_id, dev_path):
+        return FakeDeviceClass if FakeDeviceClass.match(device_id, dev_path) else None
+
+    def _callback(self, devices):
+        self.added.append(sorted(device.sys_name for device in devices))
+        self.added_event.set()
+
+    def _bind(self, index, control=False, usb_id='1532:0203'):
+        sys_path = os.path.join(self.interfaces[index].sys_path, '0003:{0}.000{1}'.format(usb_id.upper(), index + 1))
+        os.makedirs(sys_path)
+        if control:
+            open(os.path.join(sys_path, 'device_type'), 'w').close()
+
+        device = FakeUdevDevice(sys_path, 'hid', parent=self.interfaces[index])
+        self.usb_device.children.append(device)
+        return device
+
+    def _add_event_file(self, name, event_name, hid_path):
+        """
+        Create the input device below hid_path and its /dev/input/by-id/ link
+        """
+        input_path = os.path.join(hid_path, 'input', 'input' + event_name[5:], event_name)
+        os.makedirs(input_path)
+        os.symlink(input_path, os.path.join(self.sys_input_dir, event_name))
+
+        open(os.path.join(self.dev_input_dir, event_name), 'w').close()
+        os.symlink(os.path.join('..', 'dev-input', event_name), os.path.join(self.event_dir, name))
+
+    def test_adds_when_settled(self):
+        start = time.monotonic()
+        self.settler.add(self._bind(0, control=True))
+
+        # Second interface and event file still missing
+        self.assertFalse(self.added_event.wait(0.05))
+
+        self._bind(1)
+        self.assertFalse(self.added_event.wait(0.05))
+
+        self._add_event_file('usb-Razer_Razer_Test-event-kbd', 'event3', self.interfaces[0].sys_path + '/0003:1532:0203.0001')
+        self.settler.wake()
+
+        self.assertTrue(self.added_event.wait(1))
+        self.assertLess(time.monotonic() - start, 0.4)
+        # Interfaces without an event of their own are included
+        self.assertEqual(self.added, [['0003:1532:0203.0001', '0003:1532:0203.0002']])
+
+    def test_adds_on_timeout(self):
+        start = time.monotonic()
+        self.settler.add(self._bind(0, control=True))
+
+        self.assertTrue(self.added_event.wait(2))
+        self.assertGreaterEqual(time.monotonic() - start, 0.5)
+        self.assertEqual(self.added, [['0003:1532:0203.0001']])
+
+    def test_other_devices_event_files_ignored(self):
+        # Another keyboard of the same model has its event file already
+        other_path = os.path.join(self.tmp_dir, '1-2', '1-2:1.0', '0003:1532:0203.0003')
+        self._add_event_file('usb-Razer_Razer_Test-event-kbd', 'event7', other_path)
+
+        start = time.monotonic()
+        self.settler.add(self._bind(0, control=True))
+        self._bind(1)
+        self.settler.wake()
+
+        self.assertTrue(self.added_event.wait(2))
+        self.assertGreaterEqual(time.monotonic() - start, 0.5)
+
+    def test_other_vendors_ignored(self):
+        self.settler.add(self._bind(0, control=True, usb_id='046d:c52b'))
+
+        # Not even added on timeout
+        self.assertFalse(self.added_event.wait(0.6))
+
+    def test_find_class_errors(self):
+        def find_class(device_id, dev_path):
+            raise KeyError(device_id)
+
+        self.find_class = find_class
+        self._bind(1)
+        self.settler.add(self._bind(0, control=True))
+
+        # Handed on straight away and the settler keeps running
+        self.assertTrue(self.added_event.wait(0.3))
+        self.assertTrue(self.settler.is_alive())
+
+    def test_removed_before_settled(self):
+        device = self._bind(0, control=True)
+        self.settler.add(device)
+        self.settler.remove(device)
+
+        self.assertFalse(self.added_event.wait(0.6))
+
+
+if __name__ == '__main__':
+    unittest.main()
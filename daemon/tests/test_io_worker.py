@@ -0,0 +1,112 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import threading
+import time
+import unittest
+
+from openrazer_daemon.misc.io_worker import DeviceIOWorker, DeviceBusyError, submit_all
+
+
+class DeviceIOWorkerTest(unittest.TestCase):
+    def setUp(self):
+        self.worker = DeviceIOWorker(0, queue_size=2)
+        self.worker.start()
+
+    def tearDown(self):
+        self.worker.stop()
+
+    def test_calls_run_in_order(self):
+        results = []
+        done = threading.Event()
+
+        def reply(result):
+            results.append(result)
+            if len(results) == 2:
+                done.set()
+
+        for i in range(2):
+            self.worker.submit(lambda value: value * 2, (i,), reply, self.fail)
+
+        self.assertTrue(done.wait(1))
+        self.assertEqual(results, [0, 2])
+
+    def test_errors_reported(self):
+        errors = []
+        done = threading.Event()
+
+        def fail():
+            raise ValueError("broken")
+
+        self.worker.submit(fail, (), self.fail, lambda err: (errors.append(err), done.set()))
+
+        self.assertTrue(done.wait(1))
+        self.assertIsInstance(errors[0], ValueError)
+
+    def test_full_queue_refused(self):
+        release = threading.Event()
+        started = threading.Event()
+        errors = []
+
+        def slow():
+            started.set()
+            release.wait(1)
+
+        self.worker.submit(slow, (), lambda _: None, self.fail)
+        self.assertTrue(started.wait(1))
+
+        # One call running, two queued, the next one doesn't fit
+        for _ in range(3):
+            self.worker.submit(lambda: None, (), lambda _: None, errors.append)
+        release.set()
+
+        self.assertEqual(len(errors), 1)
+        self.assertIsInstance(errors[0], DeviceBusyError)
+
+    def test_other_calls_not_blocked(self):
+        other = DeviceIOWorker(1)
+        other.start()
+
+        release = threading.Event()
+        done = threading.Event()
+        try:
+            self.worker.submit(release.wait, (1,), lambda _: None, self.fail)
+            other.submit(lambda: None, (), lambda _: done.set(), self.fail)
+
+            self.assertTrue(done.wait(0.5))
+        finally:
+            release.set()
+            other.stop()
+
+    def test_submit_all(self):
+        other = DeviceIOWorker(1)
+        other.start()
+
+        results = []
+        done = threading.Event()
+
+        def fail():
+            raise ValueError("broken")
+
+        try:
+            # The slow call finishes last but its result stays first
+            submit_all([(self.worker, lambda: (time.sleep(0.05), 'slow')[1], ()),
+                        (other, lambda value: value * 2, (21,)),
+                        (other, fail, ())],
+                       lambda result: (results.append(result), done.set()))
+
+            self.assertTrue(done.wait(1))
+        finally:
+            other.stop()
+
+        self.assertEqual(len(results), 1)
+        self.assertEqual(results[0][:2], ['slow', 42])
+        self.assertIsInstance(results[0][2], ValueError)
+
+    def test_submit_all_nothing(self):
+        results = []
+        submit_all([], results.append)
+        self.assertEqual(results, [[]])
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,67 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import threading
+import time
+import unittest
+
+from openrazer_daemon.misc.key_event_management import KeyboardKeyManager
+
+# input-event-codes.h KEY_A and KEY_S
+KEY_A = 30
+KEY_S = 31
+
+
+class DummyParent(object):
+    def register_observer(self, observer):
+        pass
+
+
+class TempKeyStoreTest(unittest.TestCase):
+    def setUp(self):
+        self.manager = KeyboardKeyManager(0, [], DummyParent(), testing=True)
+        self.manager.temp_key_store_state = True
+
+    def test_keys_in_order(self):
+        self.manager.key_action(0, KEY_A, 'press')
+        self.manager.key_action(0, KEY_S, 'press')
+
+        keys = self.manager.temp_key_store
+        self.assertIsInstance(keys, tuple)
+        self.assertEqual([key for _, key, _ in keys], [KeyboardKeyManager.KEY_MAP['A'], KeyboardKeyManager.KEY_MAP['S']])
+        self.assertLessEqual(keys[0][0], keys[1][0])
+
+    def test_inactive_store_ignores_keys(self):
+        self.manager.temp_key_store_state = False
+        self.manager.key_action(0, KEY_A, 'press')
+
+        self.assertEqual(self.manager.temp_key_store, ())
+
+    def test_expired_keys_hidden_before_next_write(self):
+        self.manager._temp_expire_time = 0.05
+        self.manager.key_action(0, KEY_A, 'press')
+        snapshot = self.manager._temp_key_snapshot
+        self.assertEqual(len(self.manager.temp_key_store), 1)
+
+        time.sleep(0.06)
+        self.assertEqual(self.manager.temp_key_store, ())
+        # Readers don't publish anything
+        self.assertIs(self.manager._temp_key_snapshot, snapshot)
+
+        self.manager.key_action(0, KEY_S, 'press')
+        self.assertEqual(len(self.manager._temp_key_store), 1)
+        self.assertIsNot(self.manager._temp_key_snapshot, snapshot)
+
+    def test_snapshot_unchanged_by_writers(self):
+        self.manager.key_action(0, KEY_A, 'press')
+        keys = self.manager.temp_key_store
+
+        writer = threading.Thread(target=self.manager.key_action, args=(0, KEY_S, 'press'))
+        writer.start()
+        writer.join()
+
+        self.assertEqual(len(keys), 1)
+        self.assertEqual(len(self.manager.temp_key_store), 2)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,44 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import unittest
+
+from openrazer_daemon.keyboard import KeyboardColour, KeyDoesNotExistError
+
+
+class KeyboardColourTest(unittest.TestCase):
+    def setUp(self):
+        self.grid = KeyboardColour(6, 22)
+
+    def test_wire_format(self):
+        self.grid.set_key_colour(1, 2, (10, 20, 30))
+        payload = bytes(self.grid.get_total_binary())
+
+        self.assertEqual(len(payload), 6 * (3 + 22 * 3))
+        for row_id in range(0, 6):
+            self.assertEqual(payload[row_id * 69:row_id * 69 + 3], bytes((row_id, 0, 21)))
+        self.assertEqual(payload[69 + 3 + 2 * 3:69 + 3 + 3 * 3], b'\x0a\x14\x1e')
+        self.assertEqual(bytes(self.grid.get_row_binary(1)), payload[69:138])
+
+    def test_clamp_and_reset(self):
+        self.grid.set_key_colour(0, 20, (300, -5, 12.7))
+        self.assertEqual(self.grid.get_key_colour('LOGO'), (255, 0, 12))
+
+        self.grid.reset_rows()
+        self.assertEqual(self.grid.get_key_colour('LOGO'), (0, 0, 0))
+        self.assertEqual(bytes(self.grid.get_row_binary(0)[:3]), b'\x00\x00\x15')
+
+    def test_round_trip(self):
+        self.grid.set_key_colour(5, 21, (1, 2, 3))
+
+        other = KeyboardColour(6, 22)
+        other.get_from_total_binary(bytes(self.grid.get_total_binary()))
+        self.assertEqual(bytes(other.get_total_binary()), bytes(self.grid.get_total_binary()))
+
+        self.grid.backup_configuration()
+        self.grid.reset_rows()
+        self.grid.restore_configuration()
+        self.assertEqual(bytes(other.get_total_binary()), bytes(self.grid.get_total_binary()))
+
+    def test_missing_key(self):
+        with self.assertRaises(KeyDoesNotExistError):
+            self.grid.set_key_colour(6, 0, (1, 2, 3))
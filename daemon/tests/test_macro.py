@@ -0,0 +1,92 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import time
+import unittest
+import unittest.mock
+
+from openrazer_daemon.misc.macro import CompiledMacro, KeySequence, MacroKey, MacroRunner, MacroURL, UINPUT_KEY_CODES
+import openrazer_daemon.misc.uinput
+from openrazer_daemon.misc.uinput import INPUT_EVENT, EV_KEY, EV_SYN, KEY_DOWN, KEY_UP, pack_key_event, warn_xte_fallback
+
+
+class DummyKeyboard(object):
+    def __init__(self):
+        self.writes = []
+
+    def write(self, packed):
+        self.writes.append((time.monotonic_ns(), packed))
+
+
+def unpack_events(packed):
+    return [(event_type, code, value) for _, _, event_type, code, value in INPUT_EVENT.iter_unpack(packed)]
+
+
+class CompiledMacroTest(unittest.TestCase):
+    def test_pack_key_event(self):
+        events = unpack_events(pack_key_event(30, KEY_DOWN))
+
+        self.assertEqual(events, [(EV_KEY, 30, KEY_DOWN), (EV_SYN, 0, 0)])
+
+    def test_key_codes(self):
+        self.assertEqual(UINPUT_KEY_CODES['A'], 30)
+        self.assertEqual(UINPUT_KEY_CODES['ESC'], 1)
+        # Keys XTE can't press aren't pressed either
+        self.assertNotIn('MACROMODE', UINPUT_KEY_CODES)
+
+    def test_compile(self):
+        macro = CompiledMacro([
+            MacroKey('A', 0, 'DOWN'),
+            MacroKey('A', 0, 'UP'),
+            MacroKey('B', 1500, 'DOWN'),
+            MacroKey('B', 10, 'UP'),
+        ])
+
+        self.assertEqual(len(macro.steps), 1)
+        sequence = macro.steps[0]
+        self.assertIsInstance(sequence, KeySequence)
+
+        # Events without a pause between them are written together
+        self.assertEqual([offset for offset, _ in sequence.events], [0, 1500000, 1510000])
+        self.assertEqual(unpack_events(sequence.events[0][1]), [(EV_KEY, 30, KEY_DOWN), (EV_SYN, 0, 0), (EV_KEY, 30, KEY_UP), (EV_SYN, 0, 0)])
+
+        self.assertIn('keydown b', sequence.xte.lower())
+
+    def test_compile_split_by_actions(self):
+        url = MacroURL('https://example.com')
+        macro = CompiledMacro([
+            MacroKey('A', 0, 'DOWN'),
+            url,
+            MacroKey('A', 500, 'UP'),
+        ])
+
+        self.assertEqual(len(macro.steps), 3)
+        self.assertIs(macro.steps[1], url)
+        # Timing starts over after an action
+        self.assertEqual(macro.steps[2].events[0][0], 500000)
+
+    def test_play_keys(self):
+        macro = CompiledMacro([
+            MacroKey('A', 0, 'DOWN'),
+            MacroKey('A', 20000, 'UP'),
+            MacroKey('B', 20000, 'DOWN'),
+            MacroKey('B', 0, 'UP'),
+        ])
+        keyboard = DummyKeyboard()
+
+        start = time.monotonic_ns()
+        MacroRunner.play_keys(keyboard, macro.steps[0].events)
+
+        self.assertEqual(len(keyboard.writes), 3)
+        self.assertLess(keyboard.writes[0][0] - start, 5000000)
+        self.assertGreaterEqual(keyboard.writes[1][0] - start, 20000000)
+        self.assertGreaterEqual(keyboard.writes[2][0] - start, 40000000)
+        self.assertLess(keyboard.writes[2][0] - start, 60000000)
+
+    def test_xte_fallback_warned_once(self):
+        with unittest.mock.patch.object(openrazer_daemon.misc.uinput, '_XTE_WARNED', False):
+            with self.assertLogs('razer.macro', 'WARNING') as logs:
+                warn_xte_fallback(PermissionError(13, 'Permission denied'))
+                warn_xte_fallback(PermissionError(13, 'Permission denied'))
+
+        self.assertEqual(len(logs.output), 1)
+        self.assertIn('70-razer-uinput.rules', logs.output[0])
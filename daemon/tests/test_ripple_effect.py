@@ -0,0 +1,124 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import math
+import os
+import random
+import shutil
+import tempfile
+import unittest
+
+from openrazer_daemon.misc.ripple_effect import RippleManager, RippleRenderer
+
+
+def reference_frame(rows, cols, ripples):
+    """
+    The per key loop RippleEffectThread used before RippleRenderer
+    """
+    grid = [[(0, 0, 0)] * cols for _ in range(0, rows)]
+    logo = rows == 6 and cols == 22
+
+    for row in range(0, rows + 1 if logo else rows):
+        for col in range(0, cols):
+            if logo and row == 0 and col == 20:
+                continue
+            if logo and row == 6 and col != 11:
+                continue
+
+            for centre_row, centre_col, rad, colour in ripples:
+                radius = math.sqrt(math.pow(centre_row - row, 2) + math.pow(centre_col - col, 2))
+                if rad >= radius >= rad - 2:
+                    if logo and row == 6:
+                        grid[0][20] = colour
+                    else:
+                        grid[row][col] = colour
+                    break
+
+    payload = b''
+    for row in range(0, rows):
+        payload += bytes((row, 0x00, cols - 1))
+        for rgb in grid[row]:
+            payload += bytes(rgb)
+
+    return payload
+
+
+class RippleRendererTest(unittest.TestCase):
+    def _random_ripples(self, rows, cols, count):
+        rand = random.Random(rows * 100 + cols * 10 + count)
+        return [(rand.randrange(rows), rand.randrange(cols), rand.uniform(0, 48), tuple(rand.randrange(256) for _ in range(3)))
+                for _ in range(count)]
+
+    def test_matches_reference(self):
+        for rows, cols in ((6, 22), (6, 25), (9, 22), (1, 15)):
+            renderer = RippleRenderer(rows, cols)
+
+            for count in (0, 1, 3, 10):
+                ripples = self._random_ripples(rows, cols, count)
+                self.assertEqual(bytes(renderer.render(ripples)), reference_frame(rows, cols, ripples))
+
+    def test_logo_follows_ring(self):
+        renderer = RippleRenderer(6, 22)
+
+        # Ring passing through the virtual logo key at (6, 11)
+        frame = renderer.render([(5, 11, 1.5, (1, 2, 3))])
+        logo = 3 + 20 * 3
+        self.assertEqual(bytes(frame[logo:logo + 3]), b'\x01\x02\x03')
+
+    def test_frame_cleared(self):
+        renderer = RippleRenderer(6, 22)
+
+        renderer.render([(2, 2, 4, (255, 255, 255))])
+        self.assertEqual(bytes(renderer.render([])), reference_frame(6, 22, []))
+
+
+class DummyKeyManager(object):
+    EVENT_MAP = {30: 'A'}
+    KEY_MAP = {'A': (3, 2)}
+
+
+class DummyKeyboard(object):
+    MATRIX_DIMS = [6, 22]
+
+    def __init__(self, driver_dir):
+        self.key_manager = DummyKeyManager()
+        self.driver_writes = []
+        self._driver_dir = driver_dir
+
+    def register_observer(self, observer):
+        pass
+
+    def get_driver_path(self, driver_filename):
+        return os.path.join(self._driver_dir, driver_filename)
+
+    def write_driver_file(self, driver_path, payload):
+        with open(driver_path, 'wb') as driver_file:
+            driver_file.write(payload)
+        self.driver_writes.append((os.path.basename(driver_path), payload))
+
+
+class RippleManagerTest(unittest.TestCase):
+    def setUp(self):
+        self.tmp_dir = tempfile.mkdtemp()
+        open(os.path.join(self.tmp_dir, 'soft_effect'), 'wb').close()
+
+        self.keyboard = DummyKeyboard(self.tmp_dir)
+        self.manager = RippleManager(self.keyboard, 0)
+
+    def tearDown(self):
+        shutil.rmtree(self.tmp_dir, ignore_errors=True)
+
+    def test_close_stops_driver_ripple(self):
+        self.manager._set_driver_ripple((0, 255, 0), 0.04)
+        self.manager.close()
+
+        with open(os.path.join(self.tmp_dir, 'soft_effect'), 'rb') as driver_file:
+            self.assertEqual(driver_file.read(), b'\x00')
+
+        # Everything goes through the device's cached driver files
+        self.assertEqual([name for name, _ in self.keyboard.driver_writes], ['soft_effect_keymap', 'soft_effect', 'soft_effect'])
+
+    def test_close_unplugged(self):
+        self.manager._set_driver_ripple((0, 255, 0), 0.04)
+        shutil.rmtree(self.tmp_dir)
+
+        self.manager.close()
@@ -0,0 +1,53 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import time
+import unittest
+import unittest.mock
+
+from openrazer_daemon.misc.startup_trace import StartupTrace
+
+
+class StartupTraceTest(unittest.TestCase):
+    def test_disabled(self):
+        trace = StartupTrace()
+
+        with trace.phase('imports'):
+            pass
+
+        logger = unittest.mock.MagicMock()
+        trace.report(logger)
+
+        self.assertFalse(logger.info.called)
+
+    def test_phases(self):
+        trace = StartupTrace()
+        trace.start()
+
+        with trace.phase('imports'):
+            time.sleep(0.01)
+        for _ in range(3):
+            with trace.phase('device init'):
+                pass
+
+        logger = unittest.mock.MagicMock()
+        trace.report(logger)
+
+        lines = [call[0][0] for call in logger.info.call_args_list]
+        self.assertEqual(lines[0], "Startup trace:")
+        self.assertTrue(lines[1].startswith('imports '))
+        self.assertGreaterEqual(float(lines[1].split()[-1][:-2]), 10)
+        self.assertTrue(lines[2].startswith('device init ') and lines[2].endswith('(3x)'))
+        self.assertTrue(lines[3].startswith('total '))
+
+    def test_phase_exception(self):
+        trace = StartupTrace()
+        trace.start()
+
+        with self.assertRaises(ValueError):
+            with trace.phase('restore'):
+                raise ValueError()
+
+        logger = unittest.mock.MagicMock()
+        trace.report(logger)
+
+        self.assertTrue(logger.info.call_args_list[1][0][0].startswith('restore '))
@@ -0,0 +1,151 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+import logging
+import os
+import shutil
+import tempfile
+import time
+import unittest
+
+from openrazer_daemon.dbus_services.dbus_methods import mamba
+from openrazer_daemon.misc.state_cache import DeviceStateCache
+
+
+class DummyDriverFile(object):
+    def __init__(self, value):
+        self.value = value
+        self.read_count = 0
+
+    def read(self):
+        self.read_count += 1
+        return self.value
+
+
+class DummyMouse(object):
+    METHODS = ['get_dpi_xy', 'set_dpi_xy']
+    DPI_MAX = 20000
+
+    def __init__(self, driver_dir, testing):
+        self.logger = logging.getLogger('razer.device0')
+        self.dpi = [1800, 1800]
+        self.changes = []
+        self.state_cache = DeviceStateCache(lambda interface, name, value: self.changes.append((name, value)))
+        self._driver_dir = driver_dir
+        self._testing = testing
+
+    def get_driver_path(self, driver_filename):
+        return os.path.join(self._driver_dir, driver_filename)
+
+    def set_persistence(self, zone, key, value):
+        pass
+
+    def write_driver_file(self, driver_path, payload):
+        # The driver sets a single value as X and Y and reads back as text
+        if isinstance(payload, bytes):
+            values = [int.from_bytes(payload[i:i + 2], 'big') for i in range(0, len(payload), 2)]
+            payload = ':'.join(str(value) for value in values * (3 - len(values)))
+        with open(driver_path, 'w') as driver_file:
+            driver_file.write(payload)
+
+    def read_driver_file(self, driver_path):
+        with open(driver_path) as driver_file:
+            return driver_file.read()
+
+
+class DPICacheTest(unittest.TestCase):
+    def setUp(self):
+        self.tmp_dir = tempfile.mkdtemp()
+
+    def tearDown(self):
+        shutil.rmtree(self.tmp_dir)
+
+    def _check_single_value(self, testing):
+        mouse = DummyMouse(self.tmp_dir, testing)
+
+        mamba.set_dpi_xy(mouse, 800, 0)
+
+        # Cached value and what's read back from the driver are both X, X
+        self.assertEqual(mamba.get_dpi_xy(mouse), [800, 800])
+        mouse.state_cache.invalidate()
+        self.assertEqual(mamba.get_dpi_xy(mouse), [800, 800])
+        self.assertEqual(mouse.changes, [('getDPI', [800, 800])])
+
+    def test_single_value(self):
+        self._check_single_value(testing=False)
+
+    def test_single_value_testing(self):
+        self._check_single_value(testing=True)
+
+
+class DeviceStateCacheTest(unittest.TestCase):
+    def setUp(self):
+        self.changes = []
+        self.cache = DeviceStateCache(lambda interface, name, value: self.changes.append((interface, name, value)))
+
+    def test_get_reads_once(self):
+        driver_file = DummyDriverFile(True)
+
+        self.assertTrue(self.cache.get('razer.device.led.gamemode', 'getGameMode', driver_file.read))
+        self.assertTrue(self.cache.get('razer.device.led.gamemode', 'getGameMode', driver_file.read))
+
+        self.assertEqual(driver_file.read_count, 1)
+        # The first read isn't a change
+        self.assertEqual(self.changes, [])
+
+    def test_update(self):
+        driver_file = DummyDriverFile(False)
+
+        self.cache.update('razer.device.led.gamemode', 'getGameMode', True)
+
+        self.assertTrue(self.cache.get('razer.device.led.gamemode', 'getGameMode', driver_file.read))
+        self.assertEqual(driver_file.read_count, 0)
+        self.assertEqual(self.changes, [('razer.device.led.gamemode', 'getGameMode', True)])
+
+        # Writing the same value again isn't a change
+        self.cache.update('razer.device.led.gamemode', 'getGameMode', True)
+        self.assertEqual(len(self.changes), 1)
+
+    def test_ttl(self):
+        driver_file = DummyDriverFile([800, 800])
+
+        self.cache.get('razer.device.dpi', 'getDPI', driver_file.read, ttl=0.05)
+        self.cache.get('razer.device.dpi', 'getDPI', driver_file.read, ttl=0.05)
+        self.assertEqual(driver_file.read_count, 1)
+
+        # DPI button pressed
+        driver_file.value = [1600, 1600]
+        time.sleep(0.06)
+
+        self.assertEqual(self.cache.get('razer.device.dpi', 'getDPI', driver_file.read, ttl=0.05), [1600, 1600])
+        self.assertEqual(driver_file.read_count, 2)
+        self.assertEqual(self.changes, [('razer.device.dpi', 'getDPI', [1600, 1600])])
+
+    def test_invalidate(self):
+        game_mode = DummyDriverFile(True)
+        macro_mode = DummyDriverFile(True)
+
+        self.cache.get('razer.device.led.gamemode', 'getGameMode', game_mode.read)
+        self.cache.get('razer.device.led.macromode', 'getMacroMode', macro_mode.read)
+
+        self.cache.invalidate('razer.device.led.gamemode', 'getGameMode')
+        self.cache.get('razer.device.led.gamemode', 'getGameMode', game_mode.read)
+        self.cache.get('razer.device.led.macromode', 'getMacroMode', macro_mode.read)
+        self.assertEqual((game_mode.read_count, macro_mode.read_count), (2, 1))
+
+        self.cache.invalidate()
+        self.cache.get('razer.device.led.gamemode', 'getGameMode', game_mode.read)
+        self.cache.get('razer.device.led.macromode', 'getMacroMode', macro_mode.read)
+        self.assertEqual((game_mode.read_count, macro_mode.read_count), (3, 2))
+
+        # Values didn't change
+        self.assertEqual(self.changes, [])
+
+    def test_read_error(self):
+        def read():
+            raise FileNotFoundError()
+
+        with self.assertRaises(FileNotFoundError):
+            self.cache.get('razer.device.dpi', 'getDPI', read)
+
+        # Nothing is cached after a failed read
+        self.assertEqual(self.cache.get('razer.device.dpi', 'getDPI', lambda: [800, 800]), [800, 800])
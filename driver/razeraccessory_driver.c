@@ -868,46 +868,24 @@ static ssize_t razer_attr_write_matrix_custom_frame(struct device *dev, struct d
     struct razer_report request = {0};
     struct razer_report response = {0};
 
+    struct razer_custom_frame_row row;
     size_t offset = 0;
-    unsigned char row_id;
-    unsigned char start_col;
-    unsigned char stop_col;
-    unsigned char row_length;
 
     //printk(KERN_ALERT "razermyg: Total count: %d\n", (unsigned char)count);
 
     while(offset < count) {
-        if(offset + 3 > count) {
-            printk(KERN_ALERT "razeraccessory: Wrong Amount of data provided: Should be ROW_ID, START_COL, STOP_COL, N_RGB\n");
+        if (razer_parse_custom_frame_row(buf, count, &offset, &row, "razeraccessory"))
             return -EINVAL;
-        }
-
-        row_id = buf[offset++];
-        start_col = buf[offset++];
-        stop_col = buf[offset++];
-        row_length = ((stop_col+1) - start_col) * 3;
-
-        // printk(KERN_ALERT "razeraccessory: Row ID: %d, Start: %d, Stop: %d, row length: %d\n", row_id, start_col, stop_col, row_length);
-
-        if(start_col > stop_col) {
-            printk(KERN_ALERT "razeraccessory: Start column is greater than end column\n");
-            return -EINVAL;
-        }
-
-        if(offset + row_length > count) {
-            printk(KERN_ALERT "razeraccessory: Not enough RGB to fill row\n");
-            return -EINVAL;
-        }
 
         switch (device->usb_dev->descriptor.idProduct) {
         case USB_DEVICE_ID_RAZER_CORE:
-            request = razer_chroma_standard_matrix_set_custom_frame(row_id, start_col, stop_col, (unsigned char*)&buf[offset]);
+            request = razer_chroma_standard_matrix_set_custom_frame(row.row_id, row.start_col, row.stop_col, row.rgb_data);
             request.transaction_id.id = 0xFF;
             break;
 
         case USB_DEVICE_ID_RAZER_FIREFLY:
         case USB_DEVICE_ID_RAZER_CHROMA_MUG:
-            request = razer_chroma_misc_one_row_set_custom_frame(start_col, stop_col, (unsigned char*)&buf[offset]);
+            request = razer_chroma_misc_one_row_set_custom_frame(row.start_col, row.stop_col, row.rgb_data);
             request.transaction_id.id = 0xFF;
             break;
 
@@ -921,7 +899,7 @@ static ssize_t razer_attr_write_matrix_custom_frame(struct device *dev, struct d
         case USB_DEVICE_ID_RAZER_NOMMO_PRO:
         case USB_DEVICE_ID_RAZER_NOMMO_CHROMA:
         case USB_DEVICE_ID_RAZER_MOUSE_DOCK:
-            request = razer_chroma_extended_matrix_set_custom_frame(row_id, start_col, stop_col, (unsigned char*)&buf[offset]);
+            request = razer_chroma_extended_matrix_set_custom_frame(row.row_id, row.start_col, row.stop_col, row.rgb_data);
             request.transaction_id.id = 0x3F;
             break;
 
@@ -933,19 +911,19 @@ static ssize_t razer_attr_write_matrix_custom_frame(struct device *dev, struct d
         case USB_DEVICE_ID_RAZER_CORE_X_CHROMA:
         case USB_DEVICE_ID_RAZER_LAPTOP_STAND_CHROMA:
         case USB_DEVICE_ID_RAZER_LAPTOP_STAND_CHROMA_V2:
-            request = razer_chroma_extended_matrix_set_custom_frame2(row_id, start_col, stop_col, (unsigned char*)&buf[offset], 0);
+            request = razer_chroma_extended_matrix_set_custom_frame2(row.row_id, row.start_col, row.stop_col, row.rgb_data, 0);
             request.transaction_id.id = 0x1F;
             break;
 
         case USB_DEVICE_ID_RAZER_CHARGING_PAD_CHROMA:
             // Must be in driver mode for custom effects
             razer_set_device_mode(device, 0x03, 0x00);
-            request = razer_chroma_extended_matrix_set_custom_frame2(row_id, start_col, stop_col, (unsigned char*)&buf[offset], 0);
+            request = razer_chroma_extended_matrix_set_custom_frame2(row.row_id, row.start_col, row.stop_col, row.rgb_data, 0);
             request.transaction_id.id = 0x1F;
             break;
 
         case USB_DEVICE_ID_RAZER_CHROMA_ADDRESSABLE_RGB_CONTROLLER:
-            razer_send_argb_msg(device->usb_dev, row_id, (stop_col - start_col) + 1, (unsigned char*)&buf[offset]);
+            razer_send_argb_msg(device->usb_dev, row.row_id, (row.stop_col - row.start_col) + 1, row.rgb_data);
             return count;
 
         default:
@@ -954,9 +932,6 @@ static ssize_t razer_attr_write_matrix_custom_frame(struct device *dev, struct d
         }
 
         razer_send_payload(device, &request, &response);
-
-        // *3 as its 3 bytes per col (RGB)
-        offset += row_length;
     }
 
     return count;
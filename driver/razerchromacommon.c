@@ -448,27 +448,39 @@ struct razer_report razer_chroma_standard_matrix_effect_custom_frame(unsigned ch
  *  21     Unused
  */
 struct razer_report razer_chroma_standard_matrix_set_custom_frame(unsigned char row_index, unsigned char start_col, unsigned char stop_col, unsigned char *rgb_data)
+{
+    struct razer_report report;
+
+    razer_chroma_standard_matrix_build_custom_frame(&report, row_index, start_col, stop_col, rgb_data);
+
+    return report;
+}
+
+/**
+ * Build the set custom frame report in place
+ *
+ * Same as razer_chroma_standard_matrix_set_custom_frame but writes straight
+ * into report, e.g. a buffer that is handed to the USB core as is.
+ */
+void razer_chroma_standard_matrix_build_custom_frame(struct razer_report *report, unsigned char row_index, unsigned char start_col, unsigned char stop_col, unsigned char *rgb_data)
 {
     const size_t start_arg_offset = 4;
-    struct razer_report report = {0};
     size_t row_length = (size_t) (((stop_col + 1) - start_col) * 3);
 
-    if (row_length > sizeof(report.arguments) - start_arg_offset) {
+    if (row_length > sizeof(report->arguments) - start_arg_offset) {
         printk(KERN_ALERT "razerchroma: RGB data too long\n");
-        row_length = sizeof(report.arguments) - start_arg_offset;
+        row_length = sizeof(report->arguments) - start_arg_offset;
     }
 
-    report = get_razer_report(0x03, 0x0B, 0x46); // In theory should be able to leave data size at max as we have start/stop
+    *report = get_razer_report(0x03, 0x0B, 0x46); // In theory should be able to leave data size at max as we have start/stop
 
     // printk(KERN_ALERT "razerkbd: Row ID: %d, Start: %d, Stop: %d, row length: %d\n", row_index, start_col, stop_col, (unsigned char)row_length);
 
-    report.arguments[0] = 0xFF; // Frame ID
-    report.arguments[1] = row_index;
-    report.arguments[2] = start_col;
-    report.arguments[3] = stop_col;
-    memcpy(&report.arguments[4], rgb_data, row_length);
-
-    return report;
+    report->arguments[0] = 0xFF; // Frame ID
+    report->arguments[1] = row_index;
+    report->arguments[2] = start_col;
+    report->arguments[3] = stop_col;
+    memcpy(&report->arguments[4], rgb_data, row_length);
 }
 
 /*
@@ -749,30 +761,39 @@ struct razer_report razer_chroma_extended_matrix_set_custom_frame(unsigned char
 }
 
 struct razer_report razer_chroma_extended_matrix_set_custom_frame2(unsigned char row_index, unsigned char start_col, unsigned char stop_col, unsigned char *rgb_data, size_t packetLength)
+{
+    struct razer_report report;
+
+    razer_chroma_extended_matrix_build_custom_frame(&report, row_index, start_col, stop_col, rgb_data, packetLength);
+
+    return report;
+}
+
+/**
+ * Build the extended set custom frame report in place, see razer_chroma_standard_matrix_build_custom_frame
+ */
+void razer_chroma_extended_matrix_build_custom_frame(struct razer_report *report, unsigned char row_index, unsigned char start_col, unsigned char stop_col, unsigned char *rgb_data, size_t packetLength)
 {
     const size_t start_arg_offset = 5;
     size_t data_length = 0;
-    struct razer_report report = {0};
     size_t row_length = (size_t) (((stop_col + 1) - start_col) * 3);
 
-    if (row_length > sizeof(report.arguments) - start_arg_offset) {
+    if (row_length > sizeof(report->arguments) - start_arg_offset) {
         printk(KERN_ALERT "razerchroma: RGB data too long\n");
-        row_length = sizeof(report.arguments) - start_arg_offset;
+        row_length = sizeof(report->arguments) - start_arg_offset;
     }
 
     // Some devices need a specific packet length, most devices are happy with 0x47
     // e.g. the Mamba Elite needs a "row_length + 5" packet length
     data_length = (packetLength != 0) ? packetLength : row_length + 5;
-    report = get_razer_report(0x0F, 0x03, data_length);
+    *report = get_razer_report(0x0F, 0x03, data_length);
 
     // printk(KERN_ALERT "razerkbd: Row ID: %d, Start: %d, Stop: %d, row length: %d\n", row_index, start_col, stop_col, (unsigned char)row_length);
 
-    report.arguments[2] = row_index;
-    report.arguments[3] = start_col;
-    report.arguments[4] = stop_col;
-    memcpy(&report.arguments[5], rgb_data, row_length);
-
-    return report;
+    report->arguments[2] = row_index;
+    report->arguments[3] = start_col;
+    report->arguments[4] = stop_col;
+    memcpy(&report->arguments[5], rgb_data, row_length);
 }
 
 /*
@@ -1017,22 +1038,33 @@ struct razer_report razer_chroma_misc_get_blade_brightness(void)
  * Sets custom frame for the firefly
  */
 struct razer_report razer_chroma_misc_one_row_set_custom_frame(unsigned char start_col, unsigned char stop_col, unsigned char *rgb_data) // TODO recheck custom frame hex
+{
+    struct razer_report report;
+
+    razer_chroma_misc_one_row_build_custom_frame(&report, start_col, stop_col, rgb_data);
+
+    return report;
+}
+
+/**
+ * Build the one row custom frame report in place, see razer_chroma_standard_matrix_build_custom_frame
+ */
+void razer_chroma_misc_one_row_build_custom_frame(struct razer_report *report, unsigned char start_col, unsigned char stop_col, unsigned char *rgb_data)
 {
     const size_t start_arg_offset = 2;
-    struct razer_report report = get_razer_report(0x03, 0x0C, 0x32);
     size_t row_length = (size_t) (((stop_col + 1) - start_col) * 3);
 
-    if (row_length > sizeof(report.arguments) - start_arg_offset) {
+    *report = get_razer_report(0x03, 0x0C, 0x32);
+
+    if (row_length > sizeof(report->arguments) - start_arg_offset) {
         printk(KERN_ALERT "razerchroma: RGB data too long\n");
-        row_length = sizeof(report.arguments) - start_arg_offset;
+        row_length = sizeof(report->arguments) - start_arg_offset;
     }
 
-    report.arguments[0] = start_col;
-    report.arguments[1] = stop_col;
+    report->arguments[0] = start_col;
+    report->arguments[1] = stop_col;
 
-    memcpy(&report.arguments[2], rgb_data, row_length);
-
-    return report;
+    memcpy(&report->arguments[2], rgb_data, row_length);
 }
 
 /**
@@ -52,6 +52,7 @@ struct razer_report razer_chroma_standard_matrix_effect_breathing_single(struct
 struct razer_report razer_chroma_standard_matrix_effect_breathing_dual(struct razer_rgb *rgb1, struct razer_rgb *rgb2);
 struct razer_report razer_chroma_standard_matrix_effect_custom_frame(unsigned char variable_storage);
 struct razer_report razer_chroma_standard_matrix_set_custom_frame(unsigned char row_index, unsigned char start_col, unsigned char stop_col, unsigned char *rgb_data);
+void razer_chroma_standard_matrix_build_custom_frame(struct razer_report *report, unsigned char row_index, unsigned char start_col, unsigned char stop_col, unsigned char *rgb_data);
 
 /*
  * Extended Matrix Effects Functions
@@ -76,6 +77,7 @@ struct razer_report razer_chroma_extended_matrix_brightness(unsigned char variab
 struct razer_report razer_chroma_extended_matrix_get_brightness(unsigned char variable_storage, unsigned char led_id);
 struct razer_report razer_chroma_extended_matrix_set_custom_frame(unsigned char row_index, unsigned char start_col, unsigned char stop_col, unsigned char *rgb_data);
 struct razer_report razer_chroma_extended_matrix_set_custom_frame2(unsigned char row_index, unsigned char start_col, unsigned char stop_col, unsigned char *rgb_data, size_t packetLength);
+void razer_chroma_extended_matrix_build_custom_frame(struct razer_report *report, unsigned char row_index, unsigned char start_col, unsigned char stop_col, unsigned char *rgb_data, size_t packetLength);
 
 /*
  * Extended Matrix Effects (Mouse) Functions
@@ -104,6 +106,7 @@ struct razer_report razer_chroma_misc_set_blade_brightness(unsigned char brightn
 struct razer_report razer_chroma_misc_get_blade_brightness(void);
 
 struct razer_report razer_chroma_misc_one_row_set_custom_frame(unsigned char start_col, unsigned char stop_col, unsigned char *rgb_data);
+void razer_chroma_misc_one_row_build_custom_frame(struct razer_report *report, unsigned char start_col, unsigned char stop_col, unsigned char *rgb_data);
 struct razer_report razer_chroma_misc_matrix_reactive_trigger(void);
 
 struct razer_report razer_chroma_misc_get_battery_level(void);
@@ -0,0 +1,859 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * KUnit tests for the report builders, the CRC and custom frame parsing
+ *
+ * Build with "make driver_kunit" against a kernel with CONFIG_KUNIT and load
+ * razerkunit.ko (or boot it in a UML/QEMU kernel), no hardware is needed.
+ * The benchmark cases report their timings with kunit_info.
+ */
+
+#include <kunit/test.h>
+#include <linux/ktime.h>
+#include <linux/slab.h>
+
+#include "razerchromacommon.h"
+
+static struct razer_rgb rgb1 = { 0x11, 0x22, 0x33 };
+static struct razer_rgb rgb2 = { 0x44, 0x55, 0x66 };
+// X and Y for each stage
+static const unsigned short dpi_stages[] = { 800, 800, 1600, 1600, 3200, 3200, 6400, 6400, 12800, 12800 };
+static unsigned char row_buf[25 * 3];
+
+static unsigned char *rgb_row(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < sizeof(row_buf); i++)
+        row_buf[i] = i;
+
+    return row_buf;
+}
+
+/*
+ * Golden reports, every byte after the listed ones must be zero
+ */
+struct razer_builder_case {
+    const char *name;
+    struct razer_report (*build)(void);
+    const u8 *golden;
+    size_t golden_len;
+};
+
+#define RAZER_BUILDER_CASE(name, call, ...) \
+static struct razer_report build_##name(void) { return call; } \
+static const u8 golden_##name[] = { __VA_ARGS__ }
+
+#define RAZER_BUILDER_ENTRY(name) \
+{ #name, build_##name, golden_##name, sizeof(golden_##name) }
+
+RAZER_BUILDER_CASE(standard_set_device_mode, razer_chroma_standard_set_device_mode(0x03, 0x00),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x04, 0x03
+);
+
+RAZER_BUILDER_CASE(standard_get_device_mode, razer_chroma_standard_get_device_mode(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x84
+);
+
+RAZER_BUILDER_CASE(standard_get_serial, razer_chroma_standard_get_serial(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x16, 0x00, 0x82
+);
+
+RAZER_BUILDER_CASE(standard_get_firmware_version, razer_chroma_standard_get_firmware_version(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x81
+);
+
+RAZER_BUILDER_CASE(standard_set_led_state, razer_chroma_standard_set_led_state(VARSTORE, BACKLIGHT_LED, ON),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x00, 0x01, 0x05, 0x01
+);
+
+RAZER_BUILDER_CASE(standard_get_led_state, razer_chroma_standard_get_led_state(VARSTORE, LOGO_LED),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x80, 0x01, 0x04
+);
+
+RAZER_BUILDER_CASE(standard_set_led_blinking, razer_chroma_standard_set_led_blinking(VARSTORE, GAME_LED),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x03, 0x04, 0x01, 0x08, 0x05, 0x05
+);
+
+RAZER_BUILDER_CASE(standard_set_led_rgb, razer_chroma_standard_set_led_rgb(VARSTORE, BACKLIGHT_LED, &rgb1),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x03, 0x01, 0x01, 0x05, 0x11, 0x22, 0x33
+);
+
+RAZER_BUILDER_CASE(standard_get_led_rgb, razer_chroma_standard_get_led_rgb(VARSTORE, BACKLIGHT_LED),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x03, 0x81, 0x01, 0x05
+);
+
+RAZER_BUILDER_CASE(standard_set_led_effect, razer_chroma_standard_set_led_effect(VARSTORE, LOGO_LED, 0x02),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x02, 0x01, 0x04, 0x02
+);
+
+RAZER_BUILDER_CASE(standard_get_led_effect, razer_chroma_standard_get_led_effect(VARSTORE, LOGO_LED),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x82, 0x01, 0x04
+);
+
+RAZER_BUILDER_CASE(standard_set_led_brightness, razer_chroma_standard_set_led_brightness(VARSTORE, BACKLIGHT_LED, 0x80),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x03, 0x01, 0x05, 0x80
+);
+
+RAZER_BUILDER_CASE(standard_get_led_brightness, razer_chroma_standard_get_led_brightness(VARSTORE, BACKLIGHT_LED),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x83, 0x01, 0x05
+);
+
+RAZER_BUILDER_CASE(standard_matrix_effect_none, razer_chroma_standard_matrix_effect_none(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x03, 0x0A
+);
+
+RAZER_BUILDER_CASE(standard_matrix_effect_wave, razer_chroma_standard_matrix_effect_wave(0x02),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x0A, 0x01, 0x02
+);
+
+RAZER_BUILDER_CASE(standard_matrix_effect_spectrum, razer_chroma_standard_matrix_effect_spectrum(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x03, 0x0A, 0x04
+);
+
+RAZER_BUILDER_CASE(standard_matrix_effect_reactive, razer_chroma_standard_matrix_effect_reactive(0x02, &rgb1),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x03, 0x0A, 0x02, 0x02, 0x11, 0x22, 0x33
+);
+
+RAZER_BUILDER_CASE(standard_matrix_effect_static, razer_chroma_standard_matrix_effect_static(&rgb1),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x03, 0x0A, 0x06, 0x11, 0x22, 0x33
+);
+
+RAZER_BUILDER_CASE(standard_matrix_effect_starlight_single, razer_chroma_standard_matrix_effect_starlight_single(0x01, &rgb1),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x03, 0x0A, 0x19, 0x01, 0x01, 0x11, 0x22, 0x33
+);
+
+RAZER_BUILDER_CASE(standard_matrix_effect_starlight_dual, razer_chroma_standard_matrix_effect_starlight_dual(0x02, &rgb1, &rgb2),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x03, 0x0A, 0x19, 0x02, 0x02, 0x11, 0x22, 0x33, 0x44, 0x55,
+                   0x66
+);
+
+RAZER_BUILDER_CASE(standard_matrix_effect_starlight_random, razer_chroma_standard_matrix_effect_starlight_random(0x03),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x03, 0x0A, 0x19, 0x03, 0x03
+);
+
+RAZER_BUILDER_CASE(standard_matrix_effect_breathing_random, razer_chroma_standard_matrix_effect_breathing_random(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x03, 0x0A, 0x03, 0x03
+);
+
+RAZER_BUILDER_CASE(standard_matrix_effect_breathing_single, razer_chroma_standard_matrix_effect_breathing_single(&rgb1),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x03, 0x0A, 0x03, 0x01, 0x11, 0x22, 0x33
+);
+
+RAZER_BUILDER_CASE(standard_matrix_effect_breathing_dual, razer_chroma_standard_matrix_effect_breathing_dual(&rgb1, &rgb2),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x03, 0x0A, 0x03, 0x02, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66
+);
+
+RAZER_BUILDER_CASE(standard_matrix_effect_custom_frame, razer_chroma_standard_matrix_effect_custom_frame(NOSTORE),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x0A, 0x05
+);
+
+RAZER_BUILDER_CASE(standard_matrix_set_custom_frame, razer_chroma_standard_matrix_set_custom_frame(0x02, 0x00, 0x15, rgb_row()),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x46, 0x03, 0x0B, 0xFF, 0x02, 0x00, 0x15, 0x00, 0x01, 0x02, 0x03,
+                   0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12, 0x13,
+                   0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23,
+                   0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33,
+                   0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F, 0x40, 0x41
+);
+
+/*
+ * The in place builders get a buffer that still holds the last report, like
+ * a reused DMA buffer, so every byte they don't set must be cleared
+ */
+static struct razer_report dirty_report;
+
+static struct razer_report *dirty(void)
+{
+    memset(&dirty_report, 0xAA, sizeof(dirty_report));
+    return &dirty_report;
+}
+
+static struct razer_report standard_matrix_built_custom_frame(unsigned char row_index, unsigned char start_col, unsigned char stop_col)
+{
+    struct razer_report *report = dirty();
+
+    razer_chroma_standard_matrix_build_custom_frame(report, row_index, start_col, stop_col, rgb_row());
+    return *report;
+}
+
+static struct razer_report extended_matrix_built_custom_frame(unsigned char row_index, unsigned char start_col, unsigned char stop_col, size_t packet_length)
+{
+    struct razer_report *report = dirty();
+
+    razer_chroma_extended_matrix_build_custom_frame(report, row_index, start_col, stop_col, rgb_row(), packet_length);
+    return *report;
+}
+
+static struct razer_report misc_one_row_built_custom_frame(unsigned char start_col, unsigned char stop_col)
+{
+    struct razer_report *report = dirty();
+
+    razer_chroma_misc_one_row_build_custom_frame(report, start_col, stop_col, rgb_row());
+    return *report;
+}
+
+RAZER_BUILDER_CASE(standard_matrix_build_custom_frame, standard_matrix_built_custom_frame(0x05, 0x03, 0x07),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x46, 0x03, 0x0B, 0xFF, 0x05, 0x03, 0x07, 0x00, 0x01, 0x02, 0x03,
+                   0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E
+);
+
+RAZER_BUILDER_CASE(extended_matrix_effect_none, razer_chroma_extended_matrix_effect_none(VARSTORE, BACKLIGHT_LED),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x0F, 0x02, 0x01, 0x05
+);
+
+RAZER_BUILDER_CASE(extended_matrix_effect_static, razer_chroma_extended_matrix_effect_static(VARSTORE, BACKLIGHT_LED, &rgb1),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x0F, 0x02, 0x01, 0x05, 0x01, 0x00, 0x00, 0x01, 0x11, 0x22,
+                   0x33
+);
+
+RAZER_BUILDER_CASE(extended_matrix_effect_wave, razer_chroma_extended_matrix_effect_wave(VARSTORE, BACKLIGHT_LED, 0x01),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x0F, 0x02, 0x01, 0x05, 0x04, 0x01, 0x28
+);
+
+RAZER_BUILDER_CASE(extended_matrix_effect_starlight_random, razer_chroma_extended_matrix_effect_starlight_random(VARSTORE, BACKLIGHT_LED, 0x02),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x0F, 0x02, 0x01, 0x05, 0x07, 0x00, 0x02
+);
+
+RAZER_BUILDER_CASE(extended_matrix_effect_starlight_single, razer_chroma_extended_matrix_effect_starlight_single(VARSTORE, BACKLIGHT_LED, 0x02, &rgb1),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x0F, 0x02, 0x01, 0x05, 0x07, 0x00, 0x02, 0x01, 0x11, 0x22,
+                   0x33
+);
+
+RAZER_BUILDER_CASE(extended_matrix_effect_starlight_dual, razer_chroma_extended_matrix_effect_starlight_dual(VARSTORE, BACKLIGHT_LED, 0x02, &rgb1, &rgb2),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0F, 0x02, 0x01, 0x05, 0x07, 0x00, 0x02, 0x02, 0x11, 0x22,
+                   0x33, 0x44, 0x55, 0x66
+);
+
+RAZER_BUILDER_CASE(extended_matrix_effect_spectrum, razer_chroma_extended_matrix_effect_spectrum(VARSTORE, BACKLIGHT_LED),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x0F, 0x02, 0x01, 0x05, 0x03
+);
+
+RAZER_BUILDER_CASE(extended_matrix_effect_wheel, razer_chroma_extended_matrix_effect_wheel(VARSTORE, BACKLIGHT_LED, 0x02),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x0F, 0x02, 0x01, 0x05, 0x0A, 0x02, 0x28
+);
+
+RAZER_BUILDER_CASE(extended_matrix_effect_reactive, razer_chroma_extended_matrix_effect_reactive(VARSTORE, BACKLIGHT_LED, 0x03, &rgb1),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x0F, 0x02, 0x01, 0x05, 0x05, 0x00, 0x03, 0x01, 0x11, 0x22,
+                   0x33
+);
+
+RAZER_BUILDER_CASE(extended_matrix_effect_breathing_random, razer_chroma_extended_matrix_effect_breathing_random(VARSTORE, BACKLIGHT_LED),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x0F, 0x02, 0x01, 0x05, 0x02
+);
+
+RAZER_BUILDER_CASE(extended_matrix_effect_breathing_single, razer_chroma_extended_matrix_effect_breathing_single(VARSTORE, BACKLIGHT_LED, &rgb1),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x0F, 0x02, 0x01, 0x05, 0x02, 0x01, 0x00, 0x01, 0x11, 0x22,
+                   0x33
+);
+
+RAZER_BUILDER_CASE(extended_matrix_effect_breathing_dual, razer_chroma_extended_matrix_effect_breathing_dual(VARSTORE, BACKLIGHT_LED, &rgb1, &rgb2),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0F, 0x02, 0x01, 0x05, 0x02, 0x02, 0x00, 0x02, 0x11, 0x22,
+                   0x33, 0x44, 0x55, 0x66
+);
+
+RAZER_BUILDER_CASE(extended_matrix_effect_custom_frame, razer_chroma_extended_matrix_effect_custom_frame(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0F, 0x02, 0x00, 0x00, 0x08
+);
+
+RAZER_BUILDER_CASE(extended_matrix_brightness, razer_chroma_extended_matrix_brightness(VARSTORE, BACKLIGHT_LED, 0x80),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x0F, 0x04, 0x01, 0x05, 0x80
+);
+
+RAZER_BUILDER_CASE(extended_matrix_get_brightness, razer_chroma_extended_matrix_get_brightness(VARSTORE, BACKLIGHT_LED),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x0F, 0x84, 0x01, 0x05
+);
+
+RAZER_BUILDER_CASE(extended_matrix_set_custom_frame, razer_chroma_extended_matrix_set_custom_frame(0x03, 0x00, 0x15, rgb_row()),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x47, 0x0F, 0x03, 0x00, 0x00, 0x03, 0x00, 0x15, 0x00, 0x01, 0x02,
+                   0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12,
+                   0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22,
+                   0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32,
+                   0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F, 0x40, 0x41
+);
+
+RAZER_BUILDER_CASE(extended_matrix_set_custom_frame2, razer_chroma_extended_matrix_set_custom_frame2(0x03, 0x02, 0x07, rgb_row(), 0),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x17, 0x0F, 0x03, 0x00, 0x00, 0x03, 0x02, 0x07, 0x00, 0x01, 0x02,
+                   0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11
+);
+
+RAZER_BUILDER_CASE(extended_matrix_build_custom_frame, extended_matrix_built_custom_frame(0x01, 0x00, 0x15, 0x47),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x47, 0x0F, 0x03, 0x00, 0x00, 0x01, 0x00, 0x15, 0x00, 0x01, 0x02,
+                   0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12,
+                   0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22,
+                   0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32,
+                   0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F, 0x40, 0x41
+);
+
+RAZER_BUILDER_CASE(extended_matrix_build_custom_frame_row_length, extended_matrix_built_custom_frame(0x04, 0x0A, 0x0B, 0),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x0B, 0x0F, 0x03, 0x00, 0x00, 0x04, 0x0A, 0x0B, 0x00, 0x01, 0x02,
+                   0x03, 0x04, 0x05
+);
+
+RAZER_BUILDER_CASE(mouse_extended_matrix_effect_none, razer_chroma_mouse_extended_matrix_effect_none(VARSTORE, SCROLL_WHEEL_LED),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x0D, 0x01, 0x01
+);
+
+RAZER_BUILDER_CASE(mouse_extended_matrix_effect_static, razer_chroma_mouse_extended_matrix_effect_static(VARSTORE, SCROLL_WHEEL_LED, &rgb1),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x03, 0x0D, 0x01, 0x01, 0x06, 0x11, 0x22, 0x33
+);
+
+RAZER_BUILDER_CASE(mouse_extended_matrix_effect_spectrum, razer_chroma_mouse_extended_matrix_effect_spectrum(VARSTORE, SCROLL_WHEEL_LED),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x0D, 0x01, 0x01, 0x04
+);
+
+RAZER_BUILDER_CASE(mouse_extended_matrix_effect_reactive, razer_chroma_mouse_extended_matrix_effect_reactive(VARSTORE, LOGO_LED, 0x02, &rgb1),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x03, 0x0D, 0x01, 0x04, 0x02, 0x02, 0x11, 0x22, 0x33
+);
+
+RAZER_BUILDER_CASE(mouse_extended_matrix_effect_breathing_random, razer_chroma_mouse_extended_matrix_effect_breathing_random(VARSTORE, LOGO_LED),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x0A, 0x03, 0x0D, 0x01, 0x04, 0x03, 0x03
+);
+
+RAZER_BUILDER_CASE(mouse_extended_matrix_effect_breathing_single, razer_chroma_mouse_extended_matrix_effect_breathing_single(VARSTORE, LOGO_LED, &rgb1),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x0A, 0x03, 0x0D, 0x01, 0x04, 0x03, 0x01, 0x11, 0x22, 0x33
+);
+
+RAZER_BUILDER_CASE(mouse_extended_matrix_effect_breathing_dual, razer_chroma_mouse_extended_matrix_effect_breathing_dual(VARSTORE, LOGO_LED, &rgb1, &rgb2),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x0A, 0x03, 0x0D, 0x01, 0x04, 0x03, 0x02, 0x11, 0x22, 0x33, 0x44,
+                   0x55, 0x66
+);
+
+RAZER_BUILDER_CASE(misc_fn_key_toggle, razer_chroma_misc_fn_key_toggle(0x01),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x06, 0x00, 0x01
+);
+
+RAZER_BUILDER_CASE(misc_set_keyswitch_optimization_command1, razer_chroma_misc_set_keyswitch_optimization_command1(0x01),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x02, 0x02
+);
+
+RAZER_BUILDER_CASE(misc_set_keyswitch_optimization_command2, razer_chroma_misc_set_keyswitch_optimization_command2(0x01),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x02, 0x15, 0x01
+);
+
+RAZER_BUILDER_CASE(misc_get_keyswitch_optimization, razer_chroma_misc_get_keyswitch_optimization(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x02, 0x82
+);
+
+RAZER_BUILDER_CASE(misc_set_blade_brightness, razer_chroma_misc_set_blade_brightness(0x80),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x0E, 0x04, 0x01, 0x80
+);
+
+RAZER_BUILDER_CASE(misc_get_blade_brightness, razer_chroma_misc_get_blade_brightness(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x0E, 0x84, 0x01
+);
+
+RAZER_BUILDER_CASE(misc_one_row_set_custom_frame, razer_chroma_misc_one_row_set_custom_frame(0x00, 0x0E, rgb_row()),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x32, 0x03, 0x0C, 0x00, 0x0E, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05,
+                   0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15,
+                   0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25,
+                   0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C
+);
+
+RAZER_BUILDER_CASE(misc_one_row_build_custom_frame, misc_one_row_built_custom_frame(0x02, 0x04),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x32, 0x03, 0x0C, 0x02, 0x04, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05,
+                   0x06, 0x07, 0x08
+);
+
+RAZER_BUILDER_CASE(misc_matrix_reactive_trigger, razer_chroma_misc_matrix_reactive_trigger(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x03, 0x0A, 0x02
+);
+
+RAZER_BUILDER_CASE(misc_get_battery_level, razer_chroma_misc_get_battery_level(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x07, 0x80
+);
+
+RAZER_BUILDER_CASE(misc_get_charging_status, razer_chroma_misc_get_charging_status(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x07, 0x84
+);
+
+RAZER_BUILDER_CASE(misc_set_dock_charge_type, razer_chroma_misc_set_dock_charge_type(0x01),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x03, 0x10, 0x01
+);
+
+RAZER_BUILDER_CASE(misc_get_polling_rate, razer_chroma_misc_get_polling_rate(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x85
+);
+
+RAZER_BUILDER_CASE(misc_set_polling_rate, razer_chroma_misc_set_polling_rate(500),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x05, 0x02
+);
+
+RAZER_BUILDER_CASE(misc_get_polling_rate2, razer_chroma_misc_get_polling_rate2(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0xC0
+);
+
+RAZER_BUILDER_CASE(misc_set_polling_rate2, razer_chroma_misc_set_polling_rate2(4000, 0x00),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x40, 0x00, 0x02
+);
+
+RAZER_BUILDER_CASE(misc_get_dock_brightness, razer_chroma_misc_get_dock_brightness(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x82
+);
+
+RAZER_BUILDER_CASE(misc_set_dock_brightness, razer_chroma_misc_set_dock_brightness(0x80),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x02, 0x80
+);
+
+RAZER_BUILDER_CASE(misc_set_dpi_xy, razer_chroma_misc_set_dpi_xy(VARSTORE, 1800, 3600),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x04, 0x05, 0x01, 0x07, 0x08, 0x0E, 0x10
+);
+
+RAZER_BUILDER_CASE(misc_get_dpi_xy, razer_chroma_misc_get_dpi_xy(VARSTORE),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x04, 0x85, 0x01
+);
+
+RAZER_BUILDER_CASE(misc_set_dpi_xy_byte, razer_chroma_misc_set_dpi_xy_byte(0x40, 0x80),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x04, 0x01, 0x40, 0x80
+);
+
+RAZER_BUILDER_CASE(misc_get_dpi_xy_byte, razer_chroma_misc_get_dpi_xy_byte(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x04, 0x81
+);
+
+RAZER_BUILDER_CASE(misc_set_dpi_stages, razer_chroma_misc_set_dpi_stages(VARSTORE, 5, 2, dpi_stages),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x26, 0x04, 0x06, 0x01, 0x02, 0x05, 0x00, 0x03, 0x20, 0x03, 0x20,
+                   0x00, 0x00, 0x01, 0x06, 0x40, 0x06, 0x40, 0x00, 0x00, 0x02, 0x0C, 0x80, 0x0C, 0x80, 0x00, 0x00,
+                   0x03, 0x19, 0x00, 0x19, 0x00, 0x00, 0x00, 0x04, 0x32, 0x00, 0x32
+);
+
+RAZER_BUILDER_CASE(misc_get_dpi_stages, razer_chroma_misc_get_dpi_stages(VARSTORE),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x26, 0x04, 0x86, 0x01
+);
+
+RAZER_BUILDER_CASE(misc_get_idle_time, razer_chroma_misc_get_idle_time(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x07, 0x83
+);
+
+RAZER_BUILDER_CASE(misc_set_idle_time, razer_chroma_misc_set_idle_time(300),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x07, 0x03, 0x01, 0x2C
+);
+
+RAZER_BUILDER_CASE(misc_get_low_battery_threshold, razer_chroma_misc_get_low_battery_threshold(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x81
+);
+
+RAZER_BUILDER_CASE(misc_set_low_battery_threshold, razer_chroma_misc_set_low_battery_threshold(0x26),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x01, 0x26
+);
+
+RAZER_BUILDER_CASE(misc_set_orochi2011_led, razer_chroma_misc_set_orochi2011_led(0x01),
+                   0x01, 0x00, 0x00, 0x06, 0x48, 0x00, 0x00, 0x00, 0x01, 0x01, 0x03, 0x05, 0x06, 0x06, 0x10, 0x10,
+                   0x10, 0x10, 0x24, 0x24, 0x4C, 0x4C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01,
+                   0x02, 0x02, 0x01, 0x01, 0x03, 0x03, 0x04, 0x01, 0x04, 0x04, 0x01, 0x01, 0x05, 0x05, 0x01, 0x01,
+                   0x06, 0x31, 0x88, 0x00, 0x07, 0x31, 0x87, 0x00, 0x08, 0x08, 0x01, 0x01, 0x09, 0x09, 0x01, 0x01,
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x44, 0x01
+);
+
+RAZER_BUILDER_CASE(misc_set_orochi2011_poll_dpi, razer_chroma_misc_set_orochi2011_poll_dpi(500, 0x40, 0x40),
+                   0x01, 0x00, 0x00, 0x05, 0x05, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x40, 0x40, 0x00, 0x00, 0x00,
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01
+);
+
+RAZER_BUILDER_CASE(naga_trinity_effect_static, razer_naga_trinity_effect_static(&rgb1),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x0E, 0x0F, 0x03, 0x00, 0x00, 0x00, 0x00, 0x02, 0x11, 0x22, 0x33,
+                   0x11, 0x22, 0x33, 0x11, 0x22, 0x33
+);
+
+RAZER_BUILDER_CASE(misc_set_scroll_mode, razer_chroma_misc_set_scroll_mode(0x01),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x14, 0x01, 0x01
+);
+
+RAZER_BUILDER_CASE(misc_get_scroll_mode, razer_chroma_misc_get_scroll_mode(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x94, 0x01
+);
+
+RAZER_BUILDER_CASE(misc_set_scroll_acceleration, razer_chroma_misc_set_scroll_acceleration(true),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x16, 0x01, 0x01
+);
+
+RAZER_BUILDER_CASE(misc_get_scroll_acceleration, razer_chroma_misc_get_scroll_acceleration(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x96, 0x01
+);
+
+RAZER_BUILDER_CASE(misc_set_scroll_smart_reel, razer_chroma_misc_set_scroll_smart_reel(true),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x17, 0x01, 0x01
+);
+
+RAZER_BUILDER_CASE(misc_get_scroll_smart_reel, razer_chroma_misc_get_scroll_smart_reel(),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x97, 0x01
+);
+
+RAZER_BUILDER_CASE(misc_set_hyperpolling_wireless_dongle_indicator_led_mode, razer_chroma_misc_set_hyperpolling_wireless_dongle_indicator_led_mode(0x02),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x10, 0x02
+);
+
+RAZER_BUILDER_CASE(misc_set_hyperpolling_wireless_dongle_pair_step1, razer_chroma_misc_set_hyperpolling_wireless_dongle_pair_step1(0x01),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x46, 0x01
+);
+
+RAZER_BUILDER_CASE(misc_set_hyperpolling_wireless_dongle_pair_step2, razer_chroma_misc_set_hyperpolling_wireless_dongle_pair_step2(0x00B9),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x41, 0x01, 0x00, 0xB9
+);
+
+RAZER_BUILDER_CASE(misc_set_hyperpolling_wireless_dongle_unpair, razer_chroma_misc_set_hyperpolling_wireless_dongle_unpair(0x00B9),
+                   0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x42, 0x00, 0xB9
+);
+
+static const struct razer_builder_case razer_builder_cases[] = {
+    RAZER_BUILDER_ENTRY(standard_set_device_mode),
+    RAZER_BUILDER_ENTRY(standard_get_device_mode),
+    RAZER_BUILDER_ENTRY(standard_get_serial),
+    RAZER_BUILDER_ENTRY(standard_get_firmware_version),
+    RAZER_BUILDER_ENTRY(standard_set_led_state),
+    RAZER_BUILDER_ENTRY(standard_get_led_state),
+    RAZER_BUILDER_ENTRY(standard_set_led_blinking),
+    RAZER_BUILDER_ENTRY(standard_set_led_rgb),
+    RAZER_BUILDER_ENTRY(standard_get_led_rgb),
+    RAZER_BUILDER_ENTRY(standard_set_led_effect),
+    RAZER_BUILDER_ENTRY(standard_get_led_effect),
+    RAZER_BUILDER_ENTRY(standard_set_led_brightness),
+    RAZER_BUILDER_ENTRY(standard_get_led_brightness),
+    RAZER_BUILDER_ENTRY(standard_matrix_effect_none),
+    RAZER_BUILDER_ENTRY(standard_matrix_effect_wave),
+    RAZER_BUILDER_ENTRY(standard_matrix_effect_spectrum),
+    RAZER_BUILDER_ENTRY(standard_matrix_effect_reactive),
+    RAZER_BUILDER_ENTRY(standard_matrix_effect_static),
+    RAZER_BUILDER_ENTRY(standard_matrix_effect_starlight_single),
+    RAZER_BUILDER_ENTRY(standard_matrix_effect_starlight_dual),
+    RAZER_BUILDER_ENTRY(standard_matrix_effect_starlight_random),
+    RAZER_BUILDER_ENTRY(standard_matrix_effect_breathing_random),
+    RAZER_BUILDER_ENTRY(standard_matrix_effect_breathing_single),
+    RAZER_BUILDER_ENTRY(standard_matrix_effect_breathing_dual),
+    RAZER_BUILDER_ENTRY(standard_matrix_effect_custom_frame),
+    RAZER_BUILDER_ENTRY(standard_matrix_set_custom_frame),
+    RAZER_BUILDER_ENTRY(standard_matrix_build_custom_frame),
+    RAZER_BUILDER_ENTRY(extended_matrix_effect_none),
+    RAZER_BUILDER_ENTRY(extended_matrix_effect_static),
+    RAZER_BUILDER_ENTRY(extended_matrix_effect_wave),
+    RAZER_BUILDER_ENTRY(extended_matrix_effect_starlight_random),
+    RAZER_BUILDER_ENTRY(extended_matrix_effect_starlight_single),
+    RAZER_BUILDER_ENTRY(extended_matrix_effect_starlight_dual),
+    RAZER_BUILDER_ENTRY(extended_matrix_effect_spectrum),
+    RAZER_BUILDER_ENTRY(extended_matrix_effect_wheel),
+    RAZER_BUILDER_ENTRY(extended_matrix_effect_reactive),
+    RAZER_BUILDER_ENTRY(extended_matrix_effect_breathing_random),
+    RAZER_BUILDER_ENTRY(extended_matrix_effect_breathing_single),
+    RAZER_BUILDER_ENTRY(extended_matrix_effect_breathing_dual),
+    RAZER_BUILDER_ENTRY(extended_matrix_effect_custom_frame),
+    RAZER_BUILDER_ENTRY(extended_matrix_brightness),
+    RAZER_BUILDER_ENTRY(extended_matrix_get_brightness),
+    RAZER_BUILDER_ENTRY(extended_matrix_set_custom_frame),
+    RAZER_BUILDER_ENTRY(extended_matrix_set_custom_frame2),
+    RAZER_BUILDER_ENTRY(extended_matrix_build_custom_frame),
+    RAZER_BUILDER_ENTRY(extended_matrix_build_custom_frame_row_length),
+    RAZER_BUILDER_ENTRY(mouse_extended_matrix_effect_none),
+    RAZER_BUILDER_ENTRY(mouse_extended_matrix_effect_static),
+    RAZER_BUILDER_ENTRY(mouse_extended_matrix_effect_spectrum),
+    RAZER_BUILDER_ENTRY(mouse_extended_matrix_effect_reactive),
+    RAZER_BUILDER_ENTRY(mouse_extended_matrix_effect_breathing_random),
+    RAZER_BUILDER_ENTRY(mouse_extended_matrix_effect_breathing_single),
+    RAZER_BUILDER_ENTRY(mouse_extended_matrix_effect_breathing_dual),
+    RAZER_BUILDER_ENTRY(misc_fn_key_toggle),
+    RAZER_BUILDER_ENTRY(misc_set_keyswitch_optimization_command1),
+    RAZER_BUILDER_ENTRY(misc_set_keyswitch_optimization_command2),
+    RAZER_BUILDER_ENTRY(misc_get_keyswitch_optimization),
+    RAZER_BUILDER_ENTRY(misc_set_blade_brightness),
+    RAZER_BUILDER_ENTRY(misc_get_blade_brightness),
+    RAZER_BUILDER_ENTRY(misc_one_row_set_custom_frame),
+    RAZER_BUILDER_ENTRY(misc_one_row_build_custom_frame),
+    RAZER_BUILDER_ENTRY(misc_matrix_reactive_trigger),
+    RAZER_BUILDER_ENTRY(misc_get_battery_level),
+    RAZER_BUILDER_ENTRY(misc_get_charging_status),
+    RAZER_BUILDER_ENTRY(misc_set_dock_charge_type),
+    RAZER_BUILDER_ENTRY(misc_get_polling_rate),
+    RAZER_BUILDER_ENTRY(misc_set_polling_rate),
+    RAZER_BUILDER_ENTRY(misc_get_polling_rate2),
+    RAZER_BUILDER_ENTRY(misc_set_polling_rate2),
+    RAZER_BUILDER_ENTRY(misc_get_dock_brightness),
+    RAZER_BUILDER_ENTRY(misc_set_dock_brightness),
+    RAZER_BUILDER_ENTRY(misc_set_dpi_xy),
+    RAZER_BUILDER_ENTRY(misc_get_dpi_xy),
+    RAZER_BUILDER_ENTRY(misc_set_dpi_xy_byte),
+    RAZER_BUILDER_ENTRY(misc_get_dpi_xy_byte),
+    RAZER_BUILDER_ENTRY(misc_set_dpi_stages),
+    RAZER_BUILDER_ENTRY(misc_get_dpi_stages),
+    RAZER_BUILDER_ENTRY(misc_get_idle_time),
+    RAZER_BUILDER_ENTRY(misc_set_idle_time),
+    RAZER_BUILDER_ENTRY(misc_get_low_battery_threshold),
+    RAZER_BUILDER_ENTRY(misc_set_low_battery_threshold),
+    RAZER_BUILDER_ENTRY(misc_set_orochi2011_led),
+    RAZER_BUILDER_ENTRY(misc_set_orochi2011_poll_dpi),
+    RAZER_BUILDER_ENTRY(naga_trinity_effect_static),
+    RAZER_BUILDER_ENTRY(misc_set_scroll_mode),
+    RAZER_BUILDER_ENTRY(misc_get_scroll_mode),
+    RAZER_BUILDER_ENTRY(misc_set_scroll_acceleration),
+    RAZER_BUILDER_ENTRY(misc_get_scroll_acceleration),
+    RAZER_BUILDER_ENTRY(misc_set_scroll_smart_reel),
+    RAZER_BUILDER_ENTRY(misc_get_scroll_smart_reel),
+    RAZER_BUILDER_ENTRY(misc_set_hyperpolling_wireless_dongle_indicator_led_mode),
+    RAZER_BUILDER_ENTRY(misc_set_hyperpolling_wireless_dongle_pair_step1),
+    RAZER_BUILDER_ENTRY(misc_set_hyperpolling_wireless_dongle_pair_step2),
+    RAZER_BUILDER_ENTRY(misc_set_hyperpolling_wireless_dongle_unpair),
+};
+
+static void razer_builder_case_desc(const struct razer_builder_case *c, char *desc)
+{
+    strscpy(desc, c->name, KUNIT_PARAM_DESC_SIZE);
+}
+
+KUNIT_ARRAY_PARAM(razer_builder, razer_builder_cases, razer_builder_case_desc);
+
+static void razer_builder_golden_test(struct kunit *test)
+{
+    const struct razer_builder_case *c = test->param_value;
+    struct razer_report report = c->build();
+    const u8 *raw = (const u8 *)&report;
+    unsigned int i;
+
+    for (i = 0; i < sizeof(struct razer_report); i++) {
+        u8 expected = i < c->golden_len ? c->golden[i] : 0x00;
+
+        KUNIT_EXPECT_EQ_MSG(test, raw[i], expected, "%s byte %u", c->name, i);
+    }
+}
+
+static struct kunit_case razer_builder_test_cases[] = {
+    KUNIT_CASE_PARAM(razer_builder_golden_test, razer_builder_gen_params),
+    {}
+};
+
+static struct kunit_suite razer_builder_test_suite = {
+    .name = "razer_builder",
+    .test_cases = razer_builder_test_cases,
+};
+
+/*
+ * CRC and report helpers
+ */
+static void razer_crc_empty_test(struct kunit *test)
+{
+    struct razer_report report = get_empty_razer_report();
+
+    KUNIT_EXPECT_EQ(test, razer_calculate_crc(&report), 0x00);
+}
+
+static void razer_crc_golden_test(struct kunit *test)
+{
+    struct razer_report report;
+
+    report = razer_chroma_standard_set_device_mode(0x03, 0x00);
+    KUNIT_EXPECT_EQ(test, razer_calculate_crc(&report), 0x05);
+
+    report = razer_chroma_extended_matrix_set_custom_frame(0x03, 0x00, 0x15, rgb_row());
+    KUNIT_EXPECT_EQ(test, razer_calculate_crc(&report), 0x5C);
+}
+
+static void razer_crc_skipped_bytes_test(struct kunit *test)
+{
+    struct razer_report report = razer_chroma_standard_set_device_mode(0x03, 0x00);
+    unsigned char crc = razer_calculate_crc(&report);
+
+    // Status, transaction id, CRC and reserved byte are not covered
+    report.status = RAZER_CMD_BUSY;
+    report.transaction_id.id = 0x3F;
+    report.crc = 0xAA;
+    report.reserved = 0x55;
+    KUNIT_EXPECT_EQ(test, razer_calculate_crc(&report), crc);
+
+    report.arguments[79] ^= 0x01;
+    KUNIT_EXPECT_EQ(test, razer_calculate_crc(&report), crc ^ 0x01);
+}
+
+static void razer_get_razer_report_test(struct kunit *test)
+{
+    struct razer_report report = get_razer_report(0x0F, 0x02, 0x05);
+
+    KUNIT_EXPECT_EQ(test, report.status, 0x00);
+    KUNIT_EXPECT_EQ(test, report.transaction_id.id, 0x00);
+    KUNIT_EXPECT_EQ(test, report.remaining_packets, 0x00);
+    KUNIT_EXPECT_EQ(test, report.command_class, 0x0F);
+    KUNIT_EXPECT_EQ(test, report.command_id.id, 0x02);
+    KUNIT_EXPECT_EQ(test, report.data_size, 0x05);
+}
+
+static void razer_clamp_test(struct kunit *test)
+{
+    KUNIT_EXPECT_EQ(test, clamp_u8(0x00, 0x01, 0x03), 0x01);
+    KUNIT_EXPECT_EQ(test, clamp_u8(0x02, 0x01, 0x03), 0x02);
+    KUNIT_EXPECT_EQ(test, clamp_u8(0xFF, 0x01, 0x03), 0x03);
+    KUNIT_EXPECT_EQ(test, clamp_u16(50, 100, 35000), 100);
+    KUNIT_EXPECT_EQ(test, clamp_u16(40000, 100, 35000), 35000);
+}
+
+static struct kunit_case razer_report_test_cases[] = {
+    KUNIT_CASE(razer_crc_empty_test),
+    KUNIT_CASE(razer_crc_golden_test),
+    KUNIT_CASE(razer_crc_skipped_bytes_test),
+    KUNIT_CASE(razer_get_razer_report_test),
+    KUNIT_CASE(razer_clamp_test),
+    {}
+};
+
+static struct kunit_suite razer_report_test_suite = {
+    .name = "razer_report",
+    .test_cases = razer_report_test_cases,
+};
+
+/*
+ * matrix_custom_frame parsing
+ */
+static void razer_parse_valid_test(struct kunit *test)
+{
+    const char buf[] = {
+        0x00, 0x01, 0x02, 0x10, 0x11, 0x12, 0x20, 0x21, 0x22,
+        0x05, 0x03, 0x03, 0x30, 0x31, 0x32,
+    };
+    struct razer_custom_frame_row row;
+    size_t offset = 0;
+
+    KUNIT_ASSERT_EQ(test, razer_parse_custom_frame_row(buf, sizeof(buf), &offset, &row, "razerkunit"), 0);
+    KUNIT_EXPECT_EQ(test, row.row_id, 0x00);
+    KUNIT_EXPECT_EQ(test, row.start_col, 0x01);
+    KUNIT_EXPECT_EQ(test, row.stop_col, 0x02);
+    KUNIT_EXPECT_PTR_EQ(test, row.rgb_data, (unsigned char *)&buf[3]);
+    KUNIT_EXPECT_EQ(test, offset, (size_t)9);
+
+    KUNIT_ASSERT_EQ(test, razer_parse_custom_frame_row(buf, sizeof(buf), &offset, &row, "razerkunit"), 0);
+    KUNIT_EXPECT_EQ(test, row.row_id, 0x05);
+    KUNIT_EXPECT_EQ(test, row.start_col, 0x03);
+    KUNIT_EXPECT_EQ(test, row.stop_col, 0x03);
+    KUNIT_EXPECT_EQ(test, row.rgb_data[2], 0x32);
+    KUNIT_EXPECT_EQ(test, offset, sizeof(buf));
+}
+
+static void razer_parse_short_header_test(struct kunit *test)
+{
+    const char buf[] = { 0x00, 0x00 };
+    struct razer_custom_frame_row row;
+    size_t offset = 0;
+
+    KUNIT_EXPECT_EQ(test, razer_parse_custom_frame_row(buf, sizeof(buf), &offset, &row, "razerkunit"), -EINVAL);
+    KUNIT_EXPECT_EQ(test, offset, (size_t)0);
+}
+
+static void razer_parse_reversed_columns_test(struct kunit *test)
+{
+    const char buf[] = { 0x00, 0x02, 0x01, 0x10, 0x11, 0x12, 0x20, 0x21, 0x22 };
+    struct razer_custom_frame_row row;
+    size_t offset = 0;
+
+    KUNIT_EXPECT_EQ(test, razer_parse_custom_frame_row(buf, sizeof(buf), &offset, &row, "razerkunit"), -EINVAL);
+}
+
+static void razer_parse_short_rgb_test(struct kunit *test)
+{
+    const char buf[] = { 0x00, 0x00, 0x01, 0x10, 0x11, 0x12, 0x20, 0x21 };
+    struct razer_custom_frame_row row;
+    size_t offset = 0;
+
+    KUNIT_EXPECT_EQ(test, razer_parse_custom_frame_row(buf, sizeof(buf), &offset, &row, "razerkunit"), -EINVAL);
+}
+
+static void razer_parse_wide_row_test(struct kunit *test)
+{
+    // 0 - 255 is 768 bytes of RGB, more than fits in an unsigned char length
+    size_t count = 3 + 256 * 3;
+    struct razer_custom_frame_row row;
+    size_t offset = 0;
+    char *buf;
+
+    buf = kunit_kzalloc(test, count, GFP_KERNEL);
+    KUNIT_ASSERT_NOT_NULL(test, buf);
+    buf[2] = (char)0xFF;
+
+    KUNIT_EXPECT_EQ(test, razer_parse_custom_frame_row(buf, count - 1, &offset, &row, "razerkunit"), -EINVAL);
+    KUNIT_EXPECT_EQ(test, razer_parse_custom_frame_row(buf, count, &offset, &row, "razerkunit"), 0);
+    KUNIT_EXPECT_EQ(test, offset, count);
+}
+
+static struct kunit_case razer_parse_test_cases[] = {
+    KUNIT_CASE(razer_parse_valid_test),
+    KUNIT_CASE(razer_parse_short_header_test),
+    KUNIT_CASE(razer_parse_reversed_columns_test),
+    KUNIT_CASE(razer_parse_short_rgb_test),
+    KUNIT_CASE(razer_parse_wide_row_test),
+    {}
+};
+
+static struct kunit_suite razer_parse_test_suite = {
+    .name = "razer_custom_frame_parse",
+    .test_cases = razer_parse_test_cases,
+};
+
+/*
+ * Benchmarks, parse a full matrix_custom_frame write and build its reports in
+ * place like razerkbd does
+ */
+#define RAZER_BENCH_ITERATIONS 1000
+
+static void razer_bench_frame(struct kunit *test, unsigned char rows, unsigned char cols)
+{
+    size_t row_len = 3 + cols * 3;
+    size_t count = rows * row_len;
+    struct razer_custom_frame_row row;
+    struct razer_report *report;
+    unsigned int i, parsed;
+    unsigned char crc = 0;
+    size_t offset;
+    u64 start, elapsed;
+    char *buf;
+
+    buf = kunit_kzalloc(test, count, GFP_KERNEL);
+    KUNIT_ASSERT_NOT_NULL(test, buf);
+    report = kunit_kzalloc(test, sizeof(*report), GFP_KERNEL);
+    KUNIT_ASSERT_NOT_NULL(test, report);
+
+    for (i = 0; i < rows; i++) {
+        buf[i * row_len] = i;
+        buf[i * row_len + 2] = cols - 1;
+    }
+
+    start = ktime_get_ns();
+    for (i = 0; i < RAZER_BENCH_ITERATIONS; i++) {
+        offset = 0;
+        parsed = 0;
+
+        while (offset < count) {
+            KUNIT_ASSERT_EQ(test, razer_parse_custom_frame_row(buf, count, &offset, &row, "razerkunit"), 0);
+            razer_chroma_extended_matrix_build_custom_frame(report, row.row_id, row.start_col, row.stop_col, row.rgb_data, 0x47);
+            report->transaction_id.id = 0x1F;
+            crc += razer_calculate_crc(report);
+            parsed++;
+        }
+
+        KUNIT_ASSERT_EQ(test, parsed, (unsigned int)rows);
+    }
+    elapsed = ktime_get_ns() - start;
+
+    kunit_info(test, "%ux%u frame: %llu ns per frame (checksum %02x)\n", rows, cols, div_u64(elapsed, RAZER_BENCH_ITERATIONS), crc);
+}
+
+static void razer_bench_6x22_test(struct kunit *test)
+{
+    razer_bench_frame(test, 6, 22);
+}
+
+static void razer_bench_9x25_test(struct kunit *test)
+{
+    razer_bench_frame(test, 9, 25);
+}
+
+static struct kunit_case razer_bench_test_cases[] = {
+    KUNIT_CASE(razer_bench_6x22_test),
+    KUNIT_CASE(razer_bench_9x25_test),
+    {}
+};
+
+static struct kunit_suite razer_bench_test_suite = {
+    .name = "razer_custom_frame_bench",
+    .test_cases = razer_bench_test_cases,
+};
+
+kunit_test_suites(&razer_builder_test_suite, &razer_report_test_suite, &razer_parse_test_suite, &razer_bench_test_suite);
+
+MODULE_DESCRIPTION("KUnit tests for the OpenRazer report builders");
+MODULE_LICENSE(DRIVER_LICENSE);
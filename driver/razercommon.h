@@ -154,6 +154,13 @@ struct razer_argb_report {
     unsigned char color_data[315];
 };
 
+struct razer_custom_frame_row {
+    unsigned char row_id;
+    unsigned char start_col;
+    unsigned char stop_col;
+    unsigned char *rgb_data;
+};
+
 struct razer_key_translation {
     u16 from;
     u16 to;
@@ -161,13 +168,17 @@ struct razer_key_translation {
 };
 
 int razer_send_control_msg(struct usb_device *usb_dev,void const *data, unsigned int report_index, unsigned long wait_min, unsigned long wait_max);
+int razer_send_control_msg_dma(struct usb_device *usb_dev, struct razer_report *report, unsigned int report_index, unsigned long wait_min, unsigned long wait_max);
 int razer_send_control_msg_old_device(struct usb_device *usb_dev,void const *data, uint report_value, uint report_index, uint report_size, ulong wait_min, ulong wait_max);
 int razer_get_usb_response(struct usb_device *usb_dev, unsigned int report_index, struct razer_report* request_report, unsigned int response_index, struct razer_report* response_report, unsigned long wait_min, unsigned long wait_max);
+int razer_read_usb_response(struct usb_device *usb_dev, unsigned int response_index, struct razer_report* response_report);
+int razer_read_usb_response_dma(struct usb_device *usb_dev, unsigned int response_index, struct razer_report* response_report);
 int razer_send_argb_msg(struct usb_device* usb_dev, unsigned char channel, unsigned char size, void const* data);
 unsigned char razer_calculate_crc(struct razer_report *report);
 struct razer_report get_razer_report(unsigned char command_class, unsigned char command_id, unsigned char data_size);
 struct razer_report get_empty_razer_report(void);
 void print_erroneous_report(struct razer_report* report, char* driver_name, char* message);
+int razer_parse_custom_frame_row(const char *buf, size_t count, size_t *offset, struct razer_custom_frame_row *row, const char *driver_name);
 
 // Convenience functions
 unsigned char clamp_u8(unsigned char value, unsigned char min, unsigned char max);
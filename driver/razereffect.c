@@ -0,0 +1,572 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Software effect engine for matrix devices
+ */
+
+#include <linux/kernel.h>
+#include <linux/slab.h>
+#include <linux/random.h>
+#include <linux/ktime.h>
+#include <linux/version.h>
+
+#include "razereffect.h"
+
+/* Same palette the daemon uses for random ripple colours */
+static const struct razer_rgb razer_effect_random_colours[] = {
+    { 0xFF, 0x00, 0x00 },
+    { 0x00, 0xFF, 0x00 },
+    { 0x00, 0x00, 0xFF },
+    { 0xFF, 0xFF, 0x00 },
+    { 0x00, 0xFF, 0xFF },
+    { 0xFF, 0x00, 0xFF },
+};
+
+/* Hue wheel in fixed point, 256 steps per sixth */
+#define RAZER_EFFECT_HUE_MAX (6 * 256)
+
+/**
+ * Convert a fixed point hue (0 - RAZER_EFFECT_HUE_MAX) to full saturation RGB
+ */
+static void razer_effect_hue_to_rgb(unsigned int hue, unsigned char *rgb)
+{
+    unsigned char x = hue & 0xFF;
+
+    switch (hue >> 8) {
+    case 0:
+        rgb[0] = 0xFF;
+        rgb[1] = x;
+        rgb[2] = 0x00;
+        break;
+    case 1:
+        rgb[0] = 0xFF - x;
+        rgb[1] = 0xFF;
+        rgb[2] = 0x00;
+        break;
+    case 2:
+        rgb[0] = 0x00;
+        rgb[1] = 0xFF;
+        rgb[2] = x;
+        break;
+    case 3:
+        rgb[0] = 0x00;
+        rgb[1] = 0xFF - x;
+        rgb[2] = 0xFF;
+        break;
+    case 4:
+        rgb[0] = x;
+        rgb[1] = 0x00;
+        rgb[2] = 0xFF;
+        break;
+    default:
+        rgb[0] = 0xFF;
+        rgb[1] = 0x00;
+        rgb[2] = 0xFF - x;
+        break;
+    }
+}
+
+/**
+ * Check whether a ripple is still on screen
+ */
+static bool razer_effect_ripple_alive(const struct razer_effect_ripple *ripple, ktime_t now)
+{
+    s64 elapsed = ktime_ms_delta(now, ripple->start);
+
+    return ripple->start && elapsed >= 0 && elapsed < RAZER_EFFECT_RIPPLE_LIFETIME_MS;
+}
+
+/**
+ * Render all live ripples, oldest first
+ *
+ * Positions and radii are in 1/256 key units so the ring test only needs
+ * squared distances, no square roots.
+ *
+ * Returns true if at least one ripple is still alive.
+ */
+static bool razer_effect_render_ripple(struct razer_effect_engine *engine, unsigned char rows, unsigned char cols, const struct razer_effect_ripple *ripples, unsigned int oldest, ktime_t now)
+{
+    s64 outer_sq[RAZER_EFFECT_MAX_RIPPLES];
+    s64 inner_sq[RAZER_EFFECT_MAX_RIPPLES];
+    unsigned int order[RAZER_EFFECT_MAX_RIPPLES];
+    unsigned int alive = 0;
+    unsigned int row, col, i, idx;
+
+    for (i = 0; i < RAZER_EFFECT_MAX_RIPPLES; i++) {
+        s64 outer, inner;
+
+        idx = (oldest + i) % RAZER_EFFECT_MAX_RIPPLES;
+        if (!razer_effect_ripple_alive(&ripples[idx], now))
+            continue;
+
+        outer = div_s64(ktime_ms_delta(now, ripples[idx].start) * RAZER_EFFECT_RIPPLE_SPEED * 256, 1000);
+        inner = outer - RAZER_EFFECT_RIPPLE_WIDTH * 256;
+        outer_sq[alive] = outer * outer;
+        inner_sq[alive] = inner > 0 ? inner * inner : 0;
+        order[alive] = idx;
+        alive++;
+    }
+
+    memset(engine->frame, 0, sizeof(engine->frame));
+    if (!alive)
+        return false;
+
+    for (row = 0; row < rows; row++) {
+        for (col = 0; col < cols; col++) {
+            unsigned char *rgb = &engine->frame[row][col * 3];
+
+            for (i = 0; i < alive; i++) {
+                const struct razer_effect_ripple *ripple = &ripples[order[i]];
+                s64 dr = ((s64)ripple->row - row) * 256;
+                s64 dc = ((s64)ripple->col - col) * 256;
+                s64 dist_sq = dr * dr + dc * dc;
+
+                if (dist_sq <= outer_sq[i] && dist_sq >= inner_sq[i]) {
+                    rgb[0] = ripple->colour.r;
+                    rgb[1] = ripple->colour.g;
+                    rgb[2] = ripple->colour.b;
+                    break;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Render a rainbow wave travelling across the columns
+ *
+ * speed is the number of hue steps the wave advances every 10ms
+ */
+static void razer_effect_render_wave(struct razer_effect_engine *engine, unsigned char rows, unsigned char cols, unsigned char direction, unsigned char speed, s64 elapsed_ms)
+{
+    unsigned int step = RAZER_EFFECT_HUE_MAX / cols;
+    unsigned int row, col, hue;
+    u32 phase;
+
+    div_u64_rem((u64)div_s64(elapsed_ms, 10) * speed, RAZER_EFFECT_HUE_MAX, &phase);
+
+    for (col = 0; col < cols; col++) {
+        if (direction == 0x01) // Right
+            hue = (col * step + RAZER_EFFECT_HUE_MAX - phase) % RAZER_EFFECT_HUE_MAX;
+        else
+            hue = (col * step + phase) % RAZER_EFFECT_HUE_MAX;
+
+        razer_effect_hue_to_rgb(hue, &engine->frame[0][col * 3]);
+    }
+
+    for (row = 1; row < rows; row++)
+        memcpy(engine->frame[row], engine->frame[0], cols * 3);
+}
+
+/**
+ * Render the fade from the frame shown when the fade started to the target colour
+ *
+ * Returns true once the target colour has been reached.
+ */
+static bool razer_effect_render_fade(struct razer_effect_engine *engine, unsigned char rows, unsigned char cols, struct razer_rgb *target, unsigned int duration_ms, s64 elapsed_ms)
+{
+    unsigned int progress = 256;
+    unsigned int row, col;
+
+    if (duration_ms && elapsed_ms < duration_ms)
+        progress = (unsigned int)div_s64(elapsed_ms * 256, duration_ms);
+
+    for (row = 0; row < rows; row++) {
+        for (col = 0; col < cols; col++) {
+            const unsigned char *from = &engine->fade_from[row][col * 3];
+            unsigned char *rgb = &engine->frame[row][col * 3];
+
+            rgb[0] = from[0] + (((int)target->r - from[0]) * (int)progress) / 256;
+            rgb[1] = from[1] + (((int)target->g - from[1]) * (int)progress) / 256;
+            rgb[2] = from[2] + (((int)target->b - from[2]) * (int)progress) / 256;
+        }
+    }
+
+    return progress >= 256;
+}
+
+/**
+ * Send the rendered frame to the device
+ */
+static void razer_effect_commit(struct razer_effect_engine *engine, unsigned char rows, unsigned char cols)
+{
+    unsigned int row;
+
+    for (row = 0; row < rows; row++) {
+        if (engine->ops->set_row(engine->data, row, 0, cols - 1, engine->frame[row]))
+            return;
+    }
+
+    engine->ops->show(engine->data);
+}
+
+/**
+ * Frame worker, renders and commits one frame
+ *
+ * The effect parameters are snapshotted under the lock so the (slow) USB
+ * transfers happen without holding it.
+ */
+static void razer_effect_work(struct work_struct *work)
+{
+    struct razer_effect_engine *engine = container_of(work, struct razer_effect_engine, work);
+    struct razer_effect_ripple ripples[RAZER_EFFECT_MAX_RIPPLES];
+    struct razer_rgb colour;
+    unsigned char mode, rows, cols, direction, speed;
+    unsigned int duration_ms, oldest;
+    bool fade_snapshot, done = false;
+    unsigned long flags;
+    ktime_t now;
+    s64 elapsed_ms;
+
+    spin_lock_irqsave(&engine->lock, flags);
+    if (!engine->running) {
+        spin_unlock_irqrestore(&engine->lock, flags);
+        return;
+    }
+    now = ktime_get();
+    mode = engine->mode;
+    rows = engine->rows;
+    cols = engine->cols;
+    colour = engine->colour;
+    direction = engine->direction;
+    speed = engine->speed;
+    duration_ms = engine->duration_ms;
+    fade_snapshot = engine->fade_snapshot;
+    engine->fade_snapshot = false;
+    elapsed_ms = ktime_ms_delta(now, engine->start);
+    memcpy(ripples, engine->ripples, sizeof(ripples));
+    oldest = engine->ripple_next;
+    spin_unlock_irqrestore(&engine->lock, flags);
+
+    switch (mode) {
+    case RAZER_EFFECT_RIPPLE:
+        if (!razer_effect_render_ripple(engine, rows, cols, ripples, oldest, now)) {
+            // Nothing left to draw, commit one blank frame then go idle until the next key press
+            done = engine->frame_blank;
+            engine->frame_blank = true;
+        } else {
+            engine->frame_blank = false;
+        }
+        break;
+
+    case RAZER_EFFECT_WAVE:
+        razer_effect_render_wave(engine, rows, cols, direction, speed, elapsed_ms);
+        engine->frame_blank = false;
+        break;
+
+    case RAZER_EFFECT_FADE:
+        if (fade_snapshot)
+            memcpy(engine->fade_from, engine->frame, sizeof(engine->fade_from));
+        done = razer_effect_render_fade(engine, rows, cols, &colour, duration_ms, elapsed_ms);
+        engine->frame_blank = false;
+        break;
+
+    default:
+        return;
+    }
+
+    if (done) {
+        spin_lock_irqsave(&engine->lock, flags);
+        // A key press may have raced in a new ripple, keep going in that case
+        if (mode != RAZER_EFFECT_RIPPLE || !razer_effect_ripple_alive(&engine->ripples[(engine->ripple_next + RAZER_EFFECT_MAX_RIPPLES - 1) % RAZER_EFFECT_MAX_RIPPLES], ktime_get()))
+            engine->running = false;
+        spin_unlock_irqrestore(&engine->lock, flags);
+
+        if (mode == RAZER_EFFECT_RIPPLE)
+            return;
+    }
+
+    razer_effect_commit(engine, rows, cols);
+}
+
+/**
+ * Frame timer callback, runs in interrupt context so only kicks the worker
+ *
+ * If the previous frame is still being sent the tick is dropped instead
+ * of queueing up behind it.
+ */
+static enum hrtimer_restart razer_effect_tick(struct hrtimer *timer)
+{
+    struct razer_effect_engine *engine = container_of(timer, struct razer_effect_engine, timer);
+
+    if (!READ_ONCE(engine->running))
+        return HRTIMER_NORESTART;
+
+    queue_work(system_highpri_wq, &engine->work);
+    hrtimer_forward_now(timer, ms_to_ktime(READ_ONCE(engine->period_ms)));
+    return HRTIMER_RESTART;
+}
+
+/**
+ * Start the frame timer, must be called with the lock held
+ */
+static void razer_effect_start_locked(struct razer_effect_engine *engine)
+{
+    engine->running = true;
+    hrtimer_start(&engine->timer, 0, HRTIMER_MODE_REL);
+}
+
+/**
+ * Allocate an engine for a device, it starts out disabled
+ */
+struct razer_effect_engine *razer_effect_create(const struct razer_effect_ops *ops, void *data)
+{
+    struct razer_effect_engine *engine;
+
+    engine = kzalloc(sizeof(struct razer_effect_engine), GFP_KERNEL);
+    if (engine == NULL)
+        return NULL;
+
+    engine->ops = ops;
+    engine->data = data;
+    engine->period_ms = RAZER_EFFECT_PERIOD_DEFAULT_MS;
+    engine->frame_blank = true;
+    memset(engine->keymap, 0xFF, sizeof(engine->keymap));
+
+    spin_lock_init(&engine->lock);
+    INIT_WORK(&engine->work, razer_effect_work);
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 13, 0)
+    hrtimer_setup(&engine->timer, razer_effect_tick, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+#else
+    hrtimer_init(&engine->timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    engine->timer.function = razer_effect_tick;
+#endif
+
+    return engine;
+}
+
+/**
+ * Stop the timer and wait for any frame in flight, keeping the last frame
+ */
+static void razer_effect_halt(struct razer_effect_engine *engine)
+{
+    unsigned long flags;
+
+    spin_lock_irqsave(&engine->lock, flags);
+    engine->mode = RAZER_EFFECT_OFF;
+    engine->running = false;
+    spin_unlock_irqrestore(&engine->lock, flags);
+
+    hrtimer_cancel(&engine->timer);
+    cancel_work_sync(&engine->work);
+}
+
+/**
+ * Stop the engine and wait for any frame in flight
+ *
+ * Called when the device switches to another effect, so the last frame no
+ * longer is what's shown and the next fade starts from black.
+ *
+ * Must not be called with the device lock held, as the frame worker takes it.
+ */
+void razer_effect_stop(struct razer_effect_engine *engine)
+{
+    if (engine == NULL)
+        return;
+
+    razer_effect_halt(engine);
+
+    // The worker is idle, nothing else touches the frame
+    memset(engine->frame, 0, sizeof(engine->frame));
+    engine->frame_blank = true;
+}
+
+void razer_effect_destroy(struct razer_effect_engine *engine)
+{
+    if (engine == NULL)
+        return;
+
+    razer_effect_stop(engine);
+    kfree(engine);
+}
+
+/**
+ * Set the matrix size and the key code to matrix position table
+ *
+ * Format
+ * ROWS COLS [KEY_CODE_HI KEY_CODE_LO ROW COL]...
+ */
+int razer_effect_set_keymap(struct razer_effect_engine *engine, const unsigned char *buf, size_t count)
+{
+    unsigned long flags;
+    unsigned char rows, cols;
+    unsigned int code;
+    size_t offset;
+
+    if (count < 2 || (count - 2) % 4) {
+        printk(KERN_WARNING "razereffect: Keymap must be ROWS COLS followed by 4 byte entries\n");
+        return -EINVAL;
+    }
+
+    rows = buf[0];
+    cols = buf[1];
+    if (rows == 0 || cols == 0 || rows > RAZER_EFFECT_MAX_ROWS || cols > RAZER_EFFECT_MAX_COLS) {
+        printk(KERN_WARNING "razereffect: Unsupported matrix size %ux%u\n", rows, cols);
+        return -EINVAL;
+    }
+
+    for (offset = 2; offset < count; offset += 4) {
+        code = (buf[offset] << 8) | buf[offset + 1];
+        if (code >= KEY_CNT || buf[offset + 2] >= rows || buf[offset + 3] >= cols) {
+            printk(KERN_WARNING "razereffect: Invalid keymap entry %u -> %u,%u\n", code, buf[offset + 2], buf[offset + 3]);
+            return -EINVAL;
+        }
+    }
+
+    razer_effect_stop(engine);
+
+    spin_lock_irqsave(&engine->lock, flags);
+    engine->rows = rows;
+    engine->cols = cols;
+    memset(engine->keymap, 0xFF, sizeof(engine->keymap));
+    for (offset = 2; offset < count; offset += 4) {
+        code = (buf[offset] << 8) | buf[offset + 1];
+        engine->keymap[code] = (buf[offset + 2] << 8) | buf[offset + 3];
+    }
+    spin_unlock_irqrestore(&engine->lock, flags);
+
+    return 0;
+}
+
+/**
+ * Select and start an effect
+ *
+ * Format
+ * 0x00                                  Off
+ * 0x01 PERIOD_MS                        Ripple in random colours
+ * 0x01 RED GREEN BLUE PERIOD_MS         Ripple in a single colour
+ * 0x02 DIRECTION SPEED PERIOD_MS        Wave, direction 1 right 2 left
+ * 0x03 RED GREEN BLUE DURATION PERIOD_MS Fade to colour, duration in 1/10s
+ *
+ * A PERIOD_MS of 0 selects the default frame rate.
+ */
+int razer_effect_configure(struct razer_effect_engine *engine, const unsigned char *buf, size_t count)
+{
+    unsigned long flags;
+    unsigned char mode;
+    unsigned int period_ms;
+
+    if (count < 1)
+        return -EINVAL;
+
+    mode = buf[0];
+    if ((mode == RAZER_EFFECT_OFF && count != 1) ||
+        (mode == RAZER_EFFECT_RIPPLE && count != 2 && count != 5) ||
+        (mode == RAZER_EFFECT_WAVE && count != 4) ||
+        (mode == RAZER_EFFECT_FADE && count != 6) ||
+        mode > RAZER_EFFECT_FADE) {
+        printk(KERN_WARNING "razereffect: Wrong amount of data provided for effect %u\n", mode);
+        return -EINVAL;
+    }
+
+    if (mode == RAZER_EFFECT_WAVE && buf[1] != 0x01 && buf[1] != 0x02) {
+        printk(KERN_WARNING "razereffect: Wave direction must be 1 or 2\n");
+        return -EINVAL;
+    }
+
+    if (mode == RAZER_EFFECT_OFF) {
+        razer_effect_stop(engine);
+        return 0;
+    }
+
+    // Keep the last frame, a fade from the running effect starts from it
+    razer_effect_halt(engine);
+
+    if (engine->rows == 0) {
+        printk(KERN_WARNING "razereffect: Matrix size has not been set\n");
+        return -EINVAL;
+    }
+
+    period_ms = buf[count - 1];
+    if (period_ms == 0)
+        period_ms = RAZER_EFFECT_PERIOD_DEFAULT_MS;
+    else if (period_ms < RAZER_EFFECT_PERIOD_MIN_MS)
+        period_ms = RAZER_EFFECT_PERIOD_MIN_MS;
+
+    spin_lock_irqsave(&engine->lock, flags);
+    engine->mode = mode;
+    engine->period_ms = period_ms;
+    engine->start = ktime_get();
+
+    switch (mode) {
+    case RAZER_EFFECT_RIPPLE:
+        engine->random_colour = (count == 2);
+        if (count == 5) {
+            engine->colour.r = buf[1];
+            engine->colour.g = buf[2];
+            engine->colour.b = buf[3];
+        }
+        memset(engine->ripples, 0, sizeof(engine->ripples));
+        // Clear the matrix, the worker goes idle until the first key press after that
+        engine->frame_blank = false;
+        razer_effect_start_locked(engine);
+        break;
+
+    case RAZER_EFFECT_WAVE:
+        engine->direction = buf[1];
+        engine->speed = buf[2];
+        razer_effect_start_locked(engine);
+        break;
+
+    case RAZER_EFFECT_FADE:
+        engine->colour.r = buf[1];
+        engine->colour.g = buf[2];
+        engine->colour.b = buf[3];
+        engine->duration_ms = buf[4] * 100;
+        engine->fade_snapshot = true;
+        razer_effect_start_locked(engine);
+        break;
+    }
+    spin_unlock_irqrestore(&engine->lock, flags);
+
+    return 0;
+}
+
+unsigned char razer_effect_get_mode(struct razer_effect_engine *engine)
+{
+    return READ_ONCE(engine->mode);
+}
+
+/**
+ * Feed a key event from the input path, safe to call from interrupt context
+ */
+void razer_effect_key_event(struct razer_effect_engine *engine, unsigned int code, int value)
+{
+    struct razer_effect_ripple *ripple;
+    unsigned long flags;
+    unsigned char choice;
+    u16 position;
+
+    // Only key down starts a ripple, not release or autorepeat
+    if (engine == NULL || value != 1 || code >= KEY_CNT)
+        return;
+
+    spin_lock_irqsave(&engine->lock, flags);
+    position = engine->keymap[code];
+    if (engine->mode != RAZER_EFFECT_RIPPLE || position == RAZER_EFFECT_KEY_UNMAPPED) {
+        spin_unlock_irqrestore(&engine->lock, flags);
+        return;
+    }
+
+    ripple = &engine->ripples[engine->ripple_next];
+    engine->ripple_next = (engine->ripple_next + 1) % RAZER_EFFECT_MAX_RIPPLES;
+
+    ripple->start = ktime_get();
+    ripple->row = position >> 8;
+    ripple->col = position & 0xFF;
+
+    if (engine->random_colour) {
+        // Never pick the same colour twice in a row
+        get_random_bytes(&choice, sizeof(choice));
+        choice = (engine->last_colour + 1 + choice % (ARRAY_SIZE(razer_effect_random_colours) - 1)) % ARRAY_SIZE(razer_effect_random_colours);
+        engine->last_colour = choice;
+        ripple->colour = razer_effect_random_colours[choice];
+    } else {
+        ripple->colour = engine->colour;
+    }
+
+    if (!engine->running)
+        razer_effect_start_locked(engine);
+    spin_unlock_irqrestore(&engine->lock, flags);
+}
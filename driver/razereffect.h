@@ -0,0 +1,107 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+/*
+ * Software effect engine for matrix devices
+ *
+ * Renders ripple, wave and fade effects in the driver on a per-device
+ * hrtimer and commits each frame through the device's custom frame path,
+ * so userspace only has to configure the effect.
+ */
+
+#ifndef DRIVER_RAZEREFFECT_H_
+#define DRIVER_RAZEREFFECT_H_
+
+#include <linux/hrtimer.h>
+#include <linux/workqueue.h>
+#include <linux/spinlock.h>
+
+#include "razercommon.h"
+
+// Covers the largest keyboard matrices (9x22 and 6x25)
+#define RAZER_EFFECT_MAX_ROWS 9
+#define RAZER_EFFECT_MAX_COLS 25
+
+#define RAZER_EFFECT_MAX_RIPPLES 16
+#define RAZER_EFFECT_KEY_UNMAPPED 0xFFFF
+
+#define RAZER_EFFECT_PERIOD_MIN_MS 16
+#define RAZER_EFFECT_PERIOD_DEFAULT_MS 40
+
+// Ripples grow at 24 keys per second, are 2 keys wide and live for 2 seconds
+#define RAZER_EFFECT_RIPPLE_SPEED 24
+#define RAZER_EFFECT_RIPPLE_WIDTH 2
+#define RAZER_EFFECT_RIPPLE_LIFETIME_MS 2000
+
+enum razer_effect_mode {
+    RAZER_EFFECT_OFF = 0x00,
+    RAZER_EFFECT_RIPPLE = 0x01,
+    RAZER_EFFECT_WAVE = 0x02,
+    RAZER_EFFECT_FADE = 0x03,
+};
+
+/*
+ * Callbacks into the owning driver, called from process context.
+ *
+ * set_row sends one matrix row (same arguments as the set_custom_frame
+ * builders), show switches the device to the custom frame effect.
+ */
+struct razer_effect_ops {
+    int (*set_row)(void *data, unsigned char row_id, unsigned char start_col, unsigned char stop_col, unsigned char *rgb_data);
+    int (*show)(void *data);
+};
+
+struct razer_effect_ripple {
+    ktime_t start;
+    unsigned char row;
+    unsigned char col;
+    struct razer_rgb colour;
+};
+
+struct razer_effect_engine {
+    const struct razer_effect_ops *ops;
+    void *data;
+
+    struct hrtimer timer;
+    struct work_struct work;
+
+    /* Protects everything below except the frame buffers */
+    spinlock_t lock;
+    bool running;
+
+    unsigned char mode;
+    unsigned char rows;
+    unsigned char cols;
+    unsigned int period_ms;
+    ktime_t start;
+
+    bool random_colour;
+    unsigned char last_colour;
+    struct razer_rgb colour;
+
+    unsigned char direction;
+    unsigned char speed;
+    unsigned int duration_ms;
+    bool fade_snapshot;
+
+    struct razer_effect_ripple ripples[RAZER_EFFECT_MAX_RIPPLES];
+    unsigned int ripple_next;
+
+    /* (row << 8) | col for each evdev key code */
+    u16 keymap[KEY_CNT];
+
+    /* Only touched by the frame worker */
+    bool frame_blank;
+    unsigned char frame[RAZER_EFFECT_MAX_ROWS][RAZER_EFFECT_MAX_COLS * 3];
+    unsigned char fade_from[RAZER_EFFECT_MAX_ROWS][RAZER_EFFECT_MAX_COLS * 3];
+};
+
+struct razer_effect_engine *razer_effect_create(const struct razer_effect_ops *ops, void *data);
+void razer_effect_destroy(struct razer_effect_engine *engine);
+
+int razer_effect_set_keymap(struct razer_effect_engine *engine, const unsigned char *buf, size_t count);
+int razer_effect_configure(struct razer_effect_engine *engine, const unsigned char *buf, size_t count);
+unsigned char razer_effect_get_mode(struct razer_effect_engine *engine);
+void razer_effect_stop(struct razer_effect_engine *engine);
+
+void razer_effect_key_event(struct razer_effect_engine *engine, unsigned int code, int value);
+
+#endif /* DRIVER_RAZEREFFECT_H_ */
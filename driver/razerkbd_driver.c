@@ -17,6 +17,7 @@
 #include "razerkbd_driver.h"
 #include "razercommon.h"
 #include "razerchromacommon.h"
+#include "razereffect.h"
 
 /*
  * Version Information
@@ -357,31 +358,26 @@ static int razer_send_payload_no_response(struct razer_kbd_device *device, struc
 {
     uint report_index, response_index;
     ulong wait_min, wait_max;
+    int err;
 
     /* Except the caller to have set the transaction_id */
     WARN_ON(request->transaction_id.id == 0x00);
 
     razer_get_report_params(device->usb_dev, &report_index, &response_index, &wait_min, &wait_max);
-    return razer_send_control_msg(device->usb_dev, request, report_index, wait_min, wait_max);
+
+    // Don't land between another command's request and response, e.g. from the effect engine
+    mutex_lock(&device->lock);
+    err = razer_send_control_msg(device->usb_dev, request, report_index, wait_min, wait_max);
+    mutex_unlock(&device->lock);
+
+    return err;
 }
 
 /**
- * Function to send to device, get response, and actually check the response
+ * Check the response belongs to the request and was successful
  */
-static int razer_send_payload(struct razer_kbd_device *device, struct razer_report *request, struct razer_report *response)
+static int razer_check_response(struct razer_report *request, struct razer_report *response)
 {
-    int err;
-
-    request->crc = razer_calculate_crc(request);
-
-    mutex_lock(&device->lock);
-    err = razer_get_report(device->usb_dev, request, response);
-    mutex_unlock(&device->lock);
-    if (err) {
-        print_erroneous_report(response, "razerkbd", "Invalid Report Length");
-        return err;
-    }
-
     /* Check the packet number, class and command are the same */
     if (response->remaining_packets != request->remaining_packets ||
         response->command_class != request->command_class ||
@@ -409,6 +405,26 @@ static int razer_send_payload(struct razer_kbd_device *device, struct razer_repo
     return 0;
 }
 
+/**
+ * Function to send to device, get response, and actually check the response
+ */
+static int razer_send_payload(struct razer_kbd_device *device, struct razer_report *request, struct razer_report *response)
+{
+    int err;
+
+    request->crc = razer_calculate_crc(request);
+
+    mutex_lock(&device->lock);
+    err = razer_get_report(device->usb_dev, request, response);
+    mutex_unlock(&device->lock);
+    if (err) {
+        print_erroneous_report(response, "razerkbd", "Invalid Report Length");
+        return err;
+    }
+
+    return razer_check_response(request, response);
+}
+
 /**
  * Reads the physical layout of the keyboard.
  *
@@ -1353,6 +1369,8 @@ static ssize_t razer_attr_write_matrix_effect_pulsate(struct device *dev, struct
     struct razer_report request = {0};
     struct razer_report response = {0};
 
+    razer_effect_stop(device->effect);
+
     switch (device->usb_pid) {
     case USB_DEVICE_ID_RAZER_BLACKWIDOW_STEALTH:
     case USB_DEVICE_ID_RAZER_BLACKWIDOW_STEALTH_EDITION:
@@ -1618,6 +1636,8 @@ static ssize_t razer_attr_write_matrix_effect_none(struct device *dev, struct de
     struct razer_report request = {0};
     struct razer_report response = {0};
 
+    razer_effect_stop(device->effect);
+
     switch (device->usb_pid) {
     case USB_DEVICE_ID_RAZER_BLACKWIDOW_LITE:
     case USB_DEVICE_ID_RAZER_ORNATA:
@@ -1709,6 +1729,8 @@ static ssize_t razer_attr_write_matrix_effect_wave(struct device *dev, struct de
     struct razer_report request = {0};
     struct razer_report response = {0};
 
+    razer_effect_stop(device->effect);
+
     switch (device->usb_pid) {
     case USB_DEVICE_ID_RAZER_ORNATA:
     case USB_DEVICE_ID_RAZER_ORNATA_CHROMA:
@@ -1795,6 +1817,8 @@ static ssize_t razer_attr_write_matrix_effect_wheel(struct device *dev, struct d
     struct razer_report request = {0};
     struct razer_report response = {0};
 
+    razer_effect_stop(device->effect);
+
     switch(device->usb_pid) {
     case USB_DEVICE_ID_RAZER_BLACKWIDOW_V4:
     case USB_DEVICE_ID_RAZER_BLACKWIDOW_V4_X:
@@ -1824,6 +1848,8 @@ static ssize_t razer_attr_write_matrix_effect_spectrum(struct device *dev, struc
     struct razer_report request = {0};
     struct razer_report response = {0};
 
+    razer_effect_stop(device->effect);
+
     switch (device->usb_pid) {
     case USB_DEVICE_ID_RAZER_ORNATA:
     case USB_DEVICE_ID_RAZER_ORNATA_CHROMA:
@@ -1918,6 +1944,8 @@ static ssize_t razer_attr_write_matrix_effect_reactive(struct device *dev, struc
     struct razer_report response = {0};
     unsigned char speed;
 
+    razer_effect_stop(device->effect);
+
     if (count != 4) {
         printk(KERN_WARNING "razerkbd: Reactive only accepts Speed, RGB (4byte)\n");
         return -EINVAL;
@@ -2002,6 +2030,8 @@ static ssize_t razer_attr_write_matrix_effect_static(struct device *dev, struct
     struct razer_report request = {0};
     struct razer_report response = {0};
 
+    razer_effect_stop(device->effect);
+
     switch (device->usb_pid) {
     case USB_DEVICE_ID_RAZER_ORBWEAVER:
     case USB_DEVICE_ID_RAZER_DEATHSTALKER_ESSENTIAL:
@@ -2203,6 +2233,8 @@ static ssize_t razer_attr_write_matrix_effect_starlight(struct device *dev, stru
     struct razer_report request = {0};
     struct razer_report response = {0};
 
+    razer_effect_stop(device->effect);
+
     switch (device->usb_pid) {
     case USB_DEVICE_ID_RAZER_ORNATA:
         if (count != 4) {
@@ -2367,6 +2399,8 @@ static ssize_t razer_attr_write_matrix_effect_breath(struct device *dev, struct
     struct razer_report request = {0};
     struct razer_report response = {0};
 
+    razer_effect_stop(device->effect);
+
     switch (device->usb_pid) {
     case USB_DEVICE_ID_RAZER_BLACKWIDOW_LITE:
     case USB_DEVICE_ID_RAZER_ORNATA:
@@ -2631,13 +2665,10 @@ static ssize_t razer_attr_write_logo_led_state(struct device *dev, struct device
 }
 
 /**
- * Write device file "matrix_effect_custom"
- *
- * Sets the keyboard to custom mode whenever the file is written to
+ * Switch the keyboard to the custom frame effect
  */
-static ssize_t razer_attr_write_matrix_effect_custom(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
+static int razer_kbd_send_custom_effect(struct razer_kbd_device *device)
 {
-    struct razer_kbd_device *device = dev_get_drvdata(dev);
     struct razer_report request = {0};
     struct razer_report response = {0};
     bool want_response = true;
@@ -2711,12 +2742,24 @@ static ssize_t razer_attr_write_matrix_effect_custom(struct device *dev, struct
         break;
     }
 
-    /* See comment in razer_attr_write_matrix_custom_frame for want_response */
+    /* See comment in razer_kbd_send_custom_frame_row for want_response */
     if (want_response)
-        razer_send_payload(device, &request, &response);
+        return razer_send_payload(device, &request, &response);
     else
-        razer_send_payload_no_response(device, &request);
+        return razer_send_payload_no_response(device, &request);
+}
 
+/**
+ * Write device file "matrix_effect_custom"
+ *
+ * Sets the keyboard to custom mode whenever the file is written to
+ */
+static ssize_t razer_attr_write_matrix_effect_custom(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
+{
+    struct razer_kbd_device *device = dev_get_drvdata(dev);
+
+    razer_effect_stop(device->effect);
+    razer_kbd_send_custom_effect(device);
     return count;
 }
 
@@ -3017,6 +3060,154 @@ static ssize_t razer_attr_read_device_mode(struct device *dev, struct device_att
     return 2;
 }
 
+/**
+ * Send one row of a custom frame to the keyboard
+ */
+static int razer_kbd_send_custom_frame_row(struct razer_kbd_device *device, unsigned char row_id, unsigned char start_col, unsigned char stop_col, unsigned char *rgb_data)
+{
+    struct razer_report *request = &device->frame_buf[0];
+    struct razer_report *response = &device->frame_buf[1];
+    uint report_index, response_index;
+    ulong wait_min, wait_max;
+    bool want_response = true;
+    int err;
+
+    // The report is built straight in the DMA buffer, so it is sent without another copy
+    mutex_lock(&device->lock);
+
+    switch (device->usb_pid) {
+    case USB_DEVICE_ID_RAZER_ORNATA:
+    case USB_DEVICE_ID_RAZER_ORNATA_CHROMA:
+    case USB_DEVICE_ID_RAZER_HUNTSMAN_ELITE:
+    case USB_DEVICE_ID_RAZER_HUNTSMAN_TE:
+    case USB_DEVICE_ID_RAZER_HUNTSMAN_MINI:
+    case USB_DEVICE_ID_RAZER_HUNTSMAN_MINI_JP:
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_2019:
+    case USB_DEVICE_ID_RAZER_HUNTSMAN:
+    case USB_DEVICE_ID_RAZER_CYNOSA_CHROMA:
+    case USB_DEVICE_ID_RAZER_CYNOSA_CHROMA_PRO:
+    case USB_DEVICE_ID_RAZER_DEATHSTALKER_V2:
+    case USB_DEVICE_ID_RAZER_DEATHSTALKER_V2_PRO_WIRED:
+    case USB_DEVICE_ID_RAZER_DEATHSTALKER_V2_PRO_TKL_WIRED:
+        razer_chroma_extended_matrix_build_custom_frame(request, row_id, start_col, stop_col, rgb_data, 0x47);
+        request->transaction_id.id = 0x3F;
+        break;
+
+    case USB_DEVICE_ID_RAZER_TARTARUS_V2:
+    case USB_DEVICE_ID_RAZER_TARTARUS_PRO:
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_ELITE:
+    case USB_DEVICE_ID_RAZER_CYNOSA_V2:
+    case USB_DEVICE_ID_RAZER_ORNATA_V2:
+    case USB_DEVICE_ID_RAZER_ORNATA_V3:
+    case USB_DEVICE_ID_RAZER_ORNATA_V3_ALT:
+    case USB_DEVICE_ID_RAZER_ORNATA_V3_X:
+    case USB_DEVICE_ID_RAZER_ORNATA_V3_X_ALT:
+    case USB_DEVICE_ID_RAZER_ORNATA_V3_TENKEYLESS:
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V3:
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_TK:
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_PRO_WIRED:
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_MINI:
+    case USB_DEVICE_ID_RAZER_HUNTSMAN_V2_TENKEYLESS:
+    case USB_DEVICE_ID_RAZER_HUNTSMAN_V2:
+    case USB_DEVICE_ID_RAZER_HUNTSMAN_V2_ANALOG:
+    case USB_DEVICE_ID_RAZER_HUNTSMAN_MINI_ANALOG:
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V4_X:
+        razer_chroma_extended_matrix_build_custom_frame(request, row_id, start_col, stop_col, rgb_data, 0x47);
+        request->transaction_id.id = 0x1F;
+        break;
+
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V4:
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V4_PRO:
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V4_75PCT:
+        razer_chroma_extended_matrix_build_custom_frame(request, row_id, start_col, stop_col, rgb_data, 0x47);
+        request->transaction_id.id = 0x1F;
+        want_response = false;
+        break;
+
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_PRO_WIRELESS:
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_MINI_WIRELESS:
+    case USB_DEVICE_ID_RAZER_DEATHSTALKER_V2_PRO_WIRELESS:
+    case USB_DEVICE_ID_RAZER_DEATHSTALKER_V2_PRO_TKL_WIRELESS:
+        razer_chroma_extended_matrix_build_custom_frame(request, row_id, start_col, stop_col, rgb_data, 0x47);
+        request->transaction_id.id = 0x9F;
+        break;
+
+    case USB_DEVICE_ID_RAZER_DEATHSTALKER_CHROMA:
+        razer_chroma_misc_one_row_build_custom_frame(request, start_col, stop_col, rgb_data);
+        request->transaction_id.id = 0xFF;
+        break;
+
+    case USB_DEVICE_ID_RAZER_BLADE_LATE_2016:
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_CHROMA_V2:
+    case USB_DEVICE_ID_RAZER_ORBWEAVER_CHROMA:
+        razer_chroma_standard_matrix_build_custom_frame(request, row_id, start_col, stop_col, rgb_data);
+        request->transaction_id.id = 0x3F;
+        break;
+
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_X_ULTIMATE:
+    case USB_DEVICE_ID_RAZER_BLACKWIDOW_ULTIMATE_2016:
+    case USB_DEVICE_ID_RAZER_BLADE_STEALTH:
+    case USB_DEVICE_ID_RAZER_BLADE_STEALTH_LATE_2016:
+    case USB_DEVICE_ID_RAZER_BLADE_STEALTH_MID_2017:
+    case USB_DEVICE_ID_RAZER_BLADE_STEALTH_LATE_2017:
+    case USB_DEVICE_ID_RAZER_BLADE_STEALTH_2019:
+    case USB_DEVICE_ID_RAZER_BLADE_QHD:
+    case USB_DEVICE_ID_RAZER_BLADE_PRO_LATE_2016:
+    case USB_DEVICE_ID_RAZER_BLADE_2018:
+    case USB_DEVICE_ID_RAZER_BLADE_2018_MERCURY:
+    case USB_DEVICE_ID_RAZER_BLADE_2018_BASE:
+    case USB_DEVICE_ID_RAZER_BLADE_2019_ADV:
+    case USB_DEVICE_ID_RAZER_BLADE_MID_2019_MERCURY:
+    case USB_DEVICE_ID_RAZER_BLADE_STUDIO_EDITION_2019:
+    case USB_DEVICE_ID_RAZER_BLADE_PRO_2017:
+    case USB_DEVICE_ID_RAZER_BLADE_PRO_2017_FULLHD:
+    case USB_DEVICE_ID_RAZER_BLADE_PRO_LATE_2019:
+    case USB_DEVICE_ID_RAZER_BLADE_ADV_LATE_2019:
+    case USB_DEVICE_ID_RAZER_BLADE_PRO_EARLY_2020:
+    case USB_DEVICE_ID_RAZER_BLADE_15_ADV_2020:
+    case USB_DEVICE_ID_RAZER_BLADE_15_ADV_MID_2021:
+    case USB_DEVICE_ID_RAZER_BLADE_17_PRO_EARLY_2021:
+    case USB_DEVICE_ID_RAZER_BLADE_17_PRO_MID_2021:
+    case USB_DEVICE_ID_RAZER_BLADE_15_ADV_EARLY_2021:
+    case USB_DEVICE_ID_RAZER_BLADE_14_2021:
+    case USB_DEVICE_ID_RAZER_BLADE_15_ADV_EARLY_2022:
+        // FIXME this seems not to do anything?
+        request->transaction_id.id = 0x80; // Fall into the 2016/blade/blade2016 to set device id
+        fallthrough;
+    default:
+        razer_chroma_standard_matrix_build_custom_frame(request, row_id, start_col, stop_col, rgb_data);
+        request->transaction_id.id = 0xFF;
+        break;
+    }
+
+    /*
+     * Some devices don't like us asking for responses for custom frame
+     * requests. And in any case it shouldn't be necessary for most devices
+     * but let's keep it enabled by default for now to not potentially
+     * break anything.
+     */
+    razer_get_report_params(device->usb_dev, &report_index, &response_index, &wait_min, &wait_max);
+
+    if (!want_response) {
+        err = razer_send_control_msg_dma(device->usb_dev, request, report_index, wait_min, wait_max);
+        mutex_unlock(&device->lock);
+        return err;
+    }
+
+    request->crc = razer_calculate_crc(request);
+    err = razer_send_control_msg_dma(device->usb_dev, request, report_index, wait_min, wait_max);
+    if (!err) {
+        err = razer_read_usb_response_dma(device->usb_dev, response_index, response);
+        if (err)
+            print_erroneous_report(response, "razerkbd", "Invalid Report Length");
+        else
+            err = razer_check_response(request, response);
+    }
+
+    mutex_unlock(&device->lock);
+    return err;
+}
+
 /**
  * Write device file "matrix_custom_frame"
  *
@@ -3026,160 +3217,83 @@ static ssize_t razer_attr_read_device_mode(struct device *dev, struct device_att
 static ssize_t razer_attr_write_matrix_custom_frame(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
 {
     struct razer_kbd_device *device = dev_get_drvdata(dev);
-    struct razer_report request = {0};
-    struct razer_report response = {0};
+    struct razer_custom_frame_row row;
     size_t offset = 0;
-    unsigned char row_id;
-    unsigned char start_col;
-    unsigned char stop_col;
-    unsigned char row_length;
-    bool want_response = true;
+
+    razer_effect_stop(device->effect);
 
     //printk(KERN_ALERT "razerkbd: Total count: %d\n", (unsigned char)count);
 
     while(offset < count) {
-        if(offset + 3 > count) {
-            printk(KERN_ALERT "razerkbd: Wrong Amount of data provided: Should be ROW_ID, START_COL, STOP_COL, N_RGB\n");
+        if (razer_parse_custom_frame_row(buf, count, &offset, &row, "razerkbd"))
             return -EINVAL;
-        }
 
-        row_id = buf[offset++];
-        start_col = buf[offset++];
-        stop_col = buf[offset++];
-        row_length = ((stop_col+1) - start_col) * 3;
-
-        // printk(KERN_ALERT "razerkbd: Row ID: %d, Start: %d, Stop: %d, row length: %d\n", row_id, start_col, stop_col, row_length);
+        razer_kbd_send_custom_frame_row(device, row.row_id, row.start_col, row.stop_col, row.rgb_data);
+    }
 
-        if(start_col > stop_col) {
-            printk(KERN_ALERT "razerkbd: Start column is greater than end column\n");
-            return -EINVAL;
-        }
+    return count;
+}
 
-        if(offset + row_length > count) {
-            printk(KERN_ALERT "razerkbd: Not enough RGB to fill row\n");
-            return -EINVAL;
-        }
+static int razer_kbd_effect_set_row(void *data, unsigned char row_id, unsigned char start_col, unsigned char stop_col, unsigned char *rgb_data)
+{
+    return razer_kbd_send_custom_frame_row(data, row_id, start_col, stop_col, rgb_data);
+}
 
-        // Offset now at beginning of RGB data
-        switch (device->usb_pid) {
-        case USB_DEVICE_ID_RAZER_ORNATA:
-        case USB_DEVICE_ID_RAZER_ORNATA_CHROMA:
-        case USB_DEVICE_ID_RAZER_HUNTSMAN_ELITE:
-        case USB_DEVICE_ID_RAZER_HUNTSMAN_TE:
-        case USB_DEVICE_ID_RAZER_HUNTSMAN_MINI:
-        case USB_DEVICE_ID_RAZER_HUNTSMAN_MINI_JP:
-        case USB_DEVICE_ID_RAZER_BLACKWIDOW_2019:
-        case USB_DEVICE_ID_RAZER_HUNTSMAN:
-        case USB_DEVICE_ID_RAZER_CYNOSA_CHROMA:
-        case USB_DEVICE_ID_RAZER_CYNOSA_CHROMA_PRO:
-        case USB_DEVICE_ID_RAZER_DEATHSTALKER_V2:
-        case USB_DEVICE_ID_RAZER_DEATHSTALKER_V2_PRO_WIRED:
-        case USB_DEVICE_ID_RAZER_DEATHSTALKER_V2_PRO_TKL_WIRED:
-            request = razer_chroma_extended_matrix_set_custom_frame(row_id, start_col, stop_col, (unsigned char*)&buf[offset]);
-            request.transaction_id.id = 0x3F;
-            break;
+static int razer_kbd_effect_show(void *data)
+{
+    return razer_kbd_send_custom_effect(data);
+}
 
-        case USB_DEVICE_ID_RAZER_TARTARUS_V2:
-        case USB_DEVICE_ID_RAZER_TARTARUS_PRO:
-        case USB_DEVICE_ID_RAZER_BLACKWIDOW_ELITE:
-        case USB_DEVICE_ID_RAZER_CYNOSA_V2:
-        case USB_DEVICE_ID_RAZER_ORNATA_V2:
-        case USB_DEVICE_ID_RAZER_ORNATA_V3:
-        case USB_DEVICE_ID_RAZER_ORNATA_V3_ALT:
-        case USB_DEVICE_ID_RAZER_ORNATA_V3_X:
-        case USB_DEVICE_ID_RAZER_ORNATA_V3_X_ALT:
-        case USB_DEVICE_ID_RAZER_ORNATA_V3_TENKEYLESS:
-        case USB_DEVICE_ID_RAZER_BLACKWIDOW_V3:
-        case USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_TK:
-        case USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_PRO_WIRED:
-        case USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_MINI:
-        case USB_DEVICE_ID_RAZER_HUNTSMAN_V2_TENKEYLESS:
-        case USB_DEVICE_ID_RAZER_HUNTSMAN_V2:
-        case USB_DEVICE_ID_RAZER_HUNTSMAN_V2_ANALOG:
-        case USB_DEVICE_ID_RAZER_HUNTSMAN_MINI_ANALOG:
-        case USB_DEVICE_ID_RAZER_BLACKWIDOW_V4_X:
-            request = razer_chroma_extended_matrix_set_custom_frame(row_id, start_col, stop_col, (unsigned char*)&buf[offset]);
-            request.transaction_id.id = 0x1F;
-            break;
+static const struct razer_effect_ops razer_kbd_effect_ops = {
+    .set_row = razer_kbd_effect_set_row,
+    .show = razer_kbd_effect_show,
+};
 
-        case USB_DEVICE_ID_RAZER_BLACKWIDOW_V4:
-        case USB_DEVICE_ID_RAZER_BLACKWIDOW_V4_PRO:
-        case USB_DEVICE_ID_RAZER_BLACKWIDOW_V4_75PCT:
-            request = razer_chroma_extended_matrix_set_custom_frame(row_id, start_col, stop_col, (unsigned char*)&buf[offset]);
-            request.transaction_id.id = 0x1F;
-            want_response = false;
-            break;
+/**
+ * Read device file "soft_effect"
+ *
+ * Returns the running software effect, 0 if none
+ */
+static ssize_t razer_attr_read_soft_effect(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    struct razer_kbd_device *device = dev_get_drvdata(dev);
 
-        case USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_PRO_WIRELESS:
-        case USB_DEVICE_ID_RAZER_BLACKWIDOW_V3_MINI_WIRELESS:
-        case USB_DEVICE_ID_RAZER_DEATHSTALKER_V2_PRO_WIRELESS:
-        case USB_DEVICE_ID_RAZER_DEATHSTALKER_V2_PRO_TKL_WIRELESS:
-            request = razer_chroma_extended_matrix_set_custom_frame(row_id, start_col, stop_col, (unsigned char*)&buf[offset]);
-            request.transaction_id.id = 0x9F;
-            break;
+    return sprintf(buf, "%u\n", razer_effect_get_mode(device->effect));
+}
 
-        case USB_DEVICE_ID_RAZER_DEATHSTALKER_CHROMA:
-            request = razer_chroma_misc_one_row_set_custom_frame(start_col, stop_col, (unsigned char*)&buf[offset]);
-            request.transaction_id.id = 0xFF;
-            break;
+/**
+ * Write device file "soft_effect"
+ *
+ * Starts an effect rendered by the driver, see razer_effect_configure for the format
+ */
+static ssize_t razer_attr_write_soft_effect(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
+{
+    struct razer_kbd_device *device = dev_get_drvdata(dev);
+    int err;
 
-        case USB_DEVICE_ID_RAZER_BLADE_LATE_2016:
-        case USB_DEVICE_ID_RAZER_BLACKWIDOW_CHROMA_V2:
-        case USB_DEVICE_ID_RAZER_ORBWEAVER_CHROMA:
-            request = razer_chroma_standard_matrix_set_custom_frame(row_id, start_col, stop_col, (unsigned char*)&buf[offset]);
-            request.transaction_id.id = 0x3F;
-            break;
+    err = razer_effect_configure(device->effect, (const unsigned char*)buf, count);
+    if (err)
+        return err;
 
-        case USB_DEVICE_ID_RAZER_BLACKWIDOW_X_ULTIMATE:
-        case USB_DEVICE_ID_RAZER_BLACKWIDOW_ULTIMATE_2016:
-        case USB_DEVICE_ID_RAZER_BLADE_STEALTH:
-        case USB_DEVICE_ID_RAZER_BLADE_STEALTH_LATE_2016:
-        case USB_DEVICE_ID_RAZER_BLADE_STEALTH_MID_2017:
-        case USB_DEVICE_ID_RAZER_BLADE_STEALTH_LATE_2017:
-        case USB_DEVICE_ID_RAZER_BLADE_STEALTH_2019:
-        case USB_DEVICE_ID_RAZER_BLADE_QHD:
-        case USB_DEVICE_ID_RAZER_BLADE_PRO_LATE_2016:
-        case USB_DEVICE_ID_RAZER_BLADE_2018:
-        case USB_DEVICE_ID_RAZER_BLADE_2018_MERCURY:
-        case USB_DEVICE_ID_RAZER_BLADE_2018_BASE:
-        case USB_DEVICE_ID_RAZER_BLADE_2019_ADV:
-        case USB_DEVICE_ID_RAZER_BLADE_MID_2019_MERCURY:
-        case USB_DEVICE_ID_RAZER_BLADE_STUDIO_EDITION_2019:
-        case USB_DEVICE_ID_RAZER_BLADE_PRO_2017:
-        case USB_DEVICE_ID_RAZER_BLADE_PRO_2017_FULLHD:
-        case USB_DEVICE_ID_RAZER_BLADE_PRO_LATE_2019:
-        case USB_DEVICE_ID_RAZER_BLADE_ADV_LATE_2019:
-        case USB_DEVICE_ID_RAZER_BLADE_PRO_EARLY_2020:
-        case USB_DEVICE_ID_RAZER_BLADE_15_ADV_2020:
-        case USB_DEVICE_ID_RAZER_BLADE_15_ADV_MID_2021:
-        case USB_DEVICE_ID_RAZER_BLADE_17_PRO_EARLY_2021:
-        case USB_DEVICE_ID_RAZER_BLADE_17_PRO_MID_2021:
-        case USB_DEVICE_ID_RAZER_BLADE_15_ADV_EARLY_2021:
-        case USB_DEVICE_ID_RAZER_BLADE_14_2021:
-        case USB_DEVICE_ID_RAZER_BLADE_15_ADV_EARLY_2022:
-            // FIXME this seems not to do anything?
-            request.transaction_id.id = 0x80; // Fall into the 2016/blade/blade2016 to set device id
-            fallthrough;
-        default:
-            request = razer_chroma_standard_matrix_set_custom_frame(row_id, start_col, stop_col, (unsigned char*)&buf[offset]);
-            request.transaction_id.id = 0xFF;
-            break;
-        }
+    return count;
+}
 
-        /*
-         * Some devices don't like us asking for responses for custom frame
-         * requests. And in any case it shouldn't be necessary for most devices
-         * but let's keep it enabled by default for now to not potentially
-         * break anything.
-         */
-        if (want_response)
-            razer_send_payload(device, &request, &response);
-        else
-            razer_send_payload_no_response(device, &request);
+/**
+ * Write device file "soft_effect_keymap"
+ *
+ * Sets the matrix size and key positions used by the software effects
+ *
+ * Format
+ * ROWS COLS [KEY_CODE_HI KEY_CODE_LO ROW COL]...
+ */
+static ssize_t razer_attr_write_soft_effect_keymap(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
+{
+    struct razer_kbd_device *device = dev_get_drvdata(dev);
+    int err;
 
-        // *3 as its 3 bytes per col (RGB)
-        offset += row_length;
-    }
+    err = razer_effect_set_keymap(device->effect, (const unsigned char*)buf, count);
+    if (err)
+        return err;
 
     return count;
 }
@@ -3402,6 +3516,8 @@ static DEVICE_ATTR(matrix_effect_pulsate,   0660, razer_attr_read_matrix_effect_
 static DEVICE_ATTR(matrix_brightness,       0660, razer_attr_read_matrix_brightness,          razer_attr_write_matrix_brightness);
 static DEVICE_ATTR(matrix_effect_custom,    0220, NULL,                                       razer_attr_write_matrix_effect_custom);
 static DEVICE_ATTR(matrix_custom_frame,     0220, NULL,                                       razer_attr_write_matrix_custom_frame);
+static DEVICE_ATTR(soft_effect,             0660, razer_attr_read_soft_effect,                razer_attr_write_soft_effect);
+static DEVICE_ATTR(soft_effect_keymap,      0220, NULL,                                       razer_attr_write_soft_effect_keymap);
 
 static DEVICE_ATTR(key_super,               0660, razer_attr_read_key_super,                  razer_attr_write_key_super);
 static DEVICE_ATTR(key_alt_tab,             0660, razer_attr_read_key_alt_tab,                razer_attr_write_key_alt_tab);
@@ -3413,6 +3529,53 @@ static DEVICE_ATTR(charge_effect,           0220, NULL,
 static DEVICE_ATTR(charge_colour,           0220, NULL,                                       razer_attr_write_charge_colour);
 static DEVICE_ATTR(charge_low_threshold,    0660, razer_attr_read_charge_low_threshold,       razer_attr_write_charge_low_threshold);
 
+/*
+ * Bound interfaces, so key presses on a keyboard interface can reach the
+ * effect engine on the control interface of the same device
+ */
+static DEFINE_SPINLOCK(razer_kbd_link_lock);
+static LIST_HEAD(razer_kbd_devices);
+
+/**
+ * Add a bound interface and link it to the other interfaces of its device
+ */
+static void razer_kbd_link(struct razer_kbd_device *dev)
+{
+    struct razer_kbd_device *other;
+    unsigned long flags;
+
+    spin_lock_irqsave(&razer_kbd_link_lock, flags);
+    list_for_each_entry(other, &razer_kbd_devices, link) {
+        if (other->usb_dev != dev->usb_dev)
+            continue;
+
+        if (dev->effect != NULL)
+            other->control = dev;
+        else if (other->effect != NULL)
+            dev->control = other;
+    }
+    list_add(&dev->link, &razer_kbd_devices);
+    spin_unlock_irqrestore(&razer_kbd_link_lock, flags);
+}
+
+/**
+ * Remove an interface, after this no other interface uses it
+ */
+static void razer_kbd_unlink(struct razer_kbd_device *dev)
+{
+    struct razer_kbd_device *other;
+    unsigned long flags;
+
+    spin_lock_irqsave(&razer_kbd_link_lock, flags);
+    list_del(&dev->link);
+    dev->control = NULL;
+    list_for_each_entry(other, &razer_kbd_devices, link) {
+        if (other->control == dev)
+            other->control = NULL;
+    }
+    spin_unlock_irqrestore(&razer_kbd_link_lock, flags);
+}
+
 /**
  * Deal with FN toggle
  */
@@ -3420,6 +3583,15 @@ static int razer_event(struct hid_device *hdev, struct hid_field *field, struct
 {
     struct razer_kbd_device *device = hid_get_drvdata(hdev);
     const struct razer_key_translation *translation;
+    unsigned long flags;
+
+    // Feed key presses to the effect engine on the control interface
+    if (device->usb_interface_protocol == USB_INTERFACE_PROTOCOL_KEYBOARD && usage->type == EV_KEY) {
+        spin_lock_irqsave(&razer_kbd_link_lock, flags);
+        if (device->control)
+            razer_effect_key_event(device->control->effect, usage->code, value);
+        spin_unlock_irqrestore(&razer_kbd_link_lock, flags);
+    }
 
     // No translations needed on the Blades
     if (is_blade_laptop(device)) {
@@ -3850,6 +4022,7 @@ static void razer_kbd_init(struct razer_kbd_device *dev, struct usb_interface *i
 
     // Initialise mutex
     mutex_init(&dev->lock);
+    INIT_LIST_HEAD(&dev->link);
     // Setup values
     dev->usb_dev = usb_dev;
     dev->usb_vid = usb_dev->descriptor.idVendor;
@@ -3866,6 +4039,7 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
     struct usb_interface *intf = to_usb_interface(hdev->dev.parent);
     struct usb_device *usb_dev = interface_to_usbdev(intf);
     struct razer_kbd_device *dev = NULL;
+    bool soft_effect = false;
 
     dev = kzalloc(sizeof(struct razer_kbd_device), GFP_KERNEL);
     if(dev == NULL) {
@@ -3934,6 +4108,9 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_wave);            // Wave effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            soft_effect = true;
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             break;
 
         case USB_DEVICE_ID_RAZER_BLACKWIDOW_LITE:
@@ -3996,6 +4173,9 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            soft_effect = true;
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4009,6 +4189,9 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            soft_effect = true;
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4032,6 +4215,9 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            soft_effect = true;
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4072,6 +4258,9 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            soft_effect = true;
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4086,6 +4275,9 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_breath);          // Breathing effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            soft_effect = true;
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4102,6 +4294,9 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            soft_effect = true;
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4120,6 +4315,9 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            soft_effect = true;
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4137,6 +4335,9 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            soft_effect = true;
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4162,6 +4363,9 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            soft_effect = true;
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4178,6 +4382,9 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            soft_effect = true;
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4196,6 +4403,9 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_reactive);        // Reactive effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            soft_effect = true;
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_wave);            // Wave effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_starlight);       // Starlight effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_spectrum);        // Spectrum effect
@@ -4219,6 +4429,9 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            soft_effect = true;
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             break;
 
         case USB_DEVICE_ID_RAZER_BLADE_LATE_2016:
@@ -4231,6 +4444,9 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            soft_effect = true;
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_fn_toggle);                     // Sets whether FN is requires for F-Keys
             break;
 
@@ -4248,6 +4464,9 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            soft_effect = true;
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_fn_toggle);                     // Sets whether FN is requires for F-Keys
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_logo_led_state);                // Enable/Disable the logo
             break;
@@ -4283,6 +4502,9 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            soft_effect = true;
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_logo_led_state);                // Enable/Disable the logo
             break;
 
@@ -4294,6 +4516,9 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            soft_effect = true;
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             break;
 
         case USB_DEVICE_ID_RAZER_BLACKWIDOW_CHROMA:
@@ -4312,12 +4537,26 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            soft_effect = true;
+            CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             CREATE_DEVICE_FILE(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
             break;
         }
 
+        // Only matrix devices send custom frames, the rest don't need the engine and its buffers
+        if (soft_effect) {
+            dev->effect = razer_effect_create(&razer_kbd_effect_ops, dev);
+            dev->frame_buf = kcalloc(2, sizeof(struct razer_report), GFP_KERNEL);
+            if(dev->effect == NULL || dev->frame_buf == NULL) {
+                dev_err(&intf->dev, "out of memory\n");
+                retval = -ENOMEM;
+                goto exit_free;
+            }
+        }
+
         // Set device to regular mode, not driver mode
         // When the daemon discovers the device it will instruct it to enter driver mode
         razer_set_device_mode(dev, 0x00, 0x00);
@@ -4340,6 +4579,8 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
         goto exit_free;
     }
 
+    razer_kbd_link(dev);
+
     // Leave autosuspend on for laptops
     if (!is_blade_laptop(dev)) {
         usb_disable_autosuspend(usb_dev);
@@ -4350,6 +4591,8 @@ static int razer_kbd_probe(struct hid_device *hdev, const struct hid_device_id *
     return 0;
 
 exit_free:
+    razer_effect_destroy(dev->effect);
+    kfree(dev->frame_buf);
     kfree(dev);
     return retval;
 }
@@ -4365,6 +4608,10 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
 
     dev = hid_get_drvdata(hdev);
 
+    // No key presses reach the effect engine once this returns, so it can be freed
+    razer_kbd_unlink(dev);
+    razer_effect_stop(dev->effect);
+
     // Other interfaces are actual key-emitting devices
     if(intf->cur_altsetting->desc.bInterfaceProtocol == USB_INTERFACE_PROTOCOL_MOUSE) {
         // If the currently bound device is the control (mouse) interface
@@ -4423,6 +4670,8 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_wave);            // Wave effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             break;
 
         case USB_DEVICE_ID_RAZER_BLACKWIDOW_LITE:
@@ -4485,6 +4734,8 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             device_remove_file(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4498,6 +4749,8 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             device_remove_file(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4521,6 +4774,8 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             device_remove_file(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4561,6 +4816,8 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             device_remove_file(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4575,6 +4832,8 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_breath);          // Breathing effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             device_remove_file(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4591,6 +4850,8 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             device_remove_file(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4609,6 +4870,8 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             device_remove_file(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4626,6 +4889,8 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             device_remove_file(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4651,6 +4916,8 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             device_remove_file(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4667,6 +4934,8 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             device_remove_file(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4684,6 +4953,8 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_reactive);        // Reactive effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_wave);            // Wave effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_starlight);       // Starlight effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_spectrum);        // Spectrum effect
@@ -4702,6 +4973,8 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_reactive);        // Reactive effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_wave);            // Wave effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_starlight);       // Starlight effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_spectrum);        // Spectrum effect
@@ -4724,6 +4997,8 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             break;
 
         case USB_DEVICE_ID_RAZER_BLADE_LATE_2016:
@@ -4736,6 +5011,8 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             device_remove_file(&hdev->dev, &dev_attr_fn_toggle);                     // Sets whether FN is requires for F-Keys
             break;
 
@@ -4753,6 +5030,8 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             device_remove_file(&hdev->dev, &dev_attr_fn_toggle);                     // Sets whether FN is requires for F-Keys
             device_remove_file(&hdev->dev, &dev_attr_logo_led_state);                // Enable/Disable the logo
             break;
@@ -4788,6 +5067,8 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             device_remove_file(&hdev->dev, &dev_attr_logo_led_state);                // Enable/Disable the logo
             break;
 
@@ -4799,6 +5080,8 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             break;
 
         case USB_DEVICE_ID_RAZER_BLACKWIDOW_CHROMA:
@@ -4817,6 +5100,8 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_static);          // Static effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_effect_custom);          // Custom effect
             device_remove_file(&hdev->dev, &dev_attr_matrix_custom_frame);           // Set LED matrix
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect);                   // Driver rendered effect
+            device_remove_file(&hdev->dev, &dev_attr_soft_effect_keymap);            // Key positions for driver rendered effects
             device_remove_file(&hdev->dev, &dev_attr_game_led_state);                // Enable game mode & LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_state);               // Enable macro LED
             device_remove_file(&hdev->dev, &dev_attr_macro_led_effect);              // Change macro LED effect (static, flashing)
@@ -4828,7 +5113,10 @@ static void razer_kbd_disconnect(struct hid_device *hdev)
         device_remove_file(&hdev->dev, &dev_attr_key_alt_f4);
     }
 
+    // Stops the effect again in case a write restarted it before its file was removed
+    razer_effect_destroy(dev->effect);
     hid_hw_stop(hdev);
+    kfree(dev->frame_buf);
     kfree(dev);
     dev_info(&intf->dev, "Razer Device disconnected\n");
 }
@@ -4986,3 +5274,7 @@ static struct hid_driver razer_kbd_driver = {
 };
 
 module_hid_driver(razer_kbd_driver);
+
+#ifdef RAZER_KUNIT
+#include "razerkbd_kunit.c"
+#endif
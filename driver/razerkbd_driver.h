@@ -172,6 +172,15 @@ struct razer_kbd_device {
 
     unsigned char block_keys[3];
     unsigned char left_alt_on;
+
+    struct razer_effect_engine *effect;
+
+    /* DMA-able request and response for custom frame rows, protected by lock */
+    struct razer_report *frame_buf;
+
+    /* Control interface of the same device, protected by razer_kbd_link_lock */
+    struct list_head link;
+    struct razer_kbd_device *control;
 };
 
 #endif
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * KUnit tests for the razerkbd key translation tables
+ *
+ * Included at the end of razerkbd_driver.c when built with RAZER_KUNIT=y so
+ * the static tables can be reached. The suite runs when razerkbd.ko is
+ * loaded into a kernel with CONFIG_KUNIT.
+ */
+
+#include <kunit/test.h>
+
+struct razer_key_table_case {
+    const char *name;
+    const struct razer_key_translation *table;
+};
+
+static const struct razer_key_table_case razer_key_table_cases[] = {
+    { "chroma_keys", chroma_keys },
+    { "chroma_keys_2", chroma_keys_2 },
+    { "chroma_keys_3", chroma_keys_3 },
+    { "chroma_keys_4", chroma_keys_4 },
+    { "chroma_keys_5", chroma_keys_5 },
+    { "chroma_keys_6", chroma_keys_6 },
+};
+
+static void razer_key_table_case_desc(const struct razer_key_table_case *c, char *desc)
+{
+    strscpy(desc, c->name, KUNIT_PARAM_DESC_SIZE);
+}
+
+KUNIT_ARRAY_PARAM(razer_key_table, razer_key_table_cases, razer_key_table_case_desc);
+
+static void razer_key_table_entries_test(struct kunit *test)
+{
+    const struct razer_key_table_case *c = test->param_value;
+    const struct razer_key_translation *entry, *other;
+
+    for (entry = c->table; entry->from; entry++) {
+        KUNIT_EXPECT_NE_MSG(test, entry->to, 0, "%s: key %u maps to nothing", c->name, entry->from);
+        KUNIT_EXPECT_LT(test, entry->to, (u16)KEY_CNT);
+
+        // A duplicate would never be reached by find_translation
+        for (other = entry + 1; other->from; other++)
+            KUNIT_EXPECT_NE_MSG(test, entry->from, other->from, "%s: key %u listed twice", c->name, entry->from);
+
+        KUNIT_EXPECT_PTR_EQ(test, find_translation(c->table, entry->from), entry);
+    }
+}
+
+static void razer_key_table_miss_test(struct kunit *test)
+{
+    const struct razer_key_table_case *c = test->param_value;
+
+    // No table remaps the space bar
+    KUNIT_EXPECT_NULL(test, find_translation(c->table, KEY_SPACE));
+    KUNIT_EXPECT_NULL(test, find_translation(c->table, 0));
+}
+
+static void razer_key_table_spot_check_test(struct kunit *test)
+{
+    KUNIT_EXPECT_EQ(test, find_translation(chroma_keys, KEY_F1)->to, KEY_MUTE);
+    KUNIT_EXPECT_EQ(test, find_translation(chroma_keys, KEY_F9)->to, RAZER_MACRO_KEY);
+    KUNIT_EXPECT_EQ(test, find_translation(chroma_keys_2, KEY_RIGHTALT)->to, RAZER_MACRO_KEY);
+    KUNIT_EXPECT_EQ(test, find_translation(chroma_keys_3, KEY_ESC)->to, KEY_GRAVE);
+    KUNIT_EXPECT_EQ(test, find_translation(chroma_keys_4, KEY_RIGHTALT)->to, KEY_BLUETOOTH);
+    KUNIT_EXPECT_EQ(test, find_translation(chroma_keys_5, KEY_F12)->to, RAZER_BRIGHTNESS_UP);
+    KUNIT_EXPECT_EQ(test, find_translation(chroma_keys_6, KEY_DELETE)->to, KEY_SLEEP);
+}
+
+static struct kunit_case razer_key_table_test_cases[] = {
+    KUNIT_CASE_PARAM(razer_key_table_entries_test, razer_key_table_gen_params),
+    KUNIT_CASE_PARAM(razer_key_table_miss_test, razer_key_table_gen_params),
+    KUNIT_CASE(razer_key_table_spot_check_test),
+    {}
+};
+
+static struct kunit_suite razer_key_table_test_suite = {
+    .name = "razerkbd_key_table",
+    .test_cases = razer_key_table_test_cases,
+};
+
+kunit_test_suite(razer_key_table_test_suite);
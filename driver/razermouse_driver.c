@@ -11,6 +11,7 @@
 #include <linux/hid.h>
 #include <linux/hrtimer.h>
 #include <linux/random.h>
+#include <linux/version.h>
 
 #include "razermouse_driver.h"
 #include "razercommon.h"
@@ -97,6 +98,134 @@ static int razer_get_report(struct usb_device *usb_dev, struct razer_report *req
     }
 }
 
+/**
+ * Check if a response read back from a receiver answers the request
+ */
+static bool razer_receiver_response_ready(struct razer_report *request, struct razer_report *response)
+{
+    return response->transaction_id.id == request->transaction_id.id &&
+           response->command_class == request->command_class &&
+           response->command_id.id == request->command_id.id &&
+           response->status != RAZER_CMD_BUSY;
+}
+
+/**
+ * Send a report over a shared receiver pipe
+ *
+ * Every transfer on a shared receiver has to go through here or
+ * razer_receiver_read, so it can't land between another command's
+ * SET_REPORT and GET_REPORT.
+ */
+static int razer_receiver_send(struct razer_mouse_device *device, struct razer_report *request)
+{
+    int err;
+
+    mutex_lock(&device->receiver.pipe_lock);
+    err = razer_send_control_msg(device->usb_dev, request, 0, 0, 0);
+    mutex_unlock(&device->receiver.pipe_lock);
+
+    return err;
+}
+
+/**
+ * Read the pending response from a shared receiver pipe
+ */
+static int razer_receiver_read(struct razer_mouse_device *device, struct razer_report *response)
+{
+    int err;
+
+    mutex_lock(&device->receiver.pipe_lock);
+    err = razer_read_usb_response(device->usb_dev, 0, response);
+    mutex_unlock(&device->receiver.pipe_lock);
+
+    return err;
+}
+
+/**
+ * Get the in-flight slot of a receiver command
+ *
+ * The receiver answers pairing and its indicator LED itself, everything else
+ * is forwarded to the paired device. Each of them only keeps the response to
+ * its last command, so each gets one command in flight. Transaction ids
+ * can't tell them apart, nearly all commands use 0x1F or 0xFF.
+ */
+static unsigned int razer_receiver_slot(struct razer_report *request)
+{
+    switch ((request->command_class << 8) | request->command_id.id) {
+    case 0x0041: // Pair
+    case 0x0042: // Unpair
+    case 0x0046: // Pairing mode
+    case 0x0710: // Indicator LED mode
+        return RAZER_RECEIVER_SLOT_RECEIVER;
+
+    default:
+        return RAZER_RECEIVER_SLOT_PAIRED;
+    }
+}
+
+/**
+ * Get how often a receiver command is sent before giving up
+ *
+ * Only get commands are resent when no response arrived, sending a set
+ * command again could e.g. pair twice.
+ */
+static int razer_receiver_max_sends(struct razer_report *request)
+{
+    // Get commands have the high bit of the command id set
+    return (request->command_id.id & 0x80) ? RAZER_RECEIVER_MAX_SENDS : 1;
+}
+
+/**
+ * Send report to a receiver with several paired devices
+ *
+ * The receiver and the paired devices share one control pipe. Only the
+ * transfers hold the pipe, the wait for the response happens outside it so
+ * a command for the receiver can be sent while the paired device is still
+ * busy. Commands for the same device are serialised, see razer_receiver_slot.
+ *
+ * Returns -ETIMEDOUT if no response to the request arrived in time.
+ */
+static int razer_receiver_get_report(struct razer_mouse_device *device, struct razer_report *request, struct razer_report *response)
+{
+    unsigned int slot = razer_receiver_slot(request);
+    int sends = razer_receiver_max_sends(request);
+    ktime_t deadline;
+    int attempt;
+    int err = 0;
+
+    wait_event(device->receiver.idle, !test_and_set_bit(slot, &device->receiver.busy_slots));
+
+    for (attempt = 0; attempt < sends; attempt++) {
+        err = razer_receiver_send(device, request);
+        if (err)
+            goto out;
+
+        deadline = ktime_add_us(ktime_get(), RAZER_VIPER_MOUSE_RECEIVER_WAIT_MAX_US);
+        usleep_range(RAZER_RECEIVER_FIRST_POLL_MIN_US, RAZER_RECEIVER_FIRST_POLL_MAX_US);
+
+        // Keep polling while the device reports busy or the other device's response is in the way
+        for (;;) {
+            err = razer_receiver_read(device, response);
+
+            if (err || razer_receiver_response_ready(request, response))
+                goto out;
+
+            if (ktime_after(ktime_get(), deadline))
+                break;
+
+            usleep_range(RAZER_RECEIVER_POLL_MIN_US, RAZER_RECEIVER_POLL_MAX_US);
+        }
+    }
+
+    // Whatever was read last belongs to another command or is still busy
+    err = -ETIMEDOUT;
+
+out:
+    clear_bit(slot, &device->receiver.busy_slots);
+    wake_up_all(&device->receiver.idle);
+    return err;
+}
+
 /**
  * Function to send to device, get response, and actually check the response
  */
@@ -106,10 +235,17 @@ static int razer_send_payload(struct razer_mouse_device *device, struct razer_re
 
     request->crc = razer_calculate_crc(request);
 
-    mutex_lock(&device->lock);
-    err = razer_get_report(device->usb_dev, request, response);
-    mutex_unlock(&device->lock);
-    if (err) {
+    if (device->receiver.shared) {
+        err = razer_receiver_get_report(device, request, response);
+    } else {
+        mutex_lock(&device->lock);
+        err = razer_get_report(device->usb_dev, request, response);
+        mutex_unlock(&device->lock);
+    }
+    if (err == -ETIMEDOUT) {
+        print_erroneous_report(response, "razermouse", "No response from receiver");
+        return err;
+    } else if (err) {
         print_erroneous_report(response, "razermouse", "Invalid Report Length");
         return err;
     }
@@ -2643,47 +2779,24 @@ static ssize_t razer_attr_write_matrix_custom_frame(struct device *dev, struct d
     struct razer_mouse_device *device = dev_get_drvdata(dev);
     struct razer_report request = {0};
     struct razer_report response = {0};
+    struct razer_custom_frame_row row;
     size_t offset = 0;
-    unsigned char row_id;
-    unsigned char start_col;
-    unsigned char stop_col;
-    unsigned char row_length;
 
     //printk(KERN_ALERT "razermouse: Total count: %d\n", (unsigned char)count);
 
     while(offset < count) {
-        if(offset + 3 > count) {
-            printk(KERN_ALERT "razermouse: Wrong Amount of data provided: Should be ROW_ID, START_COL, STOP_COL, N_RGB\n");
+        if (razer_parse_custom_frame_row(buf, count, &offset, &row, "razermouse"))
             return -EINVAL;
-        }
-
-        row_id = buf[offset++];
-        start_col = buf[offset++];
-        stop_col = buf[offset++];
-        row_length = ((stop_col+1) - start_col) * 3;
-
-        // printk(KERN_ALERT "razermouse: Row ID: %d, Start: %d, Stop: %d, row length: %d\n", row_id, start_col, stop_col, row_length);
 
         // Mouse only has 1 row, row0 (pseudo row as the command actually doesn't take rows)
-        if(row_id != 0) {
+        if(row.row_id != 0) {
             printk(KERN_ALERT "razermouse: Row ID must be 0\n");
             return -EINVAL;
         }
 
-        if(start_col > stop_col) {
-            printk(KERN_ALERT "razermouse: Start column is greater than end column\n");
-            return -EINVAL;
-        }
-
-        if(offset + row_length > count) {
-            printk(KERN_ALERT "razermouse: Not enough RGB to fill row (%d)\n", (int)(offset + row_length - count));
-            return -EINVAL;
-        }
-
-        // Offset now at beginning of RGB data
         switch (device->usb_pid) {
         case USB_DEVICE_ID_RAZER_NAGA_HEX_V2:
-            request = razer_chroma_standard_matrix_set_custom_frame(row_id, start_col, stop_col, (unsigned char*)&buf[offset]);
+            request = razer_chroma_standard_matrix_set_custom_frame(row.row_id, row.start_col, row.stop_col, row.rgb_data);
             request.transaction_id.id = 0x3f;
             break;
 
@@ -2706,7 +2819,7 @@ static ssize_t razer_attr_write_matrix_custom_frame(struct device *dev, struct d
         case USB_DEVICE_ID_RAZER_VIPER_MINI:
         case USB_DEVICE_ID_RAZER_VIPER_ULTIMATE_WIRED:
         case USB_DEVICE_ID_RAZER_VIPER_ULTIMATE_WIRELESS:
-            request = razer_chroma_extended_matrix_set_custom_frame(row_id, start_col, stop_col, (unsigned char*)&buf[offset]);
+            request = razer_chroma_extended_matrix_set_custom_frame(row.row_id, row.start_col, row.stop_col, row.rgb_data);
             request.transaction_id.id = 0x3F;
             break;
 
@@ -2715,25 +2828,25 @@ static ssize_t razer_attr_write_matrix_custom_frame(struct device *dev, struct d
         case USB_DEVICE_ID_RAZER_BASILISK_V3_PRO_WIRED:
         case USB_DEVICE_ID_RAZER_BASILISK_V3_PRO_WIRELESS:
         case USB_DEVICE_ID_RAZER_DEATHADDER_V2_LITE:
-            request = razer_chroma_extended_matrix_set_custom_frame(row_id, start_col, stop_col, (unsigned char*)&buf[offset]);
+            request = razer_chroma_extended_matrix_set_custom_frame(row.row_id, row.start_col, row.stop_col, row.rgb_data);
             request.transaction_id.id = 0x1f;
             break;
 
         case USB_DEVICE_ID_RAZER_BASILISK_ULTIMATE_RECEIVER:
         case USB_DEVICE_ID_RAZER_BASILISK_ULTIMATE_WIRED:
-            request = razer_chroma_extended_matrix_set_custom_frame(row_id, start_col, stop_col, (unsigned char*)&buf[offset]);
+            request = razer_chroma_extended_matrix_set_custom_frame(row.row_id, row.start_col, row.stop_col, row.rgb_data);
             request.transaction_id.id = 0x1f;
             break;
 
         case USB_DEVICE_ID_RAZER_MAMBA_WIRED:
         case USB_DEVICE_ID_RAZER_MAMBA_WIRELESS:
-            request = razer_chroma_misc_one_row_set_custom_frame(start_col, stop_col, (unsigned char*)&buf[offset]);
+            request = razer_chroma_misc_one_row_set_custom_frame(row.start_col, row.stop_col, row.rgb_data);
             request.transaction_id.id = 0x80;
             break;
 
         case USB_DEVICE_ID_RAZER_MAMBA_TE_WIRED:
         case USB_DEVICE_ID_RAZER_DIAMONDBACK_CHROMA:
-            request = razer_chroma_misc_one_row_set_custom_frame(start_col, stop_col, (unsigned char*)&buf[offset]);
+            request = razer_chroma_misc_one_row_set_custom_frame(row.start_col, row.stop_col, row.rgb_data);
             request.transaction_id.id = 0xFF;
             break;
 
@@ -2742,7 +2855,7 @@ static ssize_t razer_attr_write_matrix_custom_frame(struct device *dev, struct d
         case USB_DEVICE_ID_RAZER_NAGA_PRO_WIRED:
         case USB_DEVICE_ID_RAZER_NAGA_PRO_WIRELESS:
         case USB_DEVICE_ID_RAZER_MAMBA_ELITE:
-            request = razer_chroma_extended_matrix_set_custom_frame2(row_id, start_col, stop_col, (unsigned char*)&buf[offset], 0);
+            request = razer_chroma_extended_matrix_set_custom_frame2(row.row_id, row.start_col, row.stop_col, row.rgb_data, 0);
             request.transaction_id.id = 0x1f;
             break;
 
@@ -2752,9 +2865,6 @@ static ssize_t razer_attr_write_matrix_custom_frame(struct device *dev, struct d
         }
 
         razer_send_payload(device, &request, &response);
-
-        // *3 as its 3 bytes per col (RGB)
-        offset += row_length;
     }
 
     return count;
@@ -4766,6 +4876,8 @@ static void razer_mouse_init(struct razer_mouse_device *dev, struct usb_interfac
 
     // Initialise mutex
     mutex_init(&dev->lock);
+    mutex_init(&dev->receiver.pipe_lock);
+    init_waitqueue_head(&dev->receiver.idle);
     // Setup values
     dev->usb_dev = usb_dev;
     dev->usb_vid = usb_dev->descriptor.idVendor;
@@ -4773,6 +4885,12 @@ static void razer_mouse_init(struct razer_mouse_device *dev, struct usb_interfac
     dev->usb_interface_protocol = intf->cur_altsetting->desc.bInterfaceProtocol;
     dev->usb_interface_subclass = intf->cur_altsetting->desc.bInterfaceSubClass;
 
+    switch (dev->usb_pid) {
+    case USB_DEVICE_ID_RAZER_HYPERPOLLING_WIRELESS_DONGLE:
+        dev->receiver.shared = true;
+        break;
+    }
+
     // Get a "random" integer
     get_random_bytes(&rand_serial, sizeof(unsigned int));
     sprintf(&dev->serial[0], "PM%012u", rand_serial);
@@ -4788,8 +4906,12 @@ static void razer_mouse_init(struct razer_mouse_device *dev, struct usb_interfac
     dev->da3_5g.poll = 1; // Poll rate 1000
 
     // Setup tilt wheel HWHEEL emulation
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 13, 0)
+    hrtimer_setup(&dev->repeat_timer, wheel_tilt_repeat, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+#else
     hrtimer_init(&dev->repeat_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
     dev->repeat_timer.function = wheel_tilt_repeat;
+#endif
     dev->tilt_hwheel = 1;
     dev->tilt_repeat_delay = 250;
     dev->tilt_repeat = 33;
@@ -6878,3 +7000,7 @@ static struct hid_driver razer_mouse_driver = {
 };
 
 module_hid_driver(razer_mouse_driver);
+
+#ifdef RAZER_KUNIT
+#include "razermouse_kunit.c"
+#endif
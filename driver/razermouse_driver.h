@@ -122,6 +122,20 @@
 #define RAZER_VIPER_MOUSE_RECEIVER_WAIT_MIN_US 59900
 #define RAZER_VIPER_MOUSE_RECEIVER_WAIT_MAX_US 60000
 
+/*
+ * Receivers that pair several peripherals poll for the response instead of
+ * sleeping the full receiver wait, so the other peripheral can use the pipe
+ */
+#define RAZER_RECEIVER_FIRST_POLL_MIN_US 10000
+#define RAZER_RECEIVER_FIRST_POLL_MAX_US 10100
+#define RAZER_RECEIVER_POLL_MIN_US 5000
+#define RAZER_RECEIVER_POLL_MAX_US 5100
+#define RAZER_RECEIVER_MAX_SENDS 2
+
+// Devices behind a shared receiver that can each have a command in flight
+#define RAZER_RECEIVER_SLOT_RECEIVER 0
+#define RAZER_RECEIVER_SLOT_PAIRED 1
+
 #define RAZER_MOUSE_MAX_DPI_STAGES 5
 
 struct razer_mouse_device {
@@ -158,6 +172,14 @@ struct razer_mouse_device {
         unsigned char profile;
         unsigned char leds;
     } da3_5g;
+
+    // Receivers with more than one paired device share the control pipe between them
+    struct {
+        bool shared;
+        struct mutex pipe_lock;
+        wait_queue_head_t idle;
+        unsigned long busy_slots; // RAZER_RECEIVER_SLOT_* with a command in flight
+    } receiver;
 };
 
 // Mamba Key Location
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * KUnit tests for the razermouse receiver scheduling
+ *
+ * Included at the end of razermouse_driver.c when built with RAZER_KUNIT=y
+ * so the static helpers can be reached. The suite runs when razermouse.ko
+ * is loaded into a kernel with CONFIG_KUNIT.
+ */
+
+#include <kunit/test.h>
+
+static void razer_receiver_slot_test(struct kunit *test)
+{
+    struct razer_report request;
+
+    // The receiver answers pairing and its indicator LED itself
+    request = razer_chroma_misc_set_hyperpolling_wireless_dongle_pair_step1(0x01);
+    KUNIT_EXPECT_EQ(test, razer_receiver_slot(&request), RAZER_RECEIVER_SLOT_RECEIVER);
+    request = razer_chroma_misc_set_hyperpolling_wireless_dongle_pair_step2(0x00C1);
+    KUNIT_EXPECT_EQ(test, razer_receiver_slot(&request), RAZER_RECEIVER_SLOT_RECEIVER);
+    request = razer_chroma_misc_set_hyperpolling_wireless_dongle_unpair(0x00C1);
+    KUNIT_EXPECT_EQ(test, razer_receiver_slot(&request), RAZER_RECEIVER_SLOT_RECEIVER);
+    request = razer_chroma_misc_set_hyperpolling_wireless_dongle_indicator_led_mode(0x01);
+    KUNIT_EXPECT_EQ(test, razer_receiver_slot(&request), RAZER_RECEIVER_SLOT_RECEIVER);
+
+    // Everything else goes to the paired device, whatever the transaction id
+    request = razer_chroma_misc_get_battery_level();
+    request.transaction_id.id = 0x1F;
+    KUNIT_EXPECT_EQ(test, razer_receiver_slot(&request), RAZER_RECEIVER_SLOT_PAIRED);
+    request = razer_chroma_misc_get_dpi_xy(NOSTORE);
+    request.transaction_id.id = 0xFF;
+    KUNIT_EXPECT_EQ(test, razer_receiver_slot(&request), RAZER_RECEIVER_SLOT_PAIRED);
+}
+
+static void razer_receiver_max_sends_test(struct kunit *test)
+{
+    struct razer_report request;
+
+    // Reads are safe to send again
+    request = razer_chroma_misc_get_battery_level();
+    KUNIT_EXPECT_EQ(test, razer_receiver_max_sends(&request), RAZER_RECEIVER_MAX_SENDS);
+    request = razer_chroma_standard_get_firmware_version();
+    KUNIT_EXPECT_EQ(test, razer_receiver_max_sends(&request), RAZER_RECEIVER_MAX_SENDS);
+
+    // Writes are sent once
+    request = razer_chroma_misc_set_hyperpolling_wireless_dongle_pair_step2(0x00C1);
+    KUNIT_EXPECT_EQ(test, razer_receiver_max_sends(&request), 1);
+    request = razer_chroma_misc_set_hyperpolling_wireless_dongle_unpair(0x00C1);
+    KUNIT_EXPECT_EQ(test, razer_receiver_max_sends(&request), 1);
+    request = razer_chroma_misc_set_dpi_xy(NOSTORE, 800, 800);
+    KUNIT_EXPECT_EQ(test, razer_receiver_max_sends(&request), 1);
+}
+
+static struct kunit_case razer_receiver_test_cases[] = {
+    KUNIT_CASE(razer_receiver_slot_test),
+    KUNIT_CASE(razer_receiver_max_sends_test),
+    {}
+};
+
+static struct kunit_suite razer_receiver_test_suite = {
+    .name = "razermouse_receiver",
+    .test_cases = razer_receiver_test_cases,
+};
+
+kunit_test_suite(razer_receiver_test_suite);
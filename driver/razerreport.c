@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (c) 2015 Tim Theede <pez2001@voyagerproject.de>
+ *               2015 Terri Cain <terri@dolphincorp.co.uk>
+ */
+
+/*
+ * Report helpers that don't touch the USB stack, kept apart from the
+ * transport in razercommon.c so they can be built outside the kernel too
+ */
+
+#include <linux/kernel.h>
+#include <linux/string.h>
+#include <linux/errno.h>
+
+#include "razercommon.h"
+
+/**
+ * Calculate the checksum for the usb message
+ *
+ * Checksum byte is stored in the 2nd last byte in the messages payload.
+ * The checksum is generated by XORing all the bytes in the report starting
+ * at byte number 2 (0 based) and ending at byte 88.
+ */
+unsigned char razer_calculate_crc(struct razer_report *report)
+{
+    /*second to last byte of report is a simple checksum*/
+    /*just xor all bytes up with overflow and you are done*/
+    unsigned char crc = 0;
+    unsigned char *_report = (unsigned char*)report;
+
+    unsigned int i;
+    for(i = 2; i < 88; i++) {
+        crc ^= _report[i];
+    }
+
+    return crc;
+}
+
+/**
+ * Get initialised razer report
+ */
+struct razer_report get_razer_report(unsigned char command_class, unsigned char command_id, unsigned char data_size)
+{
+    struct razer_report new_report = {0};
+    memset(&new_report, 0, sizeof(struct razer_report));
+
+    new_report.status = 0x00;
+    new_report.transaction_id.id = 0x00;
+    new_report.remaining_packets = 0x00;
+    new_report.protocol_type = 0x00;
+    new_report.command_class = command_class;
+    new_report.command_id.id = command_id;
+    new_report.data_size = data_size;
+
+    return new_report;
+}
+
+/**
+ * Get empty razer report
+ */
+struct razer_report get_empty_razer_report(void)
+{
+    struct razer_report new_report = {0};
+    memset(&new_report, 0, sizeof(struct razer_report));
+
+    return new_report;
+}
+
+/**
+ * Print report to syslog
+ */
+void print_erroneous_report(struct razer_report* report, char* driver_name, char* message)
+{
+    printk(KERN_WARNING "%s: %s. status: %02x transaction_id.id: %02x remaining_packets: %02x protocol_type: %02x data_size: %02x, command_class: %02x, command_id.id: %02x Params: %02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x .\n",
+           driver_name,
+           message,
+           report->status,
+           report->transaction_id.id,
+           report->remaining_packets,
+           report->protocol_type,
+           report->data_size,
+           report->command_class,
+           report->command_id.id,
+           report->arguments[0], report->arguments[1], report->arguments[2], report->arguments[3], report->arguments[4], report->arguments[5],
+           report->arguments[6], report->arguments[7], report->arguments[8], report->arguments[9], report->arguments[10], report->arguments[11],
+           report->arguments[12], report->arguments[13], report->arguments[14], report->arguments[15]);
+}
+
+/**
+ * Clamp a value to a min,max
+ */
+unsigned char clamp_u8(unsigned char value, unsigned char min, unsigned char max)
+{
+    if(value > max)
+        return max;
+    if(value < min)
+        return min;
+    return value;
+}
+unsigned short clamp_u16(unsigned short value, unsigned short min, unsigned short max)
+{
+    if(value > max)
+        return max;
+    if(value < min)
+        return min;
+    return value;
+}
+
+/**
+ * Parse the next row of a "matrix_custom_frame" write
+ *
+ * Format
+ * ROW_ID START_COL STOP_COL RGB...
+ *
+ * On success row points into buf and offset is moved past the row.
+ */
+int razer_parse_custom_frame_row(const char *buf, size_t count, size_t *offset, struct razer_custom_frame_row *row, const char *driver_name)
+{
+    size_t row_length;
+
+    if(*offset + 3 > count) {
+        printk(KERN_ALERT "%s: Wrong Amount of data provided: Should be ROW_ID, START_COL, STOP_COL, N_RGB\n", driver_name);
+        return -EINVAL;
+    }
+
+    row->row_id = buf[*offset];
+    row->start_col = buf[*offset + 1];
+    row->stop_col = buf[*offset + 2];
+
+    if(row->start_col > row->stop_col) {
+        printk(KERN_ALERT "%s: Start column is greater than end column\n", driver_name);
+        return -EINVAL;
+    }
+
+    // *3 as its 3 bytes per col (RGB)
+    row_length = ((row->stop_col + 1) - row->start_col) * 3;
+    if(*offset + 3 + row_length > count) {
+        printk(KERN_ALERT "%s: Not enough RGB to fill row\n", driver_name);
+        return -EINVAL;
+    }
+
+    row->rgb_data = (unsigned char*)&buf[*offset + 3];
+    *offset += 3 + row_length;
+
+    return 0;
+}
@@ -0,0 +1,27 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+/*
+ * Userspace stand-ins for the bits of the kernel API the report builders use
+ */
+
+#ifndef LIBOPENRAZER_COMPAT_LINUX_KERNEL_H_
+#define LIBOPENRAZER_COMPAT_LINUX_KERNEL_H_
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef unsigned int uint;
+typedef unsigned long ulong;
+
+#define KERN_ALERT ""
+#define KERN_WARNING ""
+#define KERN_INFO ""
+
+#define printk(...) fprintf(stderr, __VA_ARGS__)
+
+#endif /* LIBOPENRAZER_COMPAT_LINUX_KERNEL_H_ */
@@ -0,0 +1,5 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+#include "../kernel.h"
+
+/* Only ever used through pointers by the transport declarations */
+struct usb_device;
@@ -0,0 +1,236 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Userspace hidraw transport for the OpenRazer report builders
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/hidraw.h>
+
+#include "openrazer_hid.h"
+
+/* Report id byte followed by the report itself */
+#define RAZER_HID_BUF_LEN (1 + sizeof(struct razer_report))
+
+static void razer_hid_wait(unsigned long wait_us)
+{
+    struct timespec ts = {
+        .tv_sec = wait_us / 1000000,
+        .tv_nsec = (wait_us % 1000000) * 1000,
+    };
+
+    while (nanosleep(&ts, &ts) == -1 && errno == EINTR)
+        ;
+}
+
+/**
+ * Fill in the fields every request needs, like razer_send_payload does
+ */
+static void razer_hid_prepare(struct razer_report *request)
+{
+    if (request->transaction_id.id == 0x00) {
+        printk(KERN_WARNING "libopenrazer: Request without transaction id, using 0xFF\n");
+        request->transaction_id.id = 0xFF;
+    }
+
+    request->crc = razer_calculate_crc(request);
+}
+
+static int razer_hid_set_feature(struct razer_hid_device *device, struct razer_report *request)
+{
+    unsigned char buf[RAZER_HID_BUF_LEN] = {0};
+
+    memcpy(&buf[1], request, sizeof(struct razer_report));
+    if (ioctl(device->fd, HIDIOCSFEATURE(sizeof(buf)), buf) < 0)
+        return -errno;
+
+    return 0;
+}
+
+static int razer_hid_get_feature(struct razer_hid_device *device, struct razer_report *response)
+{
+    unsigned char buf[RAZER_HID_BUF_LEN] = {0};
+    int len;
+
+    len = ioctl(device->fd, HIDIOCGFEATURE(sizeof(buf)), buf);
+    if (len < 0)
+        return -errno;
+
+    if ((size_t)len != sizeof(buf)) {
+        printk(KERN_WARNING "libopenrazer: Invalid response. Report length: %d\n", len);
+        return -EIO;
+    }
+
+    memcpy(response, &buf[1], sizeof(struct razer_report));
+    return 0;
+}
+
+/**
+ * Check the response belongs to the request and was successful
+ */
+static int razer_hid_check_response(struct razer_report *request, struct razer_report *response)
+{
+    if (response->remaining_packets != request->remaining_packets ||
+        response->command_class != request->command_class ||
+        response->command_id.id != request->command_id.id) {
+        print_erroneous_report(response, "libopenrazer", "Response doesn't match request");
+        return -EIO;
+    }
+
+    switch (response->status) {
+    case RAZER_CMD_FAILURE:
+        print_erroneous_report(response, "libopenrazer", "Command failed");
+        return -EIO;
+    case RAZER_CMD_NOT_SUPPORTED:
+        print_erroneous_report(response, "libopenrazer", "Command not supported");
+        return -EIO;
+    case RAZER_CMD_TIMEOUT:
+        print_erroneous_report(response, "libopenrazer", "Command timed out");
+        return -EIO;
+    }
+
+    return 0;
+}
+
+/**
+ * Open the hidraw node of a device's control interface
+ *
+ * A wait_us of 0 selects RAZER_HID_WAIT_DEFAULT_US, wireless receivers need
+ * the longer waits the kernel drivers use for them.
+ */
+int razer_hid_open(struct razer_hid_device *device, const char *path, unsigned long wait_us)
+{
+    device->fd = open(path, O_RDWR | O_CLOEXEC);
+    if (device->fd < 0)
+        return -errno;
+
+    device->wait_us = wait_us ? wait_us : RAZER_HID_WAIT_DEFAULT_US;
+    return 0;
+}
+
+void razer_hid_close(struct razer_hid_device *device)
+{
+    if (device->fd >= 0)
+        close(device->fd);
+
+    device->fd = -1;
+}
+
+/**
+ * Send a report without reading the response, e.g. for custom frames
+ */
+int razer_hid_send(struct razer_hid_device *device, struct razer_report *request)
+{
+    struct razer_hid_transfer transfer = {
+        .device = device,
+        .request = *request,
+        .want_response = false,
+    };
+
+    razer_hid_submit(&transfer, 1);
+    return transfer.result;
+}
+
+/**
+ * Send a report, wait for the response and check it
+ */
+int razer_hid_send_payload(struct razer_hid_device *device, struct razer_report *request, struct razer_report *response)
+{
+    struct razer_hid_transfer transfer = {
+        .device = device,
+        .request = *request,
+        .want_response = true,
+    };
+
+    razer_hid_submit(&transfer, 1);
+    *response = transfer.response;
+    return transfer.result;
+}
+
+/**
+ * Check if a transfer is the oldest one still pending on its device
+ */
+static bool razer_hid_is_next(struct razer_hid_transfer *transfers, size_t index)
+{
+    size_t i;
+
+    for (i = 0; i < index; i++) {
+        if (transfers[i].device == transfers[index].device &&
+            (transfers[i].result == -EINPROGRESS || transfers[i].result == -EAGAIN))
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Send a batch of requests
+ *
+ * Requests for the same device go out in order, one at a time, as a device
+ * only holds one response. Requests for different devices are sent in
+ * rounds that share a single wait, so talking to several devices costs the
+ * longest wait instead of the sum of them.
+ *
+ * Returns 0 if every transfer succeeded, otherwise the first error. The
+ * result of each transfer is stored in it.
+ */
+int razer_hid_submit(struct razer_hid_transfer *transfers, size_t count)
+{
+    size_t i, pending = count;
+    unsigned long round_wait;
+    int err = 0;
+
+    for (i = 0; i < count; i++)
+        transfers[i].result = -EINPROGRESS;
+
+    while (pending > 0) {
+        round_wait = 0;
+
+        // Send the oldest pending request of every device
+        for (i = 0; i < count; i++) {
+            struct razer_hid_transfer *transfer = &transfers[i];
+
+            if (transfer->result != -EINPROGRESS || !razer_hid_is_next(transfers, i))
+                continue;
+
+            razer_hid_prepare(&transfer->request);
+            transfer->result = razer_hid_set_feature(transfer->device, &transfer->request);
+            if (transfer->result != 0) {
+                if (err == 0)
+                    err = transfer->result;
+                pending--;
+                continue;
+            }
+
+            transfer->result = -EAGAIN; // Sent, waiting for the response
+            if (transfer->device->wait_us > round_wait)
+                round_wait = transfer->device->wait_us;
+        }
+
+        razer_hid_wait(round_wait);
+
+        // Collect the responses of this round
+        for (i = 0; i < count; i++) {
+            struct razer_hid_transfer *transfer = &transfers[i];
+
+            if (transfer->result != -EAGAIN)
+                continue;
+
+            transfer->result = 0;
+            if (transfer->want_response) {
+                transfer->result = razer_hid_get_feature(transfer->device, &transfer->response);
+                if (transfer->result == 0)
+                    transfer->result = razer_hid_check_response(&transfer->request, &transfer->response);
+            }
+
+            if (transfer->result != 0 && err == 0)
+                err = transfer->result;
+            pending--;
+        }
+    }
+
+    return err;
+}
@@ -0,0 +1,52 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+/*
+ * Userspace hidraw transport for the OpenRazer report builders
+ *
+ * Builds reports with the same razer_chroma_* functions the kernel drivers
+ * use (see driver/razerchromacommon.h) and sends them as feature reports
+ * through /dev/hidrawN, without going through the sysfs attributes.
+ *
+ * The hidraw node has to be the one of the device's control interface, the
+ * same interface the kernel driver sends its reports to.
+ */
+
+#ifndef LIBOPENRAZER_OPENRAZER_HID_H_
+#define LIBOPENRAZER_OPENRAZER_HID_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "razerchromacommon.h"
+
+/* Same defaults the kernel drivers use for most keyboards and mice */
+#define RAZER_HID_WAIT_DEFAULT_US 800
+
+struct razer_hid_device {
+    int fd;
+    /* Time the device needs between a request and its response */
+    unsigned long wait_us;
+};
+
+/*
+ * A single request in a batch
+ *
+ * result is 0 on success or a negative errno, response is only filled in
+ * when want_response is set.
+ */
+struct razer_hid_transfer {
+    struct razer_hid_device *device;
+    struct razer_report request;
+    struct razer_report response;
+    bool want_response;
+    int result;
+};
+
+int razer_hid_open(struct razer_hid_device *device, const char *path, unsigned long wait_us);
+void razer_hid_close(struct razer_hid_device *device);
+
+int razer_hid_send(struct razer_hid_device *device, struct razer_report *request);
+int razer_hid_send_payload(struct razer_hid_device *device, struct razer_report *request, struct razer_report *response);
+
+int razer_hid_submit(struct razer_hid_transfer *transfers, size_t count);
+
+#endif /* LIBOPENRAZER_OPENRAZER_HID_H_ */
@@ -0,0 +1,299 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Tests for the batched transfers of the hidraw transport
+ *
+ * Linked with --wrap=ioctl,--wrap=nanosleep so the feature report ioctls go
+ * to fake devices and waits are recorded instead of slept. Run with
+ * "make test".
+ */
+
+#include <errno.h>
+#include <stdarg.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <linux/hidraw.h>
+
+#include "openrazer_hid.h"
+
+#define FAKE_MAX_DEVICES 4
+#define FAKE_MAX_EVENTS 64
+
+/* Report id byte followed by the report itself */
+#define FAKE_BUF_LEN (1 + sizeof(struct razer_report))
+
+struct fake_device {
+    struct razer_report last_request;
+    /* Result of the next SET_FEATURE calls, 0 to accept them */
+    int set_errno[FAKE_MAX_EVENTS];
+    size_t sets;
+    /* Status and length of the responses */
+    unsigned char status;
+    int get_len;
+};
+
+enum fake_event_type {
+    FAKE_SET,
+    FAKE_WAIT,
+    FAKE_GET,
+};
+
+struct fake_event {
+    enum fake_event_type type;
+    /* Device index for SET and GET, microseconds for WAIT */
+    unsigned long value;
+    /* Command id of the request for SET */
+    unsigned char command_id;
+};
+
+static struct fake_device fake_devices[FAKE_MAX_DEVICES];
+static struct fake_event fake_events[FAKE_MAX_EVENTS];
+static size_t fake_event_count;
+
+static int failures;
+
+#define EXPECT_EQ(actual, expected) \
+do { \
+    long long _a = (actual), _e = (expected); \
+    if (_a != _e) { \
+        fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, _a, _e); \
+        failures++; \
+    } \
+} while (0)
+
+static void fake_record(enum fake_event_type type, unsigned long value, unsigned char command_id)
+{
+    if (fake_event_count < FAKE_MAX_EVENTS)
+        fake_events[fake_event_count++] = (struct fake_event) { type, value, command_id };
+}
+
+/* Device fds are the index of the fake device */
+int __wrap_ioctl(int fd, unsigned long request, ...)
+{
+    struct fake_device *device = &fake_devices[fd];
+    unsigned char *buf;
+    va_list args;
+    int err;
+
+    va_start(args, request);
+    buf = va_arg(args, unsigned char *);
+    va_end(args);
+
+    if (request == HIDIOCSFEATURE(FAKE_BUF_LEN)) {
+        memcpy(&device->last_request, &buf[1], sizeof(struct razer_report));
+        fake_record(FAKE_SET, fd, device->last_request.command_id.id);
+
+        err = device->set_errno[device->sets++];
+        if (err) {
+            errno = err;
+            return -1;
+        }
+        return FAKE_BUF_LEN;
+    }
+
+    if (request == HIDIOCGFEATURE(FAKE_BUF_LEN)) {
+        struct razer_report response = device->last_request;
+
+        fake_record(FAKE_GET, fd, 0);
+
+        response.status = device->status;
+        memcpy(&buf[1], &response, sizeof(response));
+        return device->get_len;
+    }
+
+    errno = ENOTTY;
+    return -1;
+}
+
+int __wrap_nanosleep(const struct timespec *req, struct timespec *rem)
+{
+    fake_record(FAKE_WAIT, req->tv_sec * 1000000 + req->tv_nsec / 1000, 0);
+    return 0;
+}
+
+static void fake_reset(struct razer_hid_device *devices, size_t count)
+{
+    size_t i;
+
+    memset(fake_devices, 0, sizeof(fake_devices));
+    fake_event_count = 0;
+
+    for (i = 0; i < count; i++) {
+        fake_devices[i].status = RAZER_CMD_SUCCESSFUL;
+        fake_devices[i].get_len = FAKE_BUF_LEN;
+        devices[i].fd = i;
+    }
+}
+
+static void expect_event(size_t index, enum fake_event_type type, unsigned long value, unsigned char command_id)
+{
+    if (index >= fake_event_count) {
+        fprintf(stderr, "event %zu missing\n", index);
+        failures++;
+        return;
+    }
+
+    EXPECT_EQ(fake_events[index].type, type);
+    EXPECT_EQ(fake_events[index].value, value);
+    if (type == FAKE_SET)
+        EXPECT_EQ(fake_events[index].command_id, command_id);
+}
+
+static struct razer_hid_transfer transfer(struct razer_hid_device *device, unsigned char command_id, bool want_response)
+{
+    struct razer_hid_transfer transfer = {
+        .device = device,
+        .request = get_razer_report(0x03, command_id, 0x00),
+        .want_response = want_response,
+    };
+
+    transfer.request.transaction_id.id = 0xFF;
+    return transfer;
+}
+
+/*
+ * Requests for one device go out one per round, different devices share a
+ * round that waits as long as the slowest of them
+ */
+static void test_batch_split(void)
+{
+    struct razer_hid_device devices[2] = { { .wait_us = 800 }, { .wait_us = 2000 } };
+    struct razer_hid_transfer transfers[3];
+    int err;
+
+    fake_reset(devices, 2);
+    transfers[0] = transfer(&devices[0], 0x81, true);
+    transfers[1] = transfer(&devices[0], 0x82, true);
+    transfers[2] = transfer(&devices[1], 0x83, true);
+
+    err = razer_hid_submit(transfers, 3);
+
+    EXPECT_EQ(err, 0);
+    EXPECT_EQ(transfers[0].result, 0);
+    EXPECT_EQ(transfers[1].result, 0);
+    EXPECT_EQ(transfers[2].result, 0);
+    EXPECT_EQ(transfers[1].response.command_id.id, 0x82);
+    EXPECT_EQ(transfers[2].response.status, RAZER_CMD_SUCCESSFUL);
+
+    EXPECT_EQ(fake_event_count, 8);
+    expect_event(0, FAKE_SET, 0, 0x81);
+    expect_event(1, FAKE_SET, 1, 0x83);
+    expect_event(2, FAKE_WAIT, 2000, 0);
+    expect_event(3, FAKE_GET, 0, 0);
+    expect_event(4, FAKE_GET, 1, 0);
+    expect_event(5, FAKE_SET, 0, 0x82);
+    expect_event(6, FAKE_WAIT, 800, 0);
+    expect_event(7, FAKE_GET, 0, 0);
+}
+
+/* Requests without a response are still spaced by the wait, but not read */
+static void test_batch_no_response(void)
+{
+    struct razer_hid_device devices[1] = { { .wait_us = 800 } };
+    struct razer_hid_transfer transfers[2];
+    int err;
+
+    fake_reset(devices, 1);
+    transfers[0] = transfer(&devices[0], 0x0B, false);
+    transfers[1] = transfer(&devices[0], 0x0A, false);
+
+    err = razer_hid_submit(transfers, 2);
+
+    EXPECT_EQ(err, 0);
+    EXPECT_EQ(fake_event_count, 4);
+    expect_event(0, FAKE_SET, 0, 0x0B);
+    expect_event(1, FAKE_WAIT, 800, 0);
+    expect_event(2, FAKE_SET, 0, 0x0A);
+    expect_event(3, FAKE_WAIT, 800, 0);
+}
+
+/*
+ * A failed write only fails its own transfer, the rest of the batch still
+ * goes out and the first error is returned
+ */
+static void test_partial_write_error(void)
+{
+    struct razer_hid_device devices[2] = { { .wait_us = 800 }, { .wait_us = 800 } };
+    struct razer_hid_transfer transfers[3];
+    int err;
+
+    fake_reset(devices, 2);
+    fake_devices[0].set_errno[0] = EPIPE;
+    transfers[0] = transfer(&devices[0], 0x81, true);
+    transfers[1] = transfer(&devices[0], 0x82, true);
+    transfers[2] = transfer(&devices[1], 0x83, true);
+
+    err = razer_hid_submit(transfers, 3);
+
+    EXPECT_EQ(err, -EPIPE);
+    EXPECT_EQ(transfers[0].result, -EPIPE);
+    EXPECT_EQ(transfers[1].result, 0);
+    EXPECT_EQ(transfers[2].result, 0);
+
+    // The next request of the device takes the failed one's place in the round
+    EXPECT_EQ(fake_event_count, 6);
+    expect_event(0, FAKE_SET, 0, 0x81);
+    expect_event(1, FAKE_SET, 0, 0x82);
+    expect_event(2, FAKE_SET, 1, 0x83);
+    expect_event(3, FAKE_WAIT, 800, 0);
+    expect_event(4, FAKE_GET, 0, 0);
+    expect_event(5, FAKE_GET, 1, 0);
+}
+
+/* Failed responses fail their transfer, the first error in the batch wins */
+static void test_response_errors(void)
+{
+    struct razer_hid_device devices[3] = { { .wait_us = 800 }, { .wait_us = 800 }, { .wait_us = 800 } };
+    struct razer_hid_transfer transfers[4];
+    int err;
+
+    fake_reset(devices, 3);
+    fake_devices[0].status = RAZER_CMD_NOT_SUPPORTED;
+    fake_devices[1].get_len = 10;
+    fake_devices[2].set_errno[1] = ENODEV;
+    transfers[0] = transfer(&devices[0], 0x81, true);
+    transfers[1] = transfer(&devices[1], 0x82, true);
+    transfers[2] = transfer(&devices[2], 0x83, true);
+    transfers[3] = transfer(&devices[2], 0x84, true);
+
+    err = razer_hid_submit(transfers, 4);
+
+    EXPECT_EQ(err, -EIO);
+    EXPECT_EQ(transfers[0].result, -EIO);
+    EXPECT_EQ(transfers[1].result, -EIO);
+    EXPECT_EQ(transfers[2].result, 0);
+    EXPECT_EQ(transfers[3].result, -ENODEV);
+}
+
+/* Every request gets a CRC and a transaction id before it's sent */
+static void test_prepare(void)
+{
+    struct razer_hid_device devices[1] = { { .wait_us = 800 } };
+    struct razer_report request = get_razer_report(0x03, 0x0B, 0x00);
+    int err;
+
+    fake_reset(devices, 1);
+    request.transaction_id.id = 0x00;
+
+    err = razer_hid_send(&devices[0], &request);
+
+    EXPECT_EQ(err, 0);
+    EXPECT_EQ(fake_devices[0].last_request.transaction_id.id, 0xFF);
+    EXPECT_EQ(fake_devices[0].last_request.crc, razer_calculate_crc(&fake_devices[0].last_request));
+}
+
+int main(void)
+{
+    test_batch_split();
+    test_batch_no_response();
+    test_partial_write_error();
+    test_response_errors();
+    test_prepare();
+
+    if (failures) {
+        fprintf(stderr, "%d failures\n", failures);
+        return 1;
+    }
+
+    printf("libopenrazer: all tests passed\n");
+    return 0;
+}
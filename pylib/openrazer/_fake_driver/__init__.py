@@ -2,14 +2,24 @@
 
 import struct
 import configparser
+import functools
 import glob
+import json
 import os
+import re
 import shutil
 
 SPECS = {os.path.splitext(os.path.basename(spec_file))[0]: spec_file for spec_file in glob.glob(os.path.join(os.path.dirname(__file__), '*.cfg'))}
 EVENT_FORMAT = '@llHHI'
 EV_KEY = 0x01
 
+# Driver sources the USB wait times are taken from
+DRIVER_DIR = os.path.join(os.path.dirname(__file__), '..', '..', '..', 'driver')
+# Read by the daemon in test mode, see openrazer_daemon.misc.fake_latency
+LATENCY_FILE = 'fake_latency'
+# RAZER_MOUSE_WAIT_MIN_US / RAZER_MOUSE_WAIT_MAX_US, for devices the driver sources don't cover
+DEFAULT_WAIT_US = (600, 800)
+
 KEY_ACTION = {
     'up': 0x00,
     'down': 0x01,
@@ -22,6 +32,98 @@ def touch(fname, times=None):
         os.utime(fname, times)
 
 
+@functools.lru_cache(maxsize=None)
+def get_driver_waits(driver_dir=DRIVER_DIR):
+    """
+    Get the time each driver waits for a USB response, by PID
+
+    Follows the switch statements that pick the RAZER_*_WAIT_MIN_US and
+    RAZER_*_WAIT_MAX_US constants in the driver sources, devices that aren't
+    listed get the wait of the default case.
+
+    :return: Dict of PID like '0062': (min us, max us)
+    :rtype: dict
+    """
+    waits = {}
+
+    for header_file in sorted(glob.glob(os.path.join(driver_dir, 'razer*_driver.h'))):
+        source_file = header_file[:-2] + '.c'
+        if not os.path.exists(source_file):
+            continue
+
+        with open(header_file) as header:
+            header = header.read()
+        with open(source_file) as source:
+            source = source.read()
+
+        constants = {}
+        for name, bound, value in re.findall(r'#define\s+(RAZER_\w+_WAIT)_(MIN|MAX)_US\s+(\d+)', header):
+            constants.setdefault(name, {})[bound] = int(value)
+        constants = {name: (bounds['MIN'], bounds.get('MAX', bounds['MIN'])) for name, bounds in constants.items() if 'MIN' in bounds}
+
+        device_waits = {}
+        default_wait = None
+        cases = []
+        in_default = False
+        for line in source.splitlines():
+            if 'switch (' in line or 'break;' in line:
+                cases = []
+                in_default = False
+
+            cases.extend(re.findall(r'case\s+(USB_DEVICE_ID_RAZER_\w+)\s*:', line))
+            if 'default:' in line:
+                in_default = True
+
+            match = re.search(r'\b(RAZER_\w+_WAIT)_MIN_US\b', line)
+            if match is not None and match.group(1) in constants:
+                for case in cases:
+                    device_waits.setdefault(case, constants[match.group(1)])
+                if in_default and default_wait is None:
+                    default_wait = constants[match.group(1)]
+                cases = []
+                in_default = False
+
+        for name, pid in re.findall(r'#define\s+(USB_DEVICE_ID_RAZER_\w+)\s+0x([0-9A-Fa-f]{4})', header):
+            wait = device_waits.get(name, default_wait)
+            if wait is not None:
+                waits.setdefault(pid.upper(), wait)
+
+    return waits
+
+
+def get_latency_profile(pid, **overrides):
+    """
+    Get the latency profile of a device
+
+    :param pid: USB PID like '0062'
+    :type pid: str
+
+    :param overrides: Profile entries to change, see the keys below
+    :type overrides: dict
+
+    :return: Profile as written to LATENCY_FILE
+    :rtype: dict
+    """
+    wait_min_us, wait_max_us = get_driver_waits().get(pid.upper(), DEFAULT_WAIT_US)
+
+    profile = {
+        # Time per USB report, a custom frame sends one report per row
+        'wait_min_us': wait_min_us,
+        'wait_max_us': wait_max_us,
+        # Chance of a report being answered with busy, it's sent again
+        'busy_probability': 0.0,
+        # Chance of a read or write failing with EIO
+        'failure_probability': 0.0,
+        # Seconds for charge_level to go down one step while discharging, 0 to keep it
+        'charge_drift_s': 0,
+        # Per file overrides of the entries above, e.g. {'dpi': {'wait_min_us': 0, 'wait_max_us': 0}}
+        'files': {},
+    }
+    profile.update(overrides)
+
+    return profile
+
+
 class FakeDevice(object):
     @staticmethod
     def parse_endpoint_line(line):
@@ -65,7 +167,7 @@ class FakeDevice(object):
             touch(path)
         os.chmod(path, chmod)
 
-    def __init__(self, spec_name, serial=None, tmp_dir=os.environ.get('TMPDIR', '/tmp')):
+    def __init__(self, spec_name, serial=None, tmp_dir=os.environ.get('TMPDIR', '/tmp'), latency=None):
 
         if spec_name not in SPECS:
             raise ValueError("Spec {0} not in SPECS".format(spec_name))
@@ -87,6 +189,15 @@ class FakeDevice(object):
         if serial is not None:
             self.set('device_serial', serial)
 
+        # Reads and writes are instant unless the daemon is told how long the device would take
+        if latency:
+            pid = self._config.get('device', 'dir_name').split(':')[2].split('.')[0]
+            self.latency = get_latency_profile(pid, **(latency if isinstance(latency, dict) else {}))
+            with open(os.path.join(self._tmp_dir, LATENCY_FILE), 'w') as latency_file:
+                json.dump(self.latency, latency_file)
+        else:
+            self.latency = None
+
         # Disallow write in directory, so disallow creating new files after setup is done.
         os.chmod(self._tmp_dir, 0o555)
 
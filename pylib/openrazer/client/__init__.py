@@ -36,8 +36,17 @@ class DeviceManager(object):
 
         self._daemon_version = self._dbus_daemon.version()
 
+        # Static properties of all devices in one round trip
+        try:
+            descriptors = self._dbus_devices.getDeviceDescriptors()
+        except _dbus.DBusException as err:
+            # Older daemon
+            if err.get_dbus_name() != 'org.freedesktop.DBus.Error.UnknownMethod':
+                raise
+            descriptors = {}
+
         for serial in self._device_serials:
-            device = _RazerDeviceFactory.get_device(serial)
+            device = _RazerDeviceFactory.get_device(serial, descriptor=descriptors.get(serial))
             self._devices.append(device)
 
     def stop_daemon(self):
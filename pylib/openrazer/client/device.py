@@ -1,7 +1,7 @@
 # SPDX-License-Identifier: GPL-2.0-or-later
 
 import dbus as _dbus
-from openrazer.client.devices import RazerDevice as __RazerDevice, BaseDeviceFactory as __BaseDeviceFactory
+from openrazer.client.devices import RazerDevice as __RazerDevice, BaseDeviceFactory as __BaseDeviceFactory, get_descriptor as __get_descriptor
 from openrazer.client.devices.mousemat import RazerMousemat as __RazerMousemat
 from openrazer.client.devices.keyboard import RazerKeyboardFactory as __RazerKeyboardFactory
 from openrazer.client.devices.mice import RazerMouse as __RazerMouse
@@ -22,7 +22,7 @@ class RazerDeviceFactory(__BaseDeviceFactory):
 
     """
     @staticmethod
-    def get_device(serial, vid_pid=None, daemon_dbus=None):
+    def get_device(serial, vid_pid=None, daemon_dbus=None, descriptor=None):
         """
         Factory for turning a serial into a class
 
@@ -41,6 +41,9 @@ class RazerDeviceFactory(__BaseDeviceFactory):
         :param daemon_dbus: Daemon DBus object
         :type daemon_dbus: object or None
 
+        :param descriptor: Device descriptor from the daemon, fetched if None
+        :type descriptor: dict or None
+
         :return: RazerDevice object (or subclass)
         :rtype: RazerDevice
         """
@@ -50,20 +53,27 @@ class RazerDeviceFactory(__BaseDeviceFactory):
 
         device_dbus = _dbus.Interface(daemon_dbus, "razer.device.misc")
 
-        device_type = device_dbus.getDeviceType()
-        device_vid_pid = device_dbus.getVidPid()
+        if descriptor is None:
+            descriptor = __get_descriptor(device_dbus)
+
+        if descriptor is not None:
+            device_type = descriptor['type']
+            device_vid_pid = descriptor['vid_pid']
+        else:
+            device_type = device_dbus.getDeviceType()
+            device_vid_pid = device_dbus.getVidPid()
 
         if device_type in DEVICE_MAP:
             # Have device mapping
             device_class = DEVICE_MAP[device_type]
             if hasattr(device_class, 'get_device'):
                 # DeviceFactory
-                device = device_class.get_device(serial, vid_pid=device_vid_pid, daemon_dbus=daemon_dbus)
+                device = device_class.get_device(serial, vid_pid=device_vid_pid, daemon_dbus=daemon_dbus, descriptor=descriptor)
             else:
                 # DeviceClass
-                device = device_class(serial, vid_pid=device_vid_pid, daemon_dbus=daemon_dbus)
+                device = device_class(serial, vid_pid=device_vid_pid, daemon_dbus=daemon_dbus, descriptor=descriptor)
         else:
             # No mapping, default to RazerDevice
-            device = DEVICE_MAP['default'](serial, vid_pid=device_vid_pid, daemon_dbus=daemon_dbus)
+            device = DEVICE_MAP['default'](serial, vid_pid=device_vid_pid, daemon_dbus=daemon_dbus, descriptor=descriptor)
 
         return device
@@ -8,6 +8,24 @@ from openrazer.client.macro import RazerMacro as _RazerMacro
 from openrazer.client import constants as _c
 
 
+def get_descriptor(device_dbus):
+    """
+    Get the static properties of a device in one call
+
+    :param device_dbus: razer.device.misc DBus interface of the device
+    :type device_dbus: dbus.Interface
+
+    :return: Descriptor or None if the daemon doesn't support it
+    :rtype: dict or None
+    """
+    try:
+        return device_dbus.getDescriptor()
+    except _dbus.exceptions.DBusException as err:
+        if err.get_dbus_name() != 'org.freedesktop.DBus.Error.UnknownMethod':
+            raise
+        return None
+
+
 class RazerDevice(object):
     """
     Raw razer base device
@@ -15,7 +33,7 @@ class RazerDevice(object):
     _FX = _RazerFX
     _MACRO_CLASS = _RazerMacro
 
-    def __init__(self, serial, vid_pid=None, daemon_dbus=None):
+    def __init__(self, serial, vid_pid=None, daemon_dbus=None, descriptor=None):
         # Load up the DBus
         if daemon_dbus is None:
             session_bus = _dbus.SessionBus()
@@ -23,25 +41,48 @@ class RazerDevice(object):
 
         self._dbus = daemon_dbus
 
-        self._available_features = self._get_available_features()
-
         self._dbus_interfaces = {
             'device': _dbus.Interface(self._dbus, "razer.device.misc"),
             'brightness': _dbus.Interface(self._dbus, "razer.device.lighting.brightness")
         }
 
-        self._name = str(self._dbus_interfaces['device'].getDeviceName())
-        self._type = str(self._dbus_interfaces['device'].getDeviceType())
-        self._fw = str(self._dbus_interfaces['device'].getFirmware())
-        self._drv_version = str(self._dbus_interfaces['device'].getDriverVersion())
+        if descriptor is None:
+            descriptor = get_descriptor(self._dbus_interfaces['device'])
+
+        if descriptor is not None:
+            # Everything static in one call
+            self._available_features = {str(interface): [str(method) for method in methods] for interface, methods in descriptor['methods'].items()}
+
+            self._name = str(descriptor['name'])
+            self._type = str(descriptor['type'])
+            self._fw = str(descriptor['firmware_version'])
+            self._drv_version = str(descriptor['driver_version'])
+            has_matrix = bool(descriptor['has_matrix'])
+        else:
+            # Daemons without getDescriptor
+            self._available_features = self._get_available_features()
+
+            self._name = str(self._dbus_interfaces['device'].getDeviceName())
+            self._type = str(self._dbus_interfaces['device'].getDeviceType())
+            self._fw = str(self._dbus_interfaces['device'].getFirmware())
+            self._drv_version = str(self._dbus_interfaces['device'].getDriverVersion())
+            # == True as its a DBus boolean otherwise, so for consistency sake we coerce it into a native bool
+            has_matrix = self._dbus_interfaces['device'].hasMatrix() == True
+
         self._has_dedicated_macro = None
         self._device_image = None
+        if descriptor is not None:
+            self._has_dedicated_macro = bool(descriptor['dedicated_macro_keys'])
+            self._device_image = str(descriptor['device_image'])
 
         # Deprecated API, but kept for backwards compatibility
         self._urls = None
 
         if vid_pid is None:
-            self._vid, self._pid = self._dbus_interfaces['device'].getVidPid()
+            if descriptor is not None:
+                self._vid, self._pid = descriptor['vid_pid']
+            else:
+                self._vid, self._pid = self._dbus_interfaces['device'].getVidPid()
         else:
             self._vid, self._pid = vid_pid
 
@@ -104,8 +145,8 @@ class RazerDevice(object):
 
             'lighting_pulsate': self._has_feature('razer.device.lighting.bw2013', 'setPulsate'),
 
-            # Get if the device has an LED Matrix, == True as its a DBus boolean otherwise, so for consistency sake we coerce it into a native bool
-            'lighting_led_matrix': self._dbus_interfaces['device'].hasMatrix() == True,
+            # Get if the device has an LED Matrix
+            'lighting_led_matrix': has_matrix,
             'lighting_led_single': self._has_feature('razer.device.lighting.chroma', 'setKey'),
 
             # Mouse lighting attrs
@@ -225,12 +266,18 @@ class RazerDevice(object):
 
         # Nasty hack to convert dbus.Int32 into native
         if self.has('lighting_led_matrix'):
-            self._matrix_dimensions = tuple([int(dim) for dim in self._dbus_interfaces['device'].getMatrixDimensions()])
+            if descriptor is not None:
+                self._matrix_dimensions = tuple([int(dim) for dim in descriptor['matrix_dims']])
+            else:
+                self._matrix_dimensions = tuple([int(dim) for dim in self._dbus_interfaces['device'].getMatrixDimensions()])
         else:
             self._matrix_dimensions = None
 
         if self.has('keyboard_layout'):
-            self._kbd_layout = str(self._dbus_interfaces['device'].getKeyboardLayout())
+            if descriptor is not None and 'keyboard_layout' in descriptor:
+                self._kbd_layout = str(descriptor['keyboard_layout'])
+            else:
+                self._kbd_layout = str(self._dbus_interfaces['device'].getKeyboardLayout())
         else:
             self._kbd_layout = None
 
@@ -577,5 +624,5 @@ class RazerDevice(object):
 
 class BaseDeviceFactory(object):
     @staticmethod
-    def get_device(serial: str, daemon_dbus=None) -> RazerDevice:
+    def get_device(serial: str, daemon_dbus=None, descriptor=None) -> RazerDevice:
         raise NotImplementedError()
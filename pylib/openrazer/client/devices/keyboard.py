@@ -197,11 +197,11 @@ DEVICE_PID_MAP = {
 
 class RazerKeyboardFactory(__BaseDeviceFactory):
     @staticmethod
-    def get_device(serial, vid_pid=None, daemon_dbus=None):
+    def get_device(serial, vid_pid=None, daemon_dbus=None, descriptor=None):
         if vid_pid is None:
             pid = 0xFFFF
         else:
             pid = vid_pid[1]
 
         device_class = DEVICE_PID_MAP.get(pid, RazerKeyboard)
-        return device_class(serial, vid_pid=vid_pid, daemon_dbus=daemon_dbus)
+        return device_class(serial, vid_pid=vid_pid, daemon_dbus=daemon_dbus, descriptor=descriptor)
@@ -1,5 +1,8 @@
 # SPDX-License-Identifier: GPL-2.0-or-later
 
+import mmap as _mmap
+import os as _os
+
 import numpy as _np
 import dbus as _dbus
 # from openrazer.client.constants import WAVE_LEFT, WAVE_RIGHT, REACTIVE_500MS, REACTIVE_1000MS, REACTIVE_1500MS, REACTIVE_2000MS
@@ -629,6 +632,10 @@ class RazerAdvancedFX(BaseRazerFX):
         self._matrix_dims = matrix_dims
         self._lighting_dbus = _dbus.Interface(daemon_dbus, "razer.device.lighting.chroma")
 
+        # Framebuffer, mapped on the first draw. False if the daemon doesn't have one
+        self._framebuffer = None
+        self._framebuffer_id = None
+
         self.matrix = Frame(matrix_dims)
 
     @property
@@ -651,10 +658,61 @@ class RazerAdvancedFX(BaseRazerFX):
         """
         return self._matrix_dims[0]
 
+    def _map_framebuffer(self):
+        """
+        Map a framebuffer from the daemon
+
+        :return: Framebuffer or None if the daemon doesn't support it
+        :rtype: mmap.mmap or None
+        """
+        if self._framebuffer is None:
+            try:
+                unix_fd, self._framebuffer_id = self._lighting_dbus.getFramebuffer()
+            except _dbus.exceptions.DBusException as err:
+                # Older daemon
+                if err.get_dbus_name() != 'org.freedesktop.DBus.Error.UnknownMethod':
+                    raise
+                self._framebuffer = False
+            else:
+                fd = unix_fd.take()
+                try:
+                    self._framebuffer = _mmap.mmap(fd, _os.fstat(fd).st_size)
+                finally:
+                    _os.close(fd)
+
+        return self._framebuffer or None
+
+    def _commit_framebuffer(self, ba):
+        """
+        Draw through the framebuffer
+
+        :return: True if the frame was drawn
+        :rtype: bool
+        """
+        for _ in range(2):
+            framebuffer = self._map_framebuffer()
+            if framebuffer is None or len(ba) > len(framebuffer):
+                return False
+
+            # Only a tiny message goes over the bus per frame
+            framebuffer[:len(ba)] = ba
+            try:
+                self._lighting_dbus.commitFramebuffer(self._framebuffer_id, _dbus.UInt32(len(ba)))
+                return True
+            except _dbus.exceptions.DBusException as err:
+                if err.get_dbus_name() != 'org.razer.Error.FramebufferNotFound':
+                    raise
+                # The daemon dropped our framebuffer for newer clients, get a new one
+                framebuffer.close()
+                self._framebuffer = None
+
+        return False
+
     def _draw(self, ba):
-        self._lighting_dbus.setKeyRow(ba)
+        if not self._commit_framebuffer(ba):
+            self._lighting_dbus.setKeyRow(ba)
 
-        self._lighting_dbus.setCustom()
+            self._lighting_dbus.setCustom()
 
     def draw(self):
         """
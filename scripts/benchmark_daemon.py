@@ -0,0 +1,400 @@
+#!/usr/bin/python3
+"""
+Benchmark the daemon against fake devices
+
+Starts the daemon from this checkout on a set of fake devices, drives it
+through the client library and reports throughput and latency as JSON, so
+performance changes can be compared against a baseline.
+
+Needs a session bus, e.g. run it with dbus-run-session.
+"""
+import argparse
+import configparser
+import datetime
+import json
+import math
+import os
+import platform
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+PYLIB = os.path.join(ROOT, 'pylib')
+DAEMON = os.path.join(ROOT, 'daemon')
+# The client library uses the daemon's macro classes
+sys.path[1:1] = [PYLIB, DAEMON]
+
+import dbus
+import openrazer._fake_driver as fake_driver
+import openrazer.client
+
+DEFAULT_DEVICE_COUNTS = (1, 8, 32)
+
+
+def log(message):
+    print(message, file=sys.stderr, flush=True)
+
+
+def percentile(sorted_values, percent):
+    """
+    Nearest rank percentile of an already sorted list
+    """
+    if not sorted_values:
+        return None
+
+    index = max(0, math.ceil(percent / 100 * len(sorted_values)) - 1)
+    return sorted_values[index]
+
+
+def summarise(name, device_count, latencies, elapsed, errors=0):
+    """
+    Turn the latency of each call into a result entry
+
+    :param latencies: Seconds per call
+    :type latencies: list of float
+
+    :param elapsed: Seconds for all calls together
+    :type elapsed: float
+
+    :param errors: Number of calls that failed
+    :type errors: int
+    """
+    latencies = sorted(latencies)
+
+    def to_ms(value):
+        return None if value is None else round(value * 1000, 4)
+
+    return {
+        'benchmark': name,
+        'devices': device_count,
+        'operations': len(latencies),
+        'errors': errors,
+        'elapsed_s': round(elapsed, 6),
+        'ops_per_s': round(len(latencies) / elapsed, 2) if elapsed > 0 else None,
+        'mean_ms': to_ms(sum(latencies) / len(latencies)) if latencies else None,
+        'p50_ms': to_ms(percentile(latencies, 50)),
+        'p99_ms': to_ms(percentile(latencies, 99)),
+        'max_ms': to_ms(latencies[-1]) if latencies else None,
+    }
+
+
+def timed_calls(calls):
+    """
+    Run calls one after the other, timing each
+
+    :param calls: Callables
+    :type calls: iterable
+
+    :return: Latency of each call, the total time and the number of failed calls
+    :rtype: tuple
+    """
+    latencies = []
+    errors = 0
+    start = time.perf_counter()
+
+    for call in calls:
+        call_start = time.perf_counter()
+        try:
+            call()
+        except dbus.DBusException:
+            # e.g. the fake driver's failure probability
+            errors += 1
+        latencies.append(time.perf_counter() - call_start)
+
+    return latencies, time.perf_counter() - start, errors
+
+
+def get_spec_files(spec_name):
+    config = configparser.ConfigParser()
+    config.read(fake_driver.SPECS[spec_name])
+
+    files = set()
+    for line in config.get('device', 'files').splitlines():
+        files.add(fake_driver.FakeDevice.parse_endpoint_line(line)[1])
+
+    return config.get('device', 'dir_name'), files
+
+
+def pick_specs(count):
+    """
+    Pick fake devices, half with custom frames and half with DPI
+
+    Each half is spread over the sorted list of specs, so the same count
+    always gives the same mix of devices.
+    """
+    matrix_specs = []
+    dpi_specs = []
+    dir_names = set()
+    for spec_name in sorted(fake_driver.SPECS):
+        dir_name, files = get_spec_files(spec_name)
+        if dir_name in dir_names:
+            continue
+
+        if 'matrix_custom_frame' in files:
+            matrix_specs.append(spec_name)
+        elif 'dpi' in files:
+            dpi_specs.append(spec_name)
+        else:
+            continue
+        dir_names.add(dir_name)
+
+    # Frames are the busiest path, a single device gets them
+    matrix_count = (count + 1) // 2
+    dpi_count = count // 2
+    if matrix_count > len(matrix_specs) or dpi_count > len(dpi_specs):
+        raise ValueError("Only {0} fake devices are usable, asked for {1}".format(min(len(matrix_specs), len(dpi_specs)) * 2, count))
+
+    def spread(specs, spec_count):
+        return [specs[index * len(specs) // spec_count] for index in range(spec_count)]
+
+    return spread(matrix_specs, matrix_count) + spread(dpi_specs, dpi_count)
+
+
+class DaemonRun(object):
+    """
+    Fake devices and a daemon using them
+    """
+
+    def __init__(self, spec_names, config_file, daemon_args, latency=None):
+        self.spec_names = spec_names
+        self._config_file = config_file
+        self._daemon_args = daemon_args
+        self._latency = latency
+
+        self._tmp_dir = tempfile.mkdtemp(prefix='openrazer_benchmark_')
+        self._test_dir = os.path.join(self._tmp_dir, 'test')
+        self._fake_devices = []
+        self._process = None
+
+    def start(self, timeout):
+        """
+        Create the devices, start the daemon and wait for it to show all of them
+
+        :return: Seconds from starting the daemon until all devices were available
+        :rtype: float
+        """
+        for spec_name in self.spec_names:
+            self._fake_devices.append(fake_driver.FakeDevice(spec_name, tmp_dir=self._test_dir, latency=self._latency))
+
+        for dir_name in ('run', 'logs'):
+            os.makedirs(os.path.join(self._tmp_dir, dir_name))
+
+        command = [sys.executable, os.path.join(DAEMON, 'run_openrazer_daemon.py'),
+                   '--foreground',
+                   '--config', self._config_file,
+                   '--persistence', os.path.join(self._tmp_dir, 'persistence.conf'),
+                   '--run-dir', os.path.join(self._tmp_dir, 'run'),
+                   '--log-dir', os.path.join(self._tmp_dir, 'logs'),
+                   '--test-dir', self._test_dir]
+        if os.geteuid() == 0:
+            command.append('--as-root')
+        command.extend(self._daemon_args)
+
+        env = dict(os.environ)
+        env['PYTHONPATH'] = os.pathsep.join([PYLIB, DAEMON])
+
+        start = time.perf_counter()
+        self._process = subprocess.Popen(command, env=env, stdout=subprocess.DEVNULL)
+
+        deadline = start + timeout
+        while time.perf_counter() < deadline:
+            if self._process.poll() is not None:
+                raise RuntimeError("Daemon exited with {0}, see {1}".format(self._process.returncode, os.path.join(self._tmp_dir, 'logs')))
+
+            try:
+                if len(openrazer.client.DeviceManager().devices) == len(self.spec_names):
+                    return time.perf_counter() - start
+            except (openrazer.client.DaemonNotFound, dbus.DBusException):
+                pass
+
+            time.sleep(0.05)
+
+        raise RuntimeError("Daemon didn't show all {0} devices within {1}s".format(len(self.spec_names), timeout))
+
+    def stop(self):
+        if self._process is not None:
+            try:
+                openrazer.client.DeviceManager().stop_daemon()
+                self._process.wait(timeout=10)
+            except (openrazer.client.DaemonNotFound, dbus.DBusException, subprocess.TimeoutExpired):
+                self._process.terminate()
+                self._process.wait()
+            self._process = None
+
+        for fake_device in self._fake_devices:
+            fake_device.close()
+        self._fake_devices.clear()
+
+        shutil.rmtree(self._tmp_dir, ignore_errors=True)
+
+
+def bench_enumeration(device_manager, iterations):
+    # Fewer runs, each one sets up every device
+    return timed_calls(openrazer.client.DeviceManager for _ in range(max(1, iterations // 10)))
+
+
+def bench_custom_frame(device_manager, iterations):
+    devices = [device for device in device_manager.devices if device.has('lighting_led_matrix')]
+
+    def draw(device, index):
+        def call():
+            device.fx.advanced.matrix.set(0, 0, (index % 256, 0, 255 - index % 256))
+            device.fx.advanced.draw()
+        return call
+
+    return timed_calls(draw(device, index) for index in range(iterations) for device in devices)
+
+
+def bench_effect(device_manager, iterations):
+    devices = [device for device in device_manager.devices if device.fx.has('static') and device.fx.has('spectrum')]
+
+    def set_effect(device, index):
+        if index % 2:
+            return device.fx.spectrum
+        return lambda: device.fx.static(255, index % 256, 0)
+
+    return timed_calls(set_effect(device, index) for index in range(iterations) for device in devices)
+
+
+def bench_brightness(device_manager, iterations):
+    devices = [device for device in device_manager.devices if device.has('brightness')]
+
+    def set_brightness(device, index):
+        def call():
+            device.brightness = float(index % 101)
+        return call
+
+    return timed_calls(set_brightness(device, index) for index in range(iterations) for device in devices)
+
+
+def bench_dpi(device_manager, iterations):
+    devices = [device for device in device_manager.devices if device.has('dpi')]
+
+    def set_dpi(device, index):
+        if device.has('available_dpi'):
+            values = device.available_dpi
+            value = (values[index % len(values)], 0)
+        else:
+            value = (800, 800) if index % 2 else (1600, 1600)
+
+        def call():
+            device.dpi = value
+        return call
+
+    return timed_calls(set_dpi(device, index) for index in range(iterations) for device in devices)
+
+
+def bench_sync_fan_out(device_manager, iterations):
+    devices = [device for device in device_manager.devices if device.fx.has('static')]
+    if len(devices) < 2:
+        return [], 0, 0
+
+    # Each effect set on the first device is also set on all the others
+    device_manager.sync_effects = True
+    try:
+        return timed_calls((lambda index=index: devices[0].fx.static(index % 256, 255, 0)) for index in range(iterations))
+    finally:
+        device_manager.sync_effects = False
+
+
+BENCHMARKS = {
+    'enumeration': bench_enumeration,
+    'custom_frame': bench_custom_frame,
+    'effect': bench_effect,
+    'brightness': bench_brightness,
+    'dpi': bench_dpi,
+    'sync_fan_out': bench_sync_fan_out,
+}
+
+
+def run_benchmarks(device_count, args):
+    spec_names = pick_specs(device_count)
+    log("== {0} device(s)".format(device_count))
+
+    latency = None
+    if args.latency:
+        latency = {'busy_probability': args.busy_probability, 'failure_probability': args.failure_probability}
+
+    run = DaemonRun(spec_names, args.config, args.daemon_arg, latency)
+    try:
+        startup = run.start(args.startup_timeout)
+        results = [summarise('startup', device_count, [startup], startup)]
+
+        device_manager = openrazer.client.DeviceManager()
+        for name in args.benchmark:
+            latencies, elapsed, errors = BENCHMARKS[name](device_manager, args.iterations)
+            if not latencies:
+                log("   {0}: no suitable devices".format(name))
+                continue
+
+            result = summarise(name, device_count, latencies, elapsed, errors)
+            log("   {benchmark}: {ops_per_s}/s, p50 {p50_ms}ms, p99 {p99_ms}ms, {errors} errors".format(**result))
+            results.append(result)
+    finally:
+        run.stop()
+
+    return {'devices': device_count, 'specs': spec_names, 'results': results}
+
+
+def get_revision():
+    try:
+        return subprocess.check_output(['git', '-C', ROOT, 'rev-parse', 'HEAD'], stderr=subprocess.DEVNULL, text=True).strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description="Benchmark the daemon against fake devices")
+    parser.add_argument('--devices', metavar='COUNT', type=int, nargs='+', default=list(DEFAULT_DEVICE_COUNTS), help='Numbers of fake devices to run with')
+    parser.add_argument('--iterations', type=int, default=200, help='Calls per device and benchmark')
+    parser.add_argument('--benchmark', choices=list(BENCHMARKS), nargs='+', default=list(BENCHMARKS), help='Benchmarks to run')
+    parser.add_argument('--config', default=os.path.join(DAEMON, 'resources', 'razer.conf'), help='Daemon config file')
+    parser.add_argument('--daemon-arg', action='append', default=[], help='Extra argument passed to the daemon, can be repeated')
+    parser.add_argument('--latency', action='store_true', help='Emulate how long the real devices take to answer')
+    parser.add_argument('--busy-probability', type=float, default=0.0, help='With --latency, chance of a USB report being answered with busy')
+    parser.add_argument('--failure-probability', type=float, default=0.0, help='With --latency, chance of a read or write failing')
+    parser.add_argument('--startup-timeout', type=float, default=120, help='Seconds to wait for the daemon to show all devices')
+    parser.add_argument('--output', help='Write the JSON results here instead of stdout')
+
+    return parser.parse_args()
+
+
+def run():
+    args = parse_args()
+
+    if 'DBUS_SESSION_BUS_ADDRESS' not in os.environ:
+        log("ERROR: No session bus, run this with dbus-run-session")
+        sys.exit(1)
+
+    try:
+        openrazer.client.DeviceManager()
+        log("ERROR: A daemon is already running, stop it first")
+        sys.exit(1)
+    except (openrazer.client.DaemonNotFound, dbus.DBusException):
+        pass
+
+    report = {
+        'revision': get_revision(),
+        'date': datetime.datetime.now(datetime.timezone.utc).isoformat(),
+        'python': platform.python_version(),
+        'platform': platform.platform(),
+        'iterations': args.iterations,
+        'daemon_args': args.daemon_arg,
+        'latency': args.latency,
+        'runs': [run_benchmarks(device_count, args) for device_count in args.devices],
+    }
+
+    if args.output is None:
+        json.dump(report, sys.stdout, indent=2)
+        print()
+    else:
+        with open(args.output, 'w') as output:
+            json.dump(report, output, indent=2)
+            output.write('\n')
+
+
+if __name__ == '__main__':
+    run()
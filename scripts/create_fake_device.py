@@ -177,11 +177,11 @@ class FakeDevicePrompt(cmd.Cmd):
         self.do_exit(arg)
 
 
-def create_envionment(device_name, destination):
+def create_envionment(device_name, destination, latency=None):
     os.makedirs(destination, exist_ok=True)
 
     try:
-        fake_device = fake_driver.FakeDevice(device_name, tmp_dir=destination)
+        fake_device = fake_driver.FakeDevice(device_name, tmp_dir=destination, latency=latency)
         return fake_device
     except ValueError:
         print('Device {0}.cfg not found'.format(device_name))
@@ -194,6 +194,10 @@ def parse_args():
     parser.add_argument('--all', action='store_true', help='Create all possible fake devices')
     parser.add_argument('--non-interactive', dest='interactive', action='store_false', help='Dont display prompt, just hang until killed')
     parser.add_argument('--clear-dest', action='store_true', help='Clear the destination folder if it exists before starting')
+    parser.add_argument('--latency', action='store_true', help='Make the daemon wait as long as the real devices take to answer')
+    parser.add_argument('--busy-probability', type=float, default=0.0, help='With --latency, chance of a USB report being answered with busy')
+    parser.add_argument('--failure-probability', type=float, default=0.0, help='With --latency, chance of a read or write failing')
+    parser.add_argument('--charge-drift', type=float, default=0, help='With --latency, seconds for the battery level to go down one step')
 
     return parser.parse_args()
 
@@ -214,10 +218,18 @@ def run():
     else:
         devices = args.device
 
+    latency = None
+    if args.latency:
+        latency = {
+            'busy_probability': args.busy_probability,
+            'failure_probability': args.failure_probability,
+            'charge_drift_s': args.charge_drift,
+        }
+
     device_map = {}
     for device in devices:
         # Device name: FakeDriver
-        fake_device = create_envionment(device, destination)
+        fake_device = create_envionment(device, destination, latency)
         if fake_device is not None:
             device_map[device] = fake_device
 